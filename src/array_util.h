@@ -1,6 +1,6 @@
 /** @file
  * Interfejs modulu zawierajacego funkcje pomocnicze do operowania na tablicach
- * dwuwymiarowych
+ * przechowujacych dane pol planszy
  *
  * @author Piotr Prabucki <pp418377@students.mimuw.edu.pl>
  */
@@ -9,71 +9,195 @@
 #ifndef ARRAY_UTIL_H
 #define ARRAY_UTIL_H
 
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
 #include <stdint.h>
+#include "memory_util.h"
 
 
 /**
- * Stala, uzywana do obliczania indeksu pola w @ref get_arr_index.
+ * @brief Zwraca indeks liniowy pola o wspolrzednych [x], [y] na planszy o
+ * szerokosci [width].
+ * 
+ * @param[in] width : szerokosc planszy
+ * @param[in] x     : wspolrzedna osi X pola
+ * @param[in] y     : wspolrzedna osi Y pola
+ * 
+ * @return Indeks pola w tablicy @ref cell_array_t.
+ */
+static inline uint64_t get_cell_index(uint32_t width, uint32_t x, uint32_t y) {
+	return (uint64_t)y * width + x;
+}
+
+
+/**
+ * Logarytm dwojkowy dlugosci boku bloku w blokowym ukladzie planszy.
+ */
+#define BLOCK_SHIFT 3
+/**
+ * Maska wspolrzednej pola wewnatrz bloku.
  */
-#define MAX_HEIGHT (uint32_t)((((uint64_t)1) << 32) - 2)
+#define BLOCK_MASK ((1u << BLOCK_SHIFT) - 1)
 
 
 /**
- * @brief Zwraca wartosc arr[y][x].
- * [arr] jest typu uint32_t.
+ * @brief Zwraca indeks pola o wspolrzednych [x], [y] w blokowym ukladzie
+ * planszy.
+ * Plansza jest podzielona na kwadratowe bloki o boku 2^@ref BLOCK_SHIFT pol,
+ * ulozone wierszami; pola bloku leza w pamieci obok siebie, wiec sasiedzi
+ * pola w pionie zwykle sa w tej samej linii pamieci podrecznej.
  * 
- * @param[in] arr   : tablica dwuwymiarowa, ktorej wartosc odczytujemy
- * @param[in] x     : drugi indeks tablicy
- * @param[in] y     : pierwszy indeks tablicy
+ * @param[in] block_columns : liczba blokow w wierszu blokow
+ * @param[in] x             : wspolrzedna osi X pola
+ * @param[in] y             : wspolrzedna osi Y pola
  * 
- * @return wskaznik na arr[y][x]
+ * @return Indeks pola w tablicy @ref cell_array_t.
  */
-uint32_t* get_arr_32(uint32_t **arr, uint32_t x, uint32_t y);
+static inline uint64_t get_block_cell_index(
+	uint64_t block_columns,
+	uint32_t x,
+	uint32_t y
+) {
+	uint64_t block = (y >> BLOCK_SHIFT) * block_columns + (x >> BLOCK_SHIFT);
+
+	return block << (2 * BLOCK_SHIFT) |
+		(y & BLOCK_MASK) << BLOCK_SHIFT |
+		(x & BLOCK_MASK);
+}
 
 
 /**
- * @brief Zwraca wartosc arr[y][x].
- * [arr] jest typu uint64_t.
+ * @brief Pobiera z wyprzedzeniem do pamieci podrecznej komorke o indeksie
+ * [index] tablicy [arr].
+ * Nie robi nic, gdy kompilator nie udostepnia __builtin_prefetch.
  * 
- * @param[in] arr   : tablica dwuwymiarowa, ktorej wartosc odczytujemy
- * @param[in] x     : drugi indeks tablicy
- * @param[in] y     : pierwszy indeks tablicy
+ * @param[in] arr   : tablica, ktorej komorke pobieramy
+ * @param[in] index : indeks komorki
+ */
+static inline void prefetch_cell(const cell_array_t *arr, uint64_t index) {
+#ifdef __GNUC__
+	const cell_tile_t *tile = arr->tiles[index >> TILE_SHIFT];
+	__builtin_prefetch(
+		(const char*)tile->data + (index & TILE_MASK) * arr->cell_size
+	);
+#else
+	(void)arr;
+	(void)index;
+#endif
+}
+
+
+/**
+ * @brief Pobiera z wyprzedzeniem do pamieci podrecznej naglowek kafelka
+ * zawierajacego komorke o indeksie [index] tablicy [arr].
+ * Naglowek jest czytany przy kazdym zapisie do kafelka w @ref set_cell.
+ * Nie robi nic, gdy kompilator nie udostepnia __builtin_prefetch.
  * 
- * @return wskaznik na arr[y][x]
+ * @param[in] arr   : tablica, do ktorej komorki bedziemy zapisywac
+ * @param[in] index : indeks komorki
  */
-uint64_t* get_arr_64(uint64_t **arr, uint32_t x, uint32_t y);
+static inline void prefetch_tile(const cell_array_t *arr, uint64_t index) {
+#ifdef __GNUC__
+	__builtin_prefetch(arr->tiles[index >> TILE_SHIFT]);
+#else
+	(void)arr;
+	(void)index;
+#endif
+}
 
 
 /**
- * Zwraca indeks reprezentujacy pole na potrzeby algorytmu Find & Union.
+ * @brief Zwraca wartosc komorki o indeksie [index] tablicy [arr].
  * 
- * @param[in] x : wspolrzedna osi X pola
- * @param[in] y : wspolrzedna osi Y pola
+ * @param[in] arr   : tablica, ktorej wartosc odczytujemy
+ * @param[in] index : indeks komorki
  * 
- * @return Indeks reprezentujacy pole.
+ * @return Wartosc komorki.
  */
-uint64_t get_array_index(uint64_t x, uint64_t y);
+static inline uint64_t get_cell(const cell_array_t *arr, uint64_t index) {
+	const cell_tile_t *tile = arr->tiles[index >> TILE_SHIFT];
+	index &= TILE_MASK;
+
+	switch (arr->cell_size) {
+		case 1:
+			return ((const uint8_t*)tile->data)[index];
+		case 2:
+			return ((const uint16_t*)tile->data)[index];
+		case 4:
+			return ((const uint32_t*)tile->data)[index];
+		default:
+			return tile->data[index];
+	}
+}
 
 
 /**
- * Zwraca wspolrzedna osi X bazujac na indeksie pola obliczonego w
- * @ref get_array_index.
+ * @brief Sprawdza, czy kafelek zawierajacy komorke o indeksie [index]
+ * tablicy [arr] nalezy tylko do niej, czyli czy zapis do tej komorki nie
+ * wymaga alokowania pamieci.
  * 
- * @param[in] index : indeks pola, ktorego wspolrzedna osi X obliczamy
+ * @param[in] arr   : tablica
+ * @param[in] index : indeks komorki
  * 
- * @return Wspolrzedna osi X pola o indeksie [index].
+ * @return true, gdy kafelek nalezy tylko do tablicy, false w przeciwnym
+ * wypadku.
  */
-uint32_t get_array_x_from_index(uint64_t index);
+static inline bool check_cell_writable(
+	const cell_array_t *arr,
+	uint64_t index
+) {
+	const cell_tile_t *tile = arr->tiles[index >> TILE_SHIFT];
+	return atomic_load_explicit(&tile->references, memory_order_acquire) == 1;
+}
 
 
 /**
- * Zwraca wspolrzedna osi X bazujac na indeksie pola obliczonego w
- * @ref get_array_index.
+ * @brief Zapewnia, ze zapis do komorki o indeksie [index] tablicy [arr] nie
+ * bedzie wymagal alokowania pamieci (patrz @ref make_tile_writable).
  * 
- * @param[in] index : indeks pola, ktorego wspolrzedna osi X obliczamy
+ * @param[in,out] arr   : tablica, do ktorej bedziemy zapisywac
+ * @param[in] index     : indeks komorki
  * 
- * @return Wspolrzedna osi X pola o indeksie [index].
+ * @return true, gdy udalo sie zaalokowac pamiec, false w przeciwnym wypadku.
  */
-uint32_t get_array_y_from_index(uint64_t index);
+static inline bool prepare_cell(cell_array_t *arr, uint64_t index) {
+	return check_cell_writable(arr, index) ||
+		make_tile_writable(arr, index >> TILE_SHIFT);
+}
+
+
+/**
+ * @brief Ustawia wartosc komorki o indeksie [index] tablicy [arr] na [value].
+ * [value] musi miescic sie w komorce tablicy. Nie alokuje pamieci: kafelek
+ * musi nalezec tylko do tej tablicy, wiec wywolujacy przygotowuje go
+ * wczesniej w @ref prepare_cell (zapis do wspoldzielonego kafelka, np.
+ * wspolnego wyzerowanego, zmienilby inne tablice).
+ * 
+ * @param[in,out] arr   : tablica, ktorej wartosc zmieniamy
+ * @param[in] index     : indeks komorki
+ * @param[in] value     : nowa wartosc komorki
+ */
+static inline void set_cell(cell_array_t *arr, uint64_t index, uint64_t value) {
+	assert(check_cell_writable(arr, index));
+	cell_tile_t *tile = arr->tiles[index >> TILE_SHIFT];
+	index &= TILE_MASK;
+
+	switch (arr->cell_size) {
+		case 1:
+			((uint8_t*)tile->data)[index] = value;
+			break;
+		case 2:
+			((uint16_t*)tile->data)[index] = value;
+			break;
+		case 4:
+			((uint32_t*)tile->data)[index] = value;
+			break;
+		default:
+			tile->data[index] = value;
+			break;
+	}
+}
+
 
 #endif /* ARRAY_UTIL_H */
@@ -0,0 +1,124 @@
+/** @file
+ * Porownanie wydajnosci @ref gamma_move_batch z petla wywolan
+ * @ref gamma_move
+ *
+ * @author Piotr Prabucki <pp418377@students.mimuw.edu.pl>
+ */
+
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "gamma.h"
+
+
+/**
+ * Bok planszy uzywanej w pomiarach.
+ */
+#define BENCH_SIDE 8192
+/**
+ * Liczba ruchow w pomiarze.
+ */
+#define BENCH_MOVES 8000000
+/**
+ * Liczba graczy w pomiarze.
+ */
+#define BENCH_PLAYERS 8
+
+
+/**
+ * @brief Zwraca czas w sekundach od ustalonej chwili.
+ *
+ * @return Czas w sekundach.
+ */
+double get_time(void) {
+	struct timespec now;
+	timespec_get(&now, TIME_UTC);
+
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+
+/**
+ * @brief Wypelnia tablice @p moves pseudolosowymi ruchami.
+ *
+ * @param[out] moves    : tablica na @ref BENCH_MOVES ruchow
+ */
+void generate_moves(move_t *moves) {
+	uint64_t state = 88172645463325252ull;
+
+	for (size_t i = 0; i < BENCH_MOVES; i++) {
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		moves[i].player = 1 + state % BENCH_PLAYERS;
+		moves[i].x = (state >> 8) % BENCH_SIDE;
+		moves[i].y = (state >> 32) % BENCH_SIDE;
+	}
+}
+
+
+/**
+ * @brief Mierzy czas wykonania ruchow @p moves.
+ * Konczy program z kodem 1, gdy nie udalo sie utworzyc gry.
+ *
+ * @param[in] moves     : tablica @ref BENCH_MOVES ruchow
+ * @param[in] batch     : czy uzyc @ref gamma_move_batch
+ * @param[out] done     : liczba wykonanych ruchow
+ *
+ * @return Czas w sekundach.
+ */
+double bench_moves(const move_t *moves, bool batch, size_t *done) {
+	gamma_t *g = gamma_new(BENCH_SIDE, BENCH_SIDE, BENCH_PLAYERS, UINT32_MAX);
+	if (!g) {
+		exit(1);
+	}
+
+	double start = get_time();
+	if (batch) {
+		*done = gamma_move_batch(g, moves, BENCH_MOVES, NULL);
+	}
+	else {
+		*done = 0;
+		for (size_t i = 0; i < BENCH_MOVES; i++) {
+			*done += gamma_move(g, moves[i].player, moves[i].x, moves[i].y);
+		}
+	}
+	double time = get_time() - start;
+
+	gamma_delete(g);
+
+	return time;
+}
+
+
+/**
+ * @brief Wypisuje liczbe ruchow na sekunde dla obu sposobow wykonywania
+ * ruchow.
+ *
+ * @return Zero lub 1, gdy nie udalo sie zaalokowac pamieci.
+ */
+int main() {
+	move_t *moves = malloc(BENCH_MOVES * sizeof(move_t));
+	if (!moves) {
+		return 1;
+	}
+	generate_moves(moves);
+
+	size_t loop_done;
+	size_t batch_done;
+	double loop_time = bench_moves(moves, false, &loop_done);
+	double batch_time = bench_moves(moves, true, &batch_done);
+
+	printf("board %d x %d, %d moves\n", BENCH_SIDE, BENCH_SIDE, BENCH_MOVES);
+	printf("gamma_move loop  : %.2f Mmoves/s\n", BENCH_MOVES / loop_time / 1e6);
+	printf("gamma_move_batch : %.2f Mmoves/s\n", BENCH_MOVES / batch_time / 1e6);
+	if (loop_done != batch_done) {
+		printf("results differ\n");
+	}
+
+	free(moves);
+
+	return 0;
+}
@@ -0,0 +1,216 @@
+/** @file
+ * Porownanie kosztu rozgalezienia pozycji gry gamma przez @ref gamma_clone
+ * z odtwarzaniem historii ruchow w nowej grze
+ *
+ * @author Piotr Prabucki <pp418377@students.mimuw.edu.pl>
+ */
+
+
+#define _DEFAULT_SOURCE
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <time.h>
+#include "gamma.h"
+
+
+/**
+ * Bok planszy uzywanej w pomiarach (plansza ma ponad 10^7 pol).
+ */
+#define BENCH_SIDE 3163
+/**
+ * Liczba graczy.
+ */
+#define BENCH_PLAYERS 8
+/**
+ * Liczba prob ruchu skladajacych sie na historie rozgalezianej pozycji.
+ */
+#define HISTORY_MOVES 4000000
+/**
+ * Liczba tworzonych kopii pozycji.
+ */
+#define CLONES 1000
+/**
+ * Liczba ruchow wykonywanych w kazdej kopii.
+ */
+#define CLONE_MOVES 16
+
+
+/**
+ * @brief Zwraca czas w sekundach od ustalonej chwili.
+ *
+ * @return Czas w sekundach.
+ */
+double get_time(void) {
+	struct timespec now;
+	timespec_get(&now, TIME_UTC);
+
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+
+/**
+ * @brief Zwraca najwieksza dotychczasowa zajetosc pamieci procesu.
+ *
+ * @return Zajetosc pamieci w kilobajtach.
+ */
+long get_max_memory(void) {
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+
+	return usage.ru_maxrss;
+}
+
+
+/**
+ * @brief Zwraca kolejna liczbe pseudolosowa (xorshift).
+ *
+ * @param[in,out] state : stan generatora, rozny od zera
+ *
+ * @return Liczba pseudolosowa.
+ */
+uint64_t next_random(uint64_t *state) {
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+
+	return *state;
+}
+
+
+/**
+ * @brief Wykonuje losowy ruch w grze [g].
+ *
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in,out] state : stan generatora liczb pseudolosowych
+ * @param[out] move     : wykonany ruch
+ *
+ * @return true, gdy ruch sie udal, false w przeciwnym wypadku.
+ */
+bool make_random_move(gamma_t *g, uint64_t *state, move_t *move) {
+	uint64_t r = next_random(state);
+	move->player = 1 + r % BENCH_PLAYERS;
+	move->x = (r >> 8) % BENCH_SIDE;
+	move->y = (r >> 32) % BENCH_SIDE;
+
+	return gamma_move(g, move->player, move->x, move->y);
+}
+
+
+/**
+ * @brief Tworzy gre na planszy @ref BENCH_SIDE x @ref BENCH_SIDE.
+ * Konczy program z kodem 1, gdy nie udalo sie jej utworzyc.
+ *
+ * @return Wskaznik na strukture przechowujaca stan gry.
+ */
+gamma_t* new_bench_game(void) {
+	gamma_t *g = gamma_new(BENCH_SIDE, BENCH_SIDE, BENCH_PLAYERS, UINT32_MAX);
+	if (!g) {
+		exit(1);
+	}
+
+	return g;
+}
+
+
+/**
+ * @brief Rozgalezia pozycje [g] @ref CLONES razy przez @ref gamma_clone,
+ * wykonujac w kazdej kopii @ref CLONE_MOVES ruchow. Wszystkie kopie istnieja
+ * jednoczesnie.
+ *
+ * @param[in] g             : rozgaleziana pozycja
+ * @param[out] clone_time   : sredni czas utworzenia kopii w sekundach
+ * @param[out] move_time    : sredni czas ruchow w kopii w sekundach
+ * @param[out] memory       : przyrost zajetosci pamieci na kopie w kilobajtach
+ */
+void bench_clones(
+	gamma_t *g,
+	double *clone_time,
+	double *move_time,
+	double *memory
+) {
+	gamma_t **clones = malloc(CLONES * sizeof(gamma_t*));
+	if (!clones) {
+		exit(1);
+	}
+
+	long start_memory = get_max_memory();
+	double start = get_time();
+	for (int i = 0; i < CLONES; i++) {
+		clones[i] = gamma_clone(g);
+		if (!clones[i]) {
+			exit(1);
+		}
+	}
+	*clone_time = (get_time() - start) / CLONES;
+
+	uint64_t state = 2463534242ull;
+	start = get_time();
+	for (int i = 0; i < CLONES; i++) {
+		move_t move;
+		for (int j = 0; j < CLONE_MOVES; j++) {
+			make_random_move(clones[i], &state, &move);
+		}
+	}
+	*move_time = (get_time() - start) / CLONES;
+	*memory = (double)(get_max_memory() - start_memory) / CLONES;
+
+	for (int i = 0; i < CLONES; i++) {
+		gamma_delete(clones[i]);
+	}
+	free(clones);
+}
+
+
+/**
+ * @brief Wypisuje koszt rozgalezienia pozycji przez odtworzenie historii i
+ * przez @ref gamma_clone.
+ *
+ * @return Zero.
+ */
+int main() {
+	move_t *history = malloc(HISTORY_MOVES * sizeof(move_t));
+	if (!history) {
+		exit(1);
+	}
+
+	gamma_t *g = new_bench_game();
+	uint64_t state = 88172645463325252ull;
+	size_t history_size = 0;
+	for (uint32_t i = 0; i < HISTORY_MOVES; i++) {
+		if (make_random_move(g, &state, &history[history_size])) {
+			history_size++;
+		}
+	}
+
+	// clones go first, so that the replayed game does not raise the peak
+	// memory usage they are measured against
+	double clone_time;
+	double move_time;
+	double memory;
+	bench_clones(g, &clone_time, &move_time, &memory);
+
+	double start = get_time();
+	gamma_t *replay = new_bench_game();
+	gamma_move_batch(replay, history, history_size, NULL);
+	double replay_time = get_time() - start;
+	gamma_delete(replay);
+
+	printf(
+		"board %d x %d, %zu moves in history\n",
+		BENCH_SIDE,
+		BENCH_SIDE,
+		history_size
+	);
+	printf("replay history   : %12.1f us\n", replay_time * 1e6);
+	printf("gamma_clone      : %12.1f us\n", clone_time * 1e6);
+	printf("%2d moves in clone: %12.1f us\n", CLONE_MOVES, move_time * 1e6);
+	printf("memory per clone : %12.1f KiB\n", memory);
+
+	gamma_delete(g);
+	free(history);
+
+	return 0;
+}
@@ -6,24 +6,66 @@
  */
 
 
-#include <stdio.h>
+#include <stdint.h>
 #include <stdlib.h>
-#include <inttypes.h>
+#include "command_handler.h"
 #include "gamma.h"
 #include "parser.h"
+#include "response_writer.h"
 #include "interactive_mode_handler.h"
 
 
 /**
- * @brief Wykonuje polecenie @p command.
- * Zmienia stan gry w @p gamma stosownie do wydanego polecenia.
- * 
- * @param[in] command   : wskaznik na strukture przechowujaca polecenie
- * @param[in,out] gamma : wskaznik na wskaznik na strukture przechowujaca
- *                        dane gry
- * @param[in] line      : numer linii, w ktorej zostalo wywolane polecenie
+ * Liczba bajtow opisu planszy, do ktorej gra trybu wsadowego zapamietuje
+ * opisy wierszy; polecenie "p" jest tam zwykle wydawane wielokrotnie, wiec
+ * kolejne opisy planszy opisuja od nowa tylko zmienione wiersze.
  */
-void execute_command(
+#define BATCH_BOARD_CACHE_THRESHOLD ((uint64_t)1 << 26)
+
+
+/**
+ * @brief Zwraca odpowiedz oznaczajaca blad w linii @p line.
+ *
+ * @param[in] line  : numer linii, w ktorej zostalo wywolane polecenie
+ *
+ * @return Odpowiedz @ref ERROR_RESPONSE.
+ */
+response_t get_error_response(int line) {
+	return (response_t){.type = ERROR_RESPONSE, .number = line};
+}
+
+
+/**
+ * @brief Zwraca odpowiedz z liczba @p number.
+ *
+ * @param[in] number    : liczba, ktora wypisujemy
+ *
+ * @return Odpowiedz @ref NUMBER_RESPONSE.
+ */
+response_t get_number_response(uint64_t number) {
+	return (response_t){.type = NUMBER_RESPONSE, .number = number};
+}
+
+
+/**
+ * @brief Wykonuje polecenie @p command na silniku gry i zwraca odpowiedz na
+ * nie, bez wypisywania jej.
+ * Zmienia stan gry w @p gamma stosownie do wydanego polecenia. Opis planszy
+ * i tryb interaktywny zostawia wywolujacemu, zwracajac odpowiednio
+ * @ref BOARD_RESPONSE i @ref INTERACTIVE_RESPONSE.
+ *
+ * @param[in] command           : wskaznik na strukture przechowujaca
+ *                                polecenie
+ * @param[in,out] gamma         : wskaznik na wskaznik na strukture
+ *                                przechowujaca dane gry
+ * @param[in,out] game_state    : 0 przed utworzeniem gry, 1 w trybie
+ *                                wsadowym, 2 w trybie interaktywnym
+ * @param[in] line              : numer linii, w ktorej zostalo wywolane
+ *                                polecenie
+ *
+ * @return Odpowiedz na polecenie.
+ */
+response_t get_command_response(
 	command_t *command,
 	gamma_t **gamma,
 	int *game_state,
@@ -36,8 +78,7 @@ void execute_command(
 		command->command_type != ERROR &&
 		!(*game_state)
 	) {
-		fprintf(stderr, "ERROR %d\n", line);
-		return;
+		return get_error_response(line);
 	}
 
 	int arg0 = command->args[0];
@@ -47,57 +88,112 @@ void execute_command(
 
 	switch (command->command_type) {
 		case NEW_GAME_BATCH:
+		case NEW_GAME_INTERACTIVE:
 			if (*game_state > 0) {
-				fprintf(stderr, "ERROR %d\n", line);
-				break;
+				return get_error_response(line);
 			}
-			*gamma = gamma_new(arg0, arg1, arg2, arg3);
-			if (!(*gamma)) {
-				fprintf(stderr, "ERROR %d\n", line);
-				break;
+			if (command->command_type == NEW_GAME_BATCH) {
+				gamma_options_t options;
+				gamma_options_init(&options);
+				options.board_cache_threshold = BATCH_BOARD_CACHE_THRESHOLD;
+				*gamma = gamma_new_ex(arg0, arg1, arg2, arg3, &options);
 			} else {
-				*game_state = 1;
-				fprintf(stdout, "OK %d\n", line);
+				*gamma = gamma_new(arg0, arg1, arg2, arg3);
 			}
-			break;
-		case NEW_GAME_INTERACTIVE:
-			if (*game_state > 0) {
-				fprintf(stderr, "ERROR %d\n", line);
-				break;
-			}
-			*gamma = gamma_new(arg0, arg1, arg2, arg3);
 			if (!(*gamma)) {
-				fprintf(stderr, "ERROR %d\n", line);
-				break;
+				return get_error_response(line);
+			} else if (command->command_type == NEW_GAME_BATCH) {
+				*game_state = 1;
+				return (response_t){.type = OK_RESPONSE, .number = line};
 			} else {
 				*game_state = 2;
-				run_interactive_mode(gamma ,arg0, arg1 + 1, arg2);
+				return (response_t){.type = INTERACTIVE_RESPONSE};
 			}
-			break;
 		case MOVE:
-			fprintf(stdout, "%d\n", gamma_move(*gamma, arg0, arg1, arg2));
-			break;
+			return get_number_response(gamma_move(*gamma, arg0, arg1, arg2));
 		case GOLDEN_MOVE:
-			fprintf(stdout, "%d\n", gamma_golden_move(*gamma, arg0, arg1, arg2));
-			break;
+			return get_number_response(
+				gamma_golden_move(*gamma, arg0, arg1, arg2));
 		case BUSY_FIELDS:
-			fprintf(stdout, "%" PRIu64 "\n", gamma_busy_fields(*gamma, arg0));
-			break;
+			return get_number_response(gamma_busy_fields(*gamma, arg0));
 		case FREE_FIELDS:
-			fprintf(stdout, "%" PRIu64 "\n", gamma_free_fields(*gamma, arg0));
-			break;
+			return get_number_response(gamma_free_fields(*gamma, arg0));
 		case GOLDEN_POSSIBLE:
-			fprintf(stdout, "%d\n", gamma_golden_possible(*gamma, arg0));
+			return get_number_response(gamma_golden_possible(*gamma, arg0));
+		case BOARD:
+			return (response_t){.type = BOARD_RESPONSE};
+		case ERROR:
+			return get_error_response(line);
+		default:
+			return (response_t){.type = NO_RESPONSE};
+	}
+}
+
+
+/**
+ * @brief Dopisuje odpowiedz @p response do buforow @p writer.
+ * Odpowiedzi @ref BOARD_RESPONSE, @ref INTERACTIVE_RESPONSE i
+ * @ref NO_RESPONSE nie maja tekstu, wiec sa pomijane.
+ *
+ * @param[in,out] writer    : bufory, do ktorych trafiaja odpowiedzi
+ * @param[in] response      : wypisywana odpowiedz
+ */
+void write_command_response(
+	response_writer_t *writer,
+	const response_t *response
+) {
+	switch (response->type) {
+		case OK_RESPONSE:
+			write_response(writer, OUTPUT, "OK ", response->number);
 			break;
-		case BOARD:;
-			char *board = gamma_board(*gamma);
-			fprintf(stdout, "%s", board);
-			free(board);
+		case ERROR_RESPONSE:
+			write_response(writer, ERROR_OUTPUT, "ERROR ", response->number);
 			break;
-		case ERROR:
-			fprintf(stderr, "ERROR %d\n", line);
+		case NUMBER_RESPONSE:
+			write_response(writer, OUTPUT, "", response->number);
+			break;
+		default:
+			break;
+	}
+}
+
+
+/**
+ * @brief Wykonuje polecenie @p command.
+ * Zmienia stan gry w @p gamma stosownie do wydanego polecenia.
+ * 
+ * @param[in] command           : wskaznik na strukture przechowujaca
+ *                                polecenie
+ * @param[in,out] gamma         : wskaznik na wskaznik na strukture
+ *                                przechowujaca dane gry
+ * @param[in,out] game_state    : 0 przed utworzeniem gry, 1 w trybie
+ *                                wsadowym, 2 w trybie interaktywnym
+ * @param[in] line              : numer linii, w ktorej zostalo wywolane
+ *                                polecenie
+ * @param[in,out] writer        : bufory, do ktorych trafiaja odpowiedzi
+ */
+void execute_command(
+	command_t *command,
+	gamma_t **gamma,
+	int *game_state,
+	int line,
+	response_writer_t *writer
+) {
+	response_t response = get_command_response(command, gamma, game_state,
+		line);
+
+	switch (response.type) {
+		case BOARD_RESPONSE:
+			flush_responses(writer);
+			gamma_board_write(*gamma, writer->buffers[OUTPUT].fd);
+			break;
+		case INTERACTIVE_RESPONSE:
+			flush_responses(writer);
+			run_interactive_mode(gamma, command->args[0],
+				command->args[1] + 1, command->args[2]);
 			break;
 		default:
+			write_command_response(writer, &response);
 			break;
 	}
 }
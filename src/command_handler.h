@@ -10,24 +10,103 @@
 #define COMMAND_HANDLER_H
 
 
+#include <stdint.h>
 #include "gamma.h"
 #include "parser.h"
+#include "response_writer.h"
+
+
+/**
+ * @brief Rodzaj odpowiedzi na polecenie.
+ * NO_RESPONSE (polecenie nie ma odpowiedzi)
+ * OK_RESPONSE ("OK" i numer linii na standardowym wyjsciu)
+ * ERROR_RESPONSE ("ERROR" i numer linii na wyjsciu diagnostycznym)
+ * NUMBER_RESPONSE (liczba na standardowym wyjsciu)
+ * BOARD_RESPONSE (opis planszy na standardowym wyjsciu)
+ * INTERACTIVE_RESPONSE (rozpoczecie trybu interaktywnego)
+ */
+typedef enum response_type {
+	NO_RESPONSE,
+	OK_RESPONSE,
+	ERROR_RESPONSE,
+	NUMBER_RESPONSE,
+	BOARD_RESPONSE,
+	INTERACTIVE_RESPONSE
+} response_type_t;
+
+
+/**
+ * @brief Odpowiedz na polecenie, gotowa do wypisania.
+ *
+ * @param type      : rodzaj odpowiedzi
+ * @param number    : numer linii lub liczba, zaleznie od rodzaju odpowiedzi
+ */
+typedef struct response {
+	response_type_t type;
+	uint64_t number;
+} response_t;
+
+
+/**
+ * @brief Wykonuje polecenie @p command na silniku gry i zwraca odpowiedz na
+ * nie, bez wypisywania jej.
+ * Zmienia stan gry w @p gamma stosownie do wydanego polecenia. Opis planszy
+ * i tryb interaktywny zostawia wywolujacemu, zwracajac odpowiednio
+ * @ref BOARD_RESPONSE i @ref INTERACTIVE_RESPONSE.
+ *
+ * @param[in] command           : wskaznik na strukture przechowujaca
+ *                                polecenie
+ * @param[in,out] gamma         : wskaznik na wskaznik na strukture
+ *                                przechowujaca dane gry
+ * @param[in,out] game_state    : 0 przed utworzeniem gry, 1 w trybie
+ *                                wsadowym, 2 w trybie interaktywnym
+ * @param[in] line              : numer linii, w ktorej zostalo wywolane
+ *                                polecenie
+ *
+ * @return Odpowiedz na polecenie.
+ */
+response_t get_command_response(
+	command_t *command,
+	gamma_t **gamma,
+	int *game_state,
+	int line
+);
+
+
+/**
+ * @brief Dopisuje odpowiedz @p response do buforow @p writer.
+ * Odpowiedzi @ref BOARD_RESPONSE, @ref INTERACTIVE_RESPONSE i
+ * @ref NO_RESPONSE nie maja tekstu, wiec sa pomijane.
+ *
+ * @param[in,out] writer    : bufory, do ktorych trafiaja odpowiedzi
+ * @param[in] response      : wypisywana odpowiedz
+ */
+void write_command_response(
+	response_writer_t *writer,
+	const response_t *response
+);
 
 
 /**
  * @brief Wykonuje polecenie @p command.
  * Zmienia stan gry w @p gamma stosownie do wydanego polecenia.
  * 
- * @param[in] command   : wskaznik na strukture przechowujaca polecenie
- * @param[in,out] gamma : wskaznik na wskaznik na strukture przechowujaca
- *                        dane gry
- * @param[in] line      : numer linii, w ktorej zostalo wywolane polecenie
+ * @param[in] command           : wskaznik na strukture przechowujaca
+ *                                polecenie
+ * @param[in,out] gamma         : wskaznik na wskaznik na strukture
+ *                                przechowujaca dane gry
+ * @param[in,out] game_state    : 0 przed utworzeniem gry, 1 w trybie
+ *                                wsadowym, 2 w trybie interaktywnym
+ * @param[in] line              : numer linii, w ktorej zostalo wywolane
+ *                                polecenie
+ * @param[in,out] writer        : bufory, do ktorych trafiaja odpowiedzi
  */
 void execute_command(
 	command_t *command,
 	gamma_t **gamma,
 	int *game_state,
-	int line
+	int line,
+	response_writer_t *writer
 );
 
 
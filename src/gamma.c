@@ -5,11 +5,20 @@
  */
 
 
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include "gamma.h"
+#include "gamma_internal.h"
 #include "array_util.h"
+#include "hash_util.h"
 #include "memory_util.h"
+#include "render_util.h"
+#include "search.h"
 
 
 /**
@@ -24,603 +33,2803 @@ const uint32_t offset_x[4] = {0, 1, 0, -1};
 const uint32_t offset_y[4] = {-1, 0, 1, 0};
 
 
+/**
+ * Liczba ruchow, o ktora @ref gamma_move_batch wyprzedza pobieranie danych
+ * pol.
+ */
+#define PREFETCH_DISTANCE 8
+
 
 /**
- * Struktura przechowujaca dane gracza.
- * 
- * @param used_golden_move          : wartosc logiczna mowiaca, czy gracz
- *                                    uzyl juz zloty ruch
- * @param taken_fields              : liczba pol zajetych przez gracza
- * @param available_fields_adjacent : liczba pol mozliwych do zajecia przez
- *                                    gracza bez koniecznosci wykorzystania
- *                                    jeszcze jednego obszaru
- * @param available_fields_far      : liczba pol mozliwych do zajecia przez
- *                                    gracza z koniecznoscia wykorzystania
- *                                    jeszcze jednego obszaru
- * @param occupied_areas            : liczba obszarow zajetych przez gracza
+ * Rozmiar bufora, do ktorego @ref gamma_board_write zapisuje kolejne fragmenty
+ * opisu planszy.
  */
-typedef struct player {
-	bool used_golden_move;
-	uint64_t taken_fields;
-	uint64_t available_fields_adjacent;
-	uint64_t available_fields_far;
-	uint32_t occupied_areas;
-} player_t;
+#define BOARD_BUFFER_SIZE 65536
 
 
+#ifndef DEFAULT_SPARSE_THRESHOLD
 /**
- * @brief Tworzy strukture przechowujaca dane gracza.
- * Alokuje pamiec na nowa strukture.
- * Inicjalizuje te strukture tak, aby reprezentowala poczatkowe dane gracza.
- * 
- * @param[in] height    : wysokosc planszy, na ktorej gracz bedzie gral
- * @param[in] width     : szerokosc planszy, na ktorej gracz bedzie gral
- * 
- * @return Wskaznik na utworzona strukture lub NULL, gdy nie udalo sie
- * zaalokowac pamieci.
+ * Domyslna liczba bajtow, powyzej ktorej plansza jest przechowywana rzadko
+ * (patrz @ref gamma_options_t.sparse_threshold).
  */
-player_t* player_new(uint64_t height, uint64_t width) {
-	player_t *player = malloc(sizeof(player_t));
-	if (!player) {
-		return NULL;
-	}
+#define DEFAULT_SPARSE_THRESHOLD ((uint64_t)1 << 30)
+#endif
 
-	player->used_golden_move = false;
-	player->taken_fields = 0;
-	player->available_fields_adjacent = 0;
-	player->available_fields_far = height * width;
-	player->occupied_areas = 0;
+/**
+ * Domyslna maksymalna liczba wezlow drzewa przeszukiwania
+ * (patrz @ref gamma_options_t.search_nodes).
+ */
+#define DEFAULT_SEARCH_NODES ((uint32_t)1 << 16)
 
-	return player;
-}
+/**
+ * Domyslna liczba bajtow opisu planszy, powyzej ktorej opisy wierszy nie sa
+ * zapamietywane (patrz @ref gamma_options_t.board_cache_threshold). Opisy
+ * wierszy podwajaja pamiec zajeta przez opis planszy, a oplacaja sie tylko
+ * przy wielokrotnym opisywaniu planszy, wiec domyslnie sa wylaczone.
+ */
+#define DEFAULT_BOARD_CACHE_THRESHOLD 0
 
 
 /**
- * Struktura przechowujaca stan gry.
- * 
- * @param field_height      : wysokosc planszy
- * @param field_width       : szerokosc planszy
- * @param player_count      : maksymalna liczba graczy grajacych w te gre
- * @param max_player_areas  : maksymalna liczba obszarow, jakie moze posiadac
- *                            gracz w danym momencie gry
- * @param field             : reprezentacja planszy gry (tablica dwuwymiarowa),
- *                            ktora w danym miejscu trzyma numer gracza, ktorego
- *                            pionek stoi na tym polu lub 0, gdy zaden gracz nie
- *                            ma pionka na tym polu
- * @param leader            : tablica dwuwymiarowa zawierajaca lidera z
- *                            algorytmu Find & Union uzywanego do zliczania
- *                            obszarow zajetych przez gracza
- * 
- * @param max_player_areas  : maksymalna liczba obszarow, ktore gracz moze
- *                            zajmowac w danym momencie gry
+ * Gorne ograniczenie liczby wpisow dziennika zapisywanych przez zwykly ruch:
+ * zlote cele wokol pola (12 przed zajeciem i 20 po nim), zajecie pola (3),
+ * laczenie obszarow (9) lub nowy obszar (3), wezel pola (2) oraz pola
+ * dostepne sasiadow i gracza (16).
+ */
+#define MOVE_JOURNAL_ENTRIES 62
+
+/**
+ * Gorne ograniczenie liczby wpisow dziennika zapisywanych przez zabranie pola
+ * w @ref clear_field, nie liczac przepinania pol rozcinanego obszaru: zlote
+ * cele wokol pola (20 przed zwolnieniem i 12 po nim), zwolnienie pola (5),
+ * pola dostepne (16) oraz nowe wezly obszarow i rozmiar starego (10).
  */
-typedef struct gamma {
-	uint32_t field_height;
-	uint32_t field_width;
-	uint32_t player_count;
-	uint32_t max_player_areas;
+#define CLEAR_JOURNAL_ENTRIES 63
 
-	uint32_t** field;
-	uint64_t** leader;
-	player_t** players;
-} gamma_t;
+/**
+ * Gorne ograniczenie liczby elementow, o ktore ruch lub zloty ruch powieksza
+ * zbior zlotych celow lub pol dostepnych jednego gracza: zlote cele to pole
+ * ruchu i jego sasiedzi (5), a pola dostepne to sasiedzi pola ruchu (4) i
+ * samo pole, gdy zostaje zwolnione (1).
+ */
+#define MOVE_SET_INSERTS 5
 
 
 /**
- * @brief Sprawdza, czy gracz o danym numerze istnieje w grze.
- * Sprawdza, czy numer [player] jest mniejszy lub rowny maksymalnej liczby
- * graczy w grze [g] oraz, czy jest wiekszy od zera.
+ * Wspolna wyzerowana strona danych graczy, ktora czytaja gracze bez wlasnej
+ * strony. Jej licznik odwolan jest zawsze rowny 0, wiec zapis danych jej
+ * graczy zawsze alokuje nowa strone w @ref get_writable_player_page.
+ */
+static player_page_t zero_page;
+
+
+/**
+ * @brief Tworzy pusta tablice danych [players] graczy.
+ * Alokuje tylko tablice lisci katalogu, wiec czas dzialania i pamiec nie
+ * zaleza od liczby graczy (lisc obejmuje @ref PLAYER_LEAF_SIZE stron).
  * 
- * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
- * @param[in] player	: numer gracza, ktory chcemy sprawdzic
+ * @param[out] table    : tablica, ktora inicjalizujemy
+ * @param[in] players   : liczba graczy
  * 
- * @return true, gdy numer gracza nie przekracza maksymalnej liczby graczy
- * w grze lub false w przeciwnym przypadku
+ * @return true, gdy udalo sie zaalokowac pamiec, false w przeciwnym wypadku.
  */
-bool check_player_correct(gamma_t* g, uint32_t player) {
-	return player > 0 && player <= g->player_count;
+static bool player_table_init(player_table_t *table, uint32_t players) {
+	table->page_count = ((uint64_t)players + PLAYER_PAGE_MASK) >>
+		PLAYER_PAGE_SHIFT;
+	table->leaf_count = (table->page_count + PLAYER_LEAF_MASK) >>
+		PLAYER_LEAF_SHIFT;
+	table->leaves = calloc(table->leaf_count, sizeof(player_page_t**));
+
+	return table->leaves != NULL;
 }
 
 
 /**
- * @brief Sprawdza, czy pole o wspolrzednych [x], [y] jest poprawne.
- * Sprawdza, czy [x] i [y] nie przekraczaja wymiarow planszy w grze [g].
+ * @brief Zwraca liczbe stron w lisciu katalogu o numerze [leaf].
+ * Tylko ostatni lisc moze byc krotszy niz @ref PLAYER_LEAF_SIZE.
  * 
- * @param[in,out] g : wskaznik na strukture przechowujaca stan gry
- * @param[in] x     : wspolrzedna osi X pola
- * @param[in] y     : wspolrzedna osi Y pola
+ * @param[in] table : tablica danych graczy
+ * @param[in] leaf  : numer liscia
  * 
- * @return true, gdy wspolrzedne nie przekraczaja wymiarow planszy w grze g,
- * false w przeciwnym wypadku
+ * @return Liczba stron liscia.
  */
-bool check_field_correct(gamma_t* g, uint32_t x, uint32_t y) {
-	return x < g->field_width && y < g->field_height;
+static uint64_t get_leaf_length(const player_table_t *table, uint64_t leaf) {
+	uint64_t rest = table->page_count - (leaf << PLAYER_LEAF_SHIFT);
+	return rest < PLAYER_LEAF_SIZE ? rest : PLAYER_LEAF_SIZE;
 }
 
 
 /**
- * @brief Sprawdza, czy mozemy sie poruszyc na poly gry [g] w kierunku [dir] ze
- * wspolrzednych [x], [y].
- * Kierunek [dir] oznacza:
- * 		0 - gora,
- * 		1 - prawo,
- * 		2 - dol,
- * 		3 - lewo.
- * Gdy [dir] > 3, rozpatruje przypadek dir = 3.
- * 
- * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
- * @param[in] x         : wspolrzedna osi X 
- * @param[in] y         : wspolrzedna osi Y
- * @param[in] dir       : liczba reprezentujaca kierunek, w ktorym chcemy sie
- *                    poruszyc
+ * @brief Oddaje strone danych graczy [page], zwalniajac ja, gdy nie uzywa
+ * jej juz zadna gra.
  * 
- * @return true, gdy mozemy sie poruszyc w danym kierunku, false w przeciwnym
- * wypadku
+ * @param[in,out] page  : strona, ktorej gra juz nie uzywa
  */
-bool check_field_exists(gamma_t *g, uint32_t x, uint32_t y, uint32_t dir) {
-	if (dir == 0) {
-		return y > 0; // up, [y - 1][x]
-	}
-	if (dir == 1) {
-		return x + 1 < g->field_width; // right, [y][x + 1]
+static void release_player_page(player_page_t *page) {
+	if (
+		atomic_fetch_sub_explicit(&page->references, 1, memory_order_acq_rel)
+			!= 1
+	) {
+		return;
 	}
-	if (dir == 2) {
-		return y + 1 < g->field_height; // down, [y + 1][x]
+
+	for (uint32_t i = 0; i < PLAYER_PAGE_SIZE; i++) {
+		cell_set_free(&page->golden_targets[i]);
+		cell_set_free(&page->available_fields[i]);
 	}
-	return x > 0; // left, [y][x - 1]
+	free(page);
 }
 
 
 /**
- * Zwraca liczbe pol sasiadujacych do pola o wspolrzednych [x], [y] oraz
- * nalezacych do gracza [player].
+ * @brief Zwalnia pamiec zaalokowana na tablice danych graczy [table].
+ * Wspoldzielone strony sa zwalniane dopiero przez ostatnia uzywajaca ich
+ * gre.
  * 
- * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
- * @param[in] player	: gracz, ktorego pola sasiadujace do pola o
- *                        wspolrzednych [x], [y] liczymy
- * @param[in] x         : wspolrzedna osi X
- * @param[in] y         : wspolrzedna osi Y
- * 
- * @return Liczba pol sasiadujacych do pola o wspolrzednych [x], [y] oraz
- * nalezacych do gracza [player].
+ * @param[in,out] table : tablica stworzona w @ref player_table_init
  */
-uint32_t get_neighbour_count(
-	gamma_t *g,
-	uint32_t player,
-	uint32_t x,
-	uint32_t y
-) {
-	uint32_t neighbour_count = 0;
+static void free_player_table(player_table_t *table) {
+	for (uint64_t i = 0; i < table->leaf_count; i++) {
+		player_page_t **leaf = table->leaves[i];
+		if (!leaf) {
+			continue;
+		}
 
-	for (int i = 0; i < 4; i++) {
-		uint32_t new_x = x + offset_x[i];
-		uint32_t new_y = y + offset_y[i];
-		if (
-			check_field_exists(g, x, y, i) &&
-			*get_arr_32(g->field, new_x, new_y) == player
-		) {
-			neighbour_count++;
+		for (uint64_t j = 0; j < get_leaf_length(table, i); j++) {
+			if (leaf[j]) {
+				release_player_page(leaf[j]);
+			}
 		}
+		free(leaf);
 	}
-
-	return neighbour_count;
+	free(table->leaves);
+	table->leaves = NULL;
 }
 
 
 /**
- * @brief Znajduje lidera pola o wspolrzednych [x], [y].
- * Znajduje lidera pola zgodnie z algorytmem Find & Union, przestawiajac
- * liderow pol, przez ktore przechodzi, by przyspieszyc kolejne wywolania
- * funkcji.
- * 
- * @param[in,out] g : wskaznik na strukture przechowujaca stan gry
- * @param[in] x     : wspolrzedna osi X pola
- * @param[in] y     : wspolrzedna osi Y pola
+ * @brief Zwalnia pamiec zaalokowana na opisy wierszy planszy [cache].
  * 
- * @return Lider pola.
+ * @param[in,out] cache : zwalniane opisy wierszy
+ * @param[in] height    : wysokosc planszy
  */
-uint64_t find_leader(gamma_t *g, uint32_t x, uint32_t y) {
-	uint64_t curr_leader = *get_arr_64(g->leader, x, y);
-	uint64_t array_index = get_array_index(x, y);
-	if (curr_leader == array_index) {
-		return curr_leader;
-	}
-	if (curr_leader == 0) {
-		return get_array_index(x, y);
+static void free_board_cache(board_cache_t *cache, uint32_t height) {
+	if (!cache->rows) {
+		return;
 	}
 
-	uint32_t leader_x = get_array_x_from_index(curr_leader);
-	uint32_t leader_y = get_array_y_from_index(curr_leader);
-	uint64_t new_leader = find_leader(g, leader_x, leader_y);
-	*get_arr_64(g->leader, x, y) = new_leader;
-
-	return new_leader;
+	for (uint32_t y = 0; y < height; y++) {
+		free(cache->rows[y]);
+	}
+	free(cache->rows);
+	free(cache->lengths);
+	free(cache->dirty);
+	free(cache->line);
+	cache->rows = NULL;
 }
 
 
-/** @brief Tworzy strukturę przechowującą stan gry.
- * Alokuje pamięć na nową strukturę przechowującą stan gry.
- * Inicjuje tę strukturę tak, aby reprezentowała początkowy stan gry.
+/**
+ * @brief Tworzy tablice danych graczy [copy] wspoldzielaca strony z
+ * tablica [table].
+ * Kopiuje tylko katalog, wiec czas dzialania jest proporcjonalny do liczby
+ * lisci, w ktorych jest jakas strona.
  * 
- * @param[in] width   : szerokość planszy, liczba dodatnia,
- * @param[in] height  : wysokość planszy, liczba dodatnia,
- * @param[in] players : liczba graczy, liczba dodatnia,
- * @param[in] areas   : maksymalna liczba obszarów,
- *                      jakie może zająć jeden gracz.
+ * @param[out] copy     : tablica, ktora inicjalizujemy
+ * @param[in] table     : tablica stworzona w @ref player_table_init
  * 
- * @return Wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się
- * zaalokować pamięci lub któryś z parametrów jest niepoprawny.
+ * @return true, gdy udalo sie zaalokowac pamiec, false w przeciwnym wypadku.
  */
-gamma_t* gamma_new(
-	uint32_t width,
-	uint32_t height,
-	uint32_t players,
-	uint32_t areas
+static bool share_player_table(
+	player_table_t *copy,
+	const player_table_t *table
 ) {
-	if (width == 0 || height == 0 || players == 0 || areas == 0) {
-		return NULL;
-	}
-
-	gamma_t *g = malloc(sizeof(gamma_t));
-	if (!g) {
-		return NULL;
-	}
-
-	g->field_width = width;
-	g->field_height = height;
-	g->player_count = players;
-	g->max_player_areas = areas;
-
-	g->field = allocate_2d_array_uint32(height, width);
-	if (!g->field) {
-		free(g);
-		return NULL;
+	copy->page_count = table->page_count;
+	copy->leaf_count = table->leaf_count;
+	copy->leaves = calloc(table->leaf_count, sizeof(player_page_t**));
+	if (!copy->leaves) {
+		return false;
 	}
 
-	g->leader = allocate_2d_array_uint64(height, width);
-	if (!g->leader) {
-		free_2d_array_uint32(g->field);
-		free(g);
-		return NULL;
-	}
+	for (uint64_t i = 0; i < table->leaf_count; i++) {
+		player_page_t **leaf = table->leaves[i];
+		if (!leaf) {
+			continue;
+		}
 
-	g->players = malloc(players * sizeof(player_t));
-	if (!g->players) {
-		free_2d_array_uint32(g->field);
-		free_2d_array_uint64(g->leader);
-		free(g);
-		return NULL;
-	}
-	
-	for (uint32_t i = 0; i < players; i++) {
-		g->players[i] = player_new(height, width);
-		if (!g->players[i]) {
-			for (long long j = i - 1; j >= 0; j--) {
-				free(g->players[j]);
+		uint64_t length = get_leaf_length(table, i);
+		copy->leaves[i] = malloc(length * sizeof(player_page_t*));
+		if (!copy->leaves[i]) {
+			free_player_table(copy);
+			return false;
+		}
+		for (uint64_t j = 0; j < length; j++) {
+			if (leaf[j]) {
+				atomic_fetch_add_explicit(
+					&leaf[j]->references,
+					1,
+					memory_order_relaxed
+				);
 			}
-			free(g->players);
-
-			free_2d_array_uint32(g->field);
-			free_2d_array_uint64(g->leader);
-			free(g);
-			return NULL;
+			copy->leaves[i][j] = leaf[j];
 		}
 	}
 
-	return g;
+	return true;
 }
 
 
-/** @brief Usuwa strukturę przechowującą stan gry.
- * Usuwa z pamięci strukturę wskazywaną przez @p g.
- * Nic nie robi, jeśli wskaźnik ten ma wartość NULL.
+/**
+ * @brief Zwraca pozycje gracza [player] na jego stronie danych.
  * 
- * @param[in,out] g : wskaźnik na usuwaną strukturę.
+ * @param[in] player    : numer gracza
+ * 
+ * @return Pozycja gracza na stronie.
  */
-void gamma_delete(gamma_t *g) {
-	if (!g) {
-		return;
-	}
-	
-	free_2d_array_uint32(g->field);
-	free_2d_array_uint64(g->leader);
-
-	for (uint32_t i = 0; i < g->player_count; i++) {
-		free(g->players[i]);
-	}
-	free(g->players);
-
-	free(g);
+static uint32_t get_player_slot(uint32_t player) {
+	return (player - 1) & PLAYER_PAGE_MASK;
 }
 
 
 /**
- * @brief Ustawia lidera pola o wspolrzednych [new_x], [new_y] na indeks pola o
- * wspolrzednych [x], [y].
- * Ustawia lidera pola [new_y][new_x] na indeks pola [y][x] (z funkcji @ref
- * get_array_index) zgodnie z algorytmem Find & Union.
+ * @brief Zwraca strone danych gracza [player] tylko do odczytu.
+ * Gracz bez wlasnej strony dostaje wspolna strone @ref zero_page.
  * 
- * @param[in,out] g : wskaznik na strukture przechowujaca stan gry
- * @param[in] x     : wspolrzedna osi X pola, ktorego ustawiamy jako lidera
- * @param[in] y     : wspolrzedna osi Y pola, ktorego ustawiamy jako lidera
- * @param[in] new_x : wspolrzedna osi X pola, ktorego lidera zmieniamy
- * @param[in] new_y : wspolrzedna osi Y pola, ktorego lidera zmieniamy
+ * @param[in] g         : wskaznik na strukture przechowujaca stan gry
+ * @param[in] player    : numer gracza
+ * 
+ * @return Wskaznik na strone z danymi gracza.
  */
-void manage_leader(
-	gamma_t *g, 
-	uint32_t x,
-	uint32_t y,
-	uint32_t new_x,
-	uint32_t new_y
-) {
-	uint64_t leader_index = find_leader(g, new_x, new_y);
-	uint32_t leader_x = get_array_x_from_index(leader_index);
-	uint32_t leader_y = get_array_y_from_index(leader_index);
-	*get_arr_64(g->leader, leader_x, leader_y) = get_array_index(x, y);
+static const player_page_t* get_player_page(const gamma_t *g, uint32_t player) {
+	uint64_t page = (player - 1) >> PLAYER_PAGE_SHIFT;
+	player_page_t **leaf = g->players.leaves[page >> PLAYER_LEAF_SHIFT];
+	if (!leaf || !leaf[page & PLAYER_LEAF_MASK]) {
+		return &zero_page;
+	}
+
+	return leaf[page & PLAYER_LEAF_MASK];
 }
 
 
-/** @brief Wykonuje ruch.
- * Ustawia pionek gracza @p player na polu (@p x, @p y).
- * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry,
- * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
- *                      @p players z funkcji @ref gamma_new,
- * @param[in] x       – numer kolumny, liczba nieujemna mniejsza od wartości
- *                      @p width z funkcji @ref gamma_new,
- * @param[in] y       – numer wiersza, liczba nieujemna mniejsza od wartości
- *                      @p height z funkcji @ref gamma_new.
- * @return Wartość @p true, jeśli ruch został wykonany, a @p false,
- * gdy ruch jest nielegalny lub któryś z parametrów jest niepoprawny.
+/**
+ * @brief Zapewnia, ze strona o numerze [page] tablicy [table] nalezy tylko
+ * do niej.
+ * Alokuje strone (i w razie potrzeby lisc katalogu), gdy gracze strony sa
+ * jeszcze w stanie poczatkowym, a strone wspoldzielona z inna gra najpierw
+ * kopiuje.
+ * 
+ * @param[in,out] table : tablica danych graczy
+ * @param[in] page      : numer strony
+ * 
+ * @return Wskaznik na strone, ktora mozna zmieniac, lub NULL, gdy nie udalo
+ * sie zaalokowac pamieci; strona pozostaje wtedy bez zmian.
  */
-bool gamma_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
+static player_page_t* make_page_writable(player_table_t *table, uint64_t page) {
+	uint64_t leaf_index = page >> PLAYER_LEAF_SHIFT;
+	player_page_t **leaf = table->leaves[leaf_index];
+	if (!leaf) {
+		leaf = calloc(
+			get_leaf_length(table, leaf_index),
+			sizeof(player_page_t*)
+		);
+		if (!leaf) {
+			return NULL;
+		}
+		table->leaves[leaf_index] = leaf;
+	}
+
+	player_page_t *data = leaf[page & PLAYER_LEAF_MASK];
 	if (
-		!g ||
-		!check_player_correct(g, player) ||
-		!check_field_correct(g, x, y) ||
-		*get_arr_32(g->field, x, y) != 0 || (
-			get_neighbour_count(g, player, x, y) == 0 &&
-			g->players[player - 1]->occupied_areas == g->max_player_areas
-		)
+		data &&
+		atomic_load_explicit(&data->references, memory_order_acquire) == 1
 	) {
-		return false;
+		return data;
 	}
 
-	// == sets [field]'s owner ==
-	*get_arr_32(g->field, x, y) = player;
-	g->players[player - 1]->taken_fields++;
-
-	uint64_t previous_leaders[4] = {0, 0, 0, 0};
-	for (int i = 0; i < 4; i++) {
-		uint32_t new_x = x + offset_x[i];
-		uint32_t new_y = y + offset_y[i];
-		if (
-			check_field_exists(g, x, y, i) &&
-			*get_arr_32(g->field, new_x, new_y) == player
-		) {
-			bool is_different = true;
-			uint64_t leader = find_leader(g, new_x, new_y);
-			for (long long j = i - 1; j >= 0 && is_different; j--) {
-				if (leader == previous_leaders[j]) {
-					is_different = false;
-				}
-			}
-			if (is_different) {
-				g->players[player - 1]->occupied_areas--;
-			}
-			previous_leaders[i] = leader;
-		}
+	player_page_t *copy = aligned_alloc(
+		alignof(player_page_t),
+		sizeof(player_page_t)
+	);
+	if (!copy) {
+		return NULL;
 	}
 
-	// == connects adjacent fields of the player into one area ==
-	*get_arr_64(g->leader, x, y) = get_array_index(x, y);
-	g->players[player - 1]->occupied_areas++;
-
-	for (int i = 0; i < 4; i++) {
-		uint32_t new_x = x + offset_x[i];
-		uint32_t new_y = y + offset_y[i];
-		if (
-			check_field_exists(g, x, y, i) &&
-			*get_arr_32(g->field, new_x, new_y) == player
-		) {
-			manage_leader(g, x, y, new_x, new_y);
-		}
+	if (!data) {
+		memset(copy, 0, sizeof(player_page_t));
+		atomic_init(&copy->references, 1);
 	}
-
-	// == manage all players available fields ==
-	// managing the field that has been taken
-	for (uint32_t i = 1; i <= g->player_count; i++) {
-		if (get_neighbour_count(g, i, x, y) > 0) {
-			g->players[i - 1]->available_fields_adjacent--;
+	else {
+		memcpy(copy, data, offsetof(player_page_t, golden_targets));
+		atomic_init(&copy->references, 1);
+		// a failed copy leaves an empty set, so every set can be freed below
+		bool copied = true;
+		for (uint32_t i = 0; i < PLAYER_PAGE_SIZE; i++) {
+			copied = cell_set_copy(
+				&copy->golden_targets[i],
+				&data->golden_targets[i]
+			) && copied;
+			copied = cell_set_copy(
+				&copy->available_fields[i],
+				&data->available_fields[i]
+			) && copied;
 		}
-		else {
-			g->players[i - 1]->available_fields_far--;
-		}
-	}
-
-	// managing adjacent fields
-	for (int i = 0; i < 4; i++) {
-		uint32_t new_x = x + offset_x[i];
-		uint32_t new_y = y + offset_y[i];
-		if (
-			check_field_exists(g, x, y, i) &&
-			*get_arr_32(g->field, new_x, new_y) == 0 &&
-			get_neighbour_count(g, player, new_x, new_y) == 1
-		) {
-			g->players[player - 1]->available_fields_adjacent++;
-			g->players[player - 1]->available_fields_far--;
+		if (!copied) {
+			release_player_page(copy);
+			return NULL;
 		}
+		release_player_page(data);
 	}
+	leaf[page & PLAYER_LEAF_MASK] = copy;
 
-	return true;
+	return copy;
 }
 
 
 /**
- * @brief Ustawia lidera wszystkich pol nalezacych do tego samego obszary, co
- * pole o wspolrzednych [x], [y] na [new_leader].
- * Uzywa algorytmu DFS.
+ * @brief Zwraca strone danych gracza [player], ktora mozna zmieniac (patrz
+ * @ref make_page_writable).
+ * Operacje zmieniajace stan gry wywoluja ja dla wszystkich zmienianych
+ * graczy, zanim cokolwiek zmienia (patrz @ref prepare_players), wiec
+ * pozniejsze wywolania nie alokuja pamieci.
  * 
- * @param[in,out] g         : wskaznik na strukture przechowujaca stan gry
- * @param[in] player        : numer gracza, ktorego liderow obszaru zmieniamy
- * @param[in] new_leader	: nowy lider, ktorego ustawiamy na wszystikch
- *                            polach
- * @param[in] x             : wspolrzedna osi X pola, na ktorym obecnie
- *                            jestesmy
- * @param[in] y             : wspolrzedna osi Y pola, na ktorym obecnie
- *                            jestesmy
- */
-void set_leader(
-	gamma_t *g,
-	uint32_t player,
-	uint64_t new_leader,
-	uint32_t x,
-	uint32_t y
-) {
-	*get_arr_64(g->leader, x, y) = new_leader;
-	
-	for (int i = 0; i < 4; i++) {
-		uint32_t new_x = x + offset_x[i];
-		uint32_t new_y = y + offset_y[i];
-		if (
-			check_field_exists(g, x, y, i) &&
-			*get_arr_32(g->field, new_x, new_y) == player &&
-			*get_arr_64(g->leader, new_x, new_y) != new_leader
-		) {
-			set_leader(g, player, new_leader, new_x, new_y);
-		}
-	}
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] player    : numer gracza
+ * 
+ * @return Wskaznik na strone danych gracza nalezaca tylko do gry [g] lub
+ * NULL, gdy nie udalo sie zaalokowac pamieci.
+ */
+static player_page_t* get_writable_player_page(gamma_t *g, uint32_t player) {
+	return make_page_writable(&g->players, (player - 1) >> PLAYER_PAGE_SHIFT);
 }
 
 
 /**
- * @brief Zabiera pole o wspolrzednych [x], [y] od gracza o numerze [player].
- * Ustawia pole [y][x] jako pole niczyje, nastepnie aktualizuje liderow
- * sasiednich pol nalezacych do gracza [player] oraz aktualizuje pola dostepne
- * wszystkich graczy.
+ * @brief Zwraca liczbe obszarow zajetych przez gracza [player].
  * 
- * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
- * @param[in] player    : numer gracza, od ktorego zabieramy pole
- * @param[in] x         : wspolrzednia osi X pola, ktore zabieramy graczowi
- * @param[in] y         : wspolrzednia osi Y pola, ktore zabieramy graczowi
+ * @param[in] g         : wskaznik na strukture przechowujaca stan gry
+ * @param[in] player    : numer gracza
+ * 
+ * @return Liczba obszarow gracza.
+ */
+static uint64_t get_occupied_areas(const gamma_t *g, uint32_t player) {
+	return get_player_page(g, player)->occupied_areas[get_player_slot(player)];
+}
+
+
+/**
+ * @brief Sprawdza, czy gracz [player] wykorzystal zloty ruch.
+ * 
+ * @param[in] g         : wskaznik na strukture przechowujaca stan gry
+ * @param[in] player    : numer gracza
+ * 
+ * @return true, gdy gracz wykorzystal zloty ruch, false w przeciwnym wypadku.
+ */
+static bool get_golden_used(const gamma_t *g, uint32_t player) {
+	return get_player_page(g, player)->used_golden_move >>
+		get_player_slot(player) & 1;
+}
+
+
+/**
+ * @brief Sprawdza, czy gracz o danym numerze istnieje w grze.
+ * Sprawdza, czy numer [player] jest mniejszy lub rowny maksymalnej liczby
+ * graczy w grze [g] oraz, czy jest wiekszy od zera.
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] player	: numer gracza, ktory chcemy sprawdzic
+ * 
+ * @return true, gdy numer gracza nie przekracza maksymalnej liczby graczy
+ * w grze lub false w przeciwnym przypadku
+ */
+static bool check_player_correct(gamma_t* g, uint32_t player) {
+	return player > 0 && player <= g->player_count;
+}
+
+
+/**
+ * @brief Sprawdza, czy pole o wspolrzednych [x], [y] jest poprawne.
+ * Sprawdza, czy [x] i [y] nie przekraczaja wymiarow planszy w grze [g].
+ * 
+ * @param[in,out] g : wskaznik na strukture przechowujaca stan gry
+ * @param[in] x     : wspolrzedna osi X pola
+ * @param[in] y     : wspolrzedna osi Y pola
+ * 
+ * @return true, gdy wspolrzedne nie przekraczaja wymiarow planszy w grze g,
+ * false w przeciwnym wypadku
+ */
+static bool check_field_correct(gamma_t* g, uint32_t x, uint32_t y) {
+	return x < g->field_width && y < g->field_height;
+}
+
+
+/**
+ * @brief Zapewnia w dzienniku miejsce na [count] nowych wpisow.
+ * Nic nie robi, gdy zapisywanie zmian jest wylaczone. Operacje zmieniajace
+ * stan gry rezerwuja miejsce, zanim cokolwiek zmienia, wiec brak pamieci
+ * nie zostawia gry w polowie zmiany.
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] count     : liczba wpisow, ktore beda potrzebne
+ * 
+ * @return true, gdy udalo sie zapewnic miejsce, false w przeciwnym wypadku.
+ */
+static bool reserve_journal(gamma_t *g, uint64_t count) {
+	journal_t *journal = &g->journal;
+	if (!journal->active || journal->capacity - journal->size >= count) {
+		return true;
+	}
+
+	uint64_t capacity = journal->capacity ? 2 * journal->capacity : 64;
+	while (capacity - journal->size < count) {
+		capacity *= 2;
+	}
+
+	journal_entry_t *entries =
+		realloc(journal->entries, capacity * sizeof(journal_entry_t));
+	if (!entries) {
+		return false;
+	}
+	journal->entries = entries;
+	journal->capacity = capacity;
+
+	return true;
+}
+
+
+/**
+ * @brief Zapisuje w dzienniku zmiane rodzaju [type].
+ * Nic nie robi, gdy zapisywanie zmian jest wylaczone. Miejsce na wpis musi
+ * zostac wczesniej zapewnione przez @ref reserve_journal.
+ * 
+ * @param[in,out] g : wskaznik na strukture przechowujaca stan gry
+ * @param[in] type  : rodzaj zmiany
+ * @param[in] index : indeks pola, numer wezla lub numer gracza pomniejszony
+ *                    o 1, zaleznie od rodzaju zmiany
+ * @param[in] value : wartosc sprzed zmiany lub indeks pola zlotego celu
+ * 
+ * @return Wskaznik na zapisana zmiane lub NULL, gdy zapisywanie zmian jest
+ * wylaczone.
+ */
+static journal_entry_t* record_change(
+	gamma_t *g,
+	journal_entry_type_t type,
+	uint64_t index,
+	uint64_t value
+) {
+	journal_t *journal = &g->journal;
+	if (!journal->active) {
+		return NULL;
+	}
+
+	journal_entry_t *entry = &journal->entries[journal->size++];
+	entry->type = type;
+	entry->index = index;
+	entry->value = value;
+
+	return entry;
+}
+
+
+/**
+ * @brief Zwieksza licznik [counter] o [delta], zapisujac zmiane w dzienniku.
+ * 
+ * @param[in,out] g         : wskaznik na strukture przechowujaca stan gry
+ * @param[in,out] counter   : licznik w strukturze gry lub gracza
+ * @param[in] delta         : zmiana licznika (moze byc ujemna)
+ */
+static void change_counter(gamma_t *g, uint64_t *counter, int64_t delta) {
+	journal_entry_t *entry = record_change(g, JOURNAL_COUNTER, 0, *counter);
+	if (entry) {
+		entry->counter = counter;
+	}
+
+	*counter += delta;
+}
+
+
+/**
+ * @brief Zwraca zbior @ref player_page_t.golden_targets gracza [player],
+ * ktory mozna zmieniac.
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] player    : numer gracza
+ * 
+ * @return Wskaznik na zbior.
+ */
+static cell_set_t* get_writable_golden_targets(gamma_t *g, uint32_t player) {
+	player_page_t *page = get_writable_player_page(g, player);
+	return &page->golden_targets[get_player_slot(player)];
+}
+
+
+/**
+ * @brief Zwraca zbior @ref player_page_t.available_fields gracza [player],
+ * ktory mozna zmieniac.
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] player    : numer gracza
+ * 
+ * @return Wskaznik na zbior.
+ */
+static cell_set_t* get_writable_available_fields(gamma_t *g, uint32_t player) {
+	player_page_t *page = get_writable_player_page(g, player);
+	return &page->available_fields[get_player_slot(player)];
+}
+
+
+/**
+ * @brief Zwieksza liczbe pol zajetych przez gracza [player] o [delta],
+ * zapisujac zmiane w dzienniku.
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] player    : numer gracza
+ * @param[in] delta     : zmiana liczby pol (moze byc ujemna)
+ */
+static void change_taken_fields(gamma_t *g, uint32_t player, int64_t delta) {
+	player_page_t *page = get_writable_player_page(g, player);
+	change_counter(g, &page->taken_fields[get_player_slot(player)], delta);
+}
+
+
+/**
+ * @brief Zwieksza liczbe obszarow zajetych przez gracza [player] o [delta],
+ * zapisujac zmiane w dzienniku.
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] player    : numer gracza
+ * @param[in] delta     : zmiana liczby obszarow (moze byc ujemna)
+ */
+static void change_occupied_areas(gamma_t *g, uint32_t player, int64_t delta) {
+	player_page_t *page = get_writable_player_page(g, player);
+	change_counter(g, &page->occupied_areas[get_player_slot(player)], delta);
+}
+
+
+/**
+ * @brief Zwraca indeks pola o wspolrzednych [x], [y] w tablicach planszy.
+ * Uwzglednia uklad pol @ref gamma_t.layout.
+ * 
+ * @param[in] g : wskaznik na strukture przechowujaca stan gry
+ * @param[in] x : wspolrzedna osi X pola
+ * @param[in] y : wspolrzedna osi Y pola
+ * 
+ * @return Indeks pola.
+ */
+static uint64_t get_field_index(gamma_t *g, uint32_t x, uint32_t y) {
+	if (g->layout == GAMMA_LAYOUT_BLOCKED) {
+		return get_block_cell_index(g->block_columns, x, y);
+	}
+
+	return get_cell_index(g->field_width, x, y);
+}
+
+
+/**
+ * @brief Zapisuje w [x], [y] wspolrzedne pola o indeksie [index].
+ * Odwrotnosc @ref get_field_index.
+ * 
+ * @param[in] g         : wskaznik na strukture przechowujaca stan gry
+ * @param[in] index     : indeks pola
+ * @param[out] x        : wspolrzedna osi X pola
+ * @param[out] y        : wspolrzedna osi Y pola
+ */
+static void get_field_position(
+	gamma_t *g,
+	uint64_t index,
+	uint32_t *x,
+	uint32_t *y
+) {
+	if (g->layout == GAMMA_LAYOUT_BLOCKED) {
+		uint64_t block = index >> (2 * BLOCK_SHIFT);
+		*x = (block % g->block_columns) << BLOCK_SHIFT | (index & BLOCK_MASK);
+		*y = (block / g->block_columns) << BLOCK_SHIFT |
+			((index >> BLOCK_SHIFT) & BLOCK_MASK);
+		return;
+	}
+
+	*x = index % g->field_width;
+	*y = index / g->field_width;
+}
+
+
+/**
+ * @brief Miesza bity liczby [value] (splitmix64).
+ * 
+ * @param[in] value : liczba
+ * 
+ * @return Wymieszana liczba.
+ */
+static uint64_t mix_hash_bits(uint64_t value) {
+	uint64_t z = value + 0x9E3779B97F4A7C15ull;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+
+	return z ^ (z >> 31);
+}
+
+
+/**
+ * @brief Zwraca klucz Zobrista pola o numerze [index] (wierszami, niezaleznie
+ * od ukladu planszy) z pionkiem gracza [owner].
+ * Klucze sa wyliczane, a nie trzymane w tablicy, bo plansza moze byc
+ * ogromna.
+ * 
+ * @param[in] index : numer pola rowny y * szerokosc + x
+ * @param[in] owner : numer gracza lub 0
+ * 
+ * @return Klucz lub 0, gdy pole jest wolne.
+ */
+static uint64_t get_field_key(uint64_t index, uint32_t owner) {
+	return owner ? mix_hash_bits(mix_hash_bits(index) ^ owner) : 0;
+}
+
+
+/**
+ * @brief Zwraca klucz Zobrista wykorzystanego zlotego ruchu gracza [player].
+ * 
+ * @param[in] player    : numer gracza
+ * 
+ * @return Klucz.
+ */
+static uint64_t get_golden_key(uint32_t player) {
+	return mix_hash_bits(mix_hash_bits(player) ^ 0x676F6C64656Eull);
+}
+
+
+/**
+ * @brief Zwraca numer pola o wspolrzednych [x], [y] po symetrii planszy
+ * numer [symmetry].
+ * Bit 0 symetrii odbija plansze w poziomie, bit 1 w pionie, a bit 2
+ * (tylko dla planszy kwadratowej) zamienia osie po odbiciach.
+ * 
+ * @param[in] g         : wskaznik na strukture przechowujaca stan gry
+ * @param[in] x         : wspolrzedna osi X pola
+ * @param[in] y         : wspolrzedna osi Y pola
+ * @param[in] symmetry  : numer symetrii od 1 do 7
+ * 
+ * @return Numer pola rowny y * szerokosc + x po symetrii.
+ */
+static uint64_t get_symmetric_index(
+	gamma_t *g,
+	uint32_t x,
+	uint32_t y,
+	uint32_t symmetry
+) {
+	if (symmetry & 1) {
+		x = g->field_width - 1 - x;
+	}
+	if (symmetry & 2) {
+		y = g->field_height - 1 - y;
+	}
+	if (symmetry & 4) {
+		uint32_t swap = x;
+		x = y;
+		y = swap;
+	}
+
+	return (uint64_t)y * g->field_width + x;
+}
+
+
+/**
+ * @brief Uaktualnia skroty pozycji po zmianie wlasciciela pola o indeksie
+ * [index] z [old_owner] na [new_owner].
+ * 
+ * @param[in,out] g         : wskaznik na strukture przechowujaca stan gry
+ * @param[in] index         : indeks pola z @ref get_field_index
+ * @param[in] old_owner     : poprzedni wlasciciel pola lub 0
+ * @param[in] new_owner     : nowy wlasciciel pola lub 0
+ */
+static void update_field_hash(
+	gamma_t *g,
+	uint64_t index,
+	uint32_t old_owner,
+	uint32_t new_owner
+) {
+	uint32_t x;
+	uint32_t y;
+	uint64_t row_index = index;
+	if (g->layout == GAMMA_LAYOUT_BLOCKED || g->symmetry_count) {
+		get_field_position(g, index, &x, &y);
+		row_index = (uint64_t)y * g->field_width + x;
+	}
+	g->hash ^= get_field_key(row_index, old_owner) ^
+		get_field_key(row_index, new_owner);
+
+	for (uint32_t i = 0; i < g->symmetry_count; i++) {
+		uint64_t symmetric = get_symmetric_index(g, x, y, i + 1);
+		g->symmetry_hashes[i] ^= get_field_key(symmetric, old_owner) ^
+			get_field_key(symmetric, new_owner);
+	}
+}
+
+
+/**
+ * @brief Ustawia, czy gracz [player] wykorzystal zloty ruch, bez zapisywania
+ * zmiany w dzienniku, i uaktualnia skroty pozycji.
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] player    : numer gracza
+ * @param[in] used      : czy gracz wykorzystal zloty ruch
+ */
+static void store_golden_used(gamma_t *g, uint32_t player, bool used) {
+	player_page_t *page = get_writable_player_page(g, player);
+	uint64_t bit = (uint64_t)1 << get_player_slot(player);
+	if (!(page->used_golden_move & bit) != !used) {
+		uint64_t key = get_golden_key(player);
+		g->hash ^= key;
+		for (uint32_t i = 0; i < g->symmetry_count; i++) {
+			g->symmetry_hashes[i] ^= key;
+		}
+	}
+	page->used_golden_move = used ? page->used_golden_move | bit :
+		page->used_golden_move & ~bit;
+}
+
+
+/**
+ * @brief Zwraca numer gracza zajmujacego pole o indeksie [index].
+ * 
+ * @param[in] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] index : indeks pola z @ref get_field_index
+ * 
+ * @return Numer gracza lub 0, gdy pole jest wolne.
+ */
+static uint32_t get_owner_at(gamma_t *g, uint64_t index) {
+	if (g->sparse) {
+		field_entry_t *entry = field_map_find(&g->fields, index);
+		return entry ? entry->owner : 0;
+	}
+
+	return get_cell(&g->field, index);
+}
+
+
+/**
+ * @brief Zwraca numer wiersza pola o indeksie [index].
+ * 
+ * @param[in] g         : wskaznik na strukture przechowujaca stan gry
+ * @param[in] index     : indeks pola z @ref get_field_index
+ * 
+ * @return Numer wiersza pola.
+ */
+static uint32_t get_index_row(gamma_t *g, uint64_t index) {
+	if (g->layout == GAMMA_LAYOUT_BLOCKED) {
+		uint64_t block_row = (index >> (2 * BLOCK_SHIFT)) / g->block_columns;
+		return block_row << BLOCK_SHIFT | ((index >> BLOCK_SHIFT) & BLOCK_MASK);
+	}
+
+	return index / g->field_width;
+}
+
+
+/**
+ * @brief Ustawia wlasciciela pola o indeksie [index] na [player] bez
+ * zapisywania zmiany w dzienniku.
+ * Uaktualnia skroty pozycji i @ref gamma_t.bracket_space oraz oznacza opis
+ * wiersza pola jako nieaktualny. W rzadkiej reprezentacji usuwa wpis pola,
+ * gdy nie trzyma on juz zadnych danych.
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] index     : indeks pola z @ref get_field_index
+ * @param[in] player    : numer gracza lub 0, gdy pole ma byc wolne
+ */
+static void store_owner_at(gamma_t *g, uint64_t index, uint32_t player) {
+	uint32_t old_owner = get_owner_at(g, index);
+	update_field_hash(g, index, old_owner, player);
+	g->owner_changes++;
+	g->bracket_space += get_bracket_space(player) -
+		get_bracket_space(old_owner);
+	if (g->board_cache.rows) {
+		uint32_t y = get_index_row(g, index);
+		g->board_cache.dirty[y >> 6] |= (uint64_t)1 << (y & 63);
+	}
+
+	if (!g->sparse) {
+		set_cell(&g->field, index, player);
+		return;
+	}
+
+	if (player) {
+		field_map_get(&g->fields, index)->owner = player;
+		return;
+	}
+
+	field_entry_t *entry = field_map_find(&g->fields, index);
+	if (entry) {
+		entry->owner = 0;
+		if (!entry->node) {
+			field_map_erase(&g->fields, index);
+		}
+	}
+}
+
+
+/**
+ * @brief Ustawia wlasciciela pola o indeksie [index] na [player].
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] index     : indeks pola z @ref get_field_index
+ * @param[in] player    : numer gracza lub 0, gdy pole ma byc wolne
+ */
+static void set_owner_at(gamma_t *g, uint64_t index, uint32_t player) {
+	record_change(g, JOURNAL_OWNER, index, get_owner_at(g, index));
+	store_owner_at(g, index, player);
+}
+
+
+/**
+ * @brief Zwraca numer wezla lasu obszarow pola o indeksie [index].
+ * 
+ * @param[in] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] index : indeks pola z @ref get_field_index
+ * 
+ * @return Numer wezla lub 0, gdy pole jest wolne.
+ */
+static uint64_t get_field_node(gamma_t *g, uint64_t index) {
+	if (g->sparse) {
+		field_entry_t *entry = field_map_find(&g->fields, index);
+		return entry ? entry->node : 0;
+	}
+
+	return get_cell(&g->area, index);
+}
+
+
+/**
+ * @brief Ustawia numer wezla lasu obszarow pola o indeksie [index] na [node]
+ * bez zapisywania zmiany w dzienniku.
+ * W rzadkiej reprezentacji usuwa wpis pola, gdy nie trzyma on juz zadnych
+ * danych.
+ * 
+ * @param[in,out] g : wskaznik na strukture przechowujaca stan gry
+ * @param[in] index : indeks pola z @ref get_field_index
+ * @param[in] node  : numer wezla lub 0, gdy pole jest wolne
+ */
+static void store_field_node(gamma_t *g, uint64_t index, uint64_t node) {
+	if (!g->sparse) {
+		set_cell(&g->area, index, node);
+		return;
+	}
+
+	if (node) {
+		field_map_get(&g->fields, index)->node = node;
+		return;
+	}
+
+	field_entry_t *entry = field_map_find(&g->fields, index);
+	if (entry) {
+		entry->node = 0;
+		if (!entry->owner) {
+			field_map_erase(&g->fields, index);
+		}
+	}
+}
+
+
+/**
+ * @brief Ustawia numer wezla lasu obszarow pola o indeksie [index] na [node].
+ * 
+ * @param[in,out] g : wskaznik na strukture przechowujaca stan gry
+ * @param[in] index : indeks pola z @ref get_field_index
+ * @param[in] node  : numer wezla lub 0, gdy pole jest wolne
+ */
+static void set_field_node(gamma_t *g, uint64_t index, uint64_t node) {
+	record_change(g, JOURNAL_NODE, index, get_field_node(g, index));
+	store_field_node(g, index, node);
+}
+
+
+/**
+ * @brief Zwraca numer gracza zajmujacego pole o wspolrzednych [x], [y].
+ * 
+ * @param[in] g : wskaznik na strukture przechowujaca stan gry
+ * @param[in] x : wspolrzedna osi X pola
+ * @param[in] y : wspolrzedna osi Y pola
+ * 
+ * @return Numer gracza lub 0, gdy pole jest wolne.
+ */
+static uint32_t get_field_owner(gamma_t *g, uint32_t x, uint32_t y) {
+	return get_owner_at(g, get_field_index(g, x, y));
+}
+
+
+/**
+ * @brief Ustawia wlasciciela pola o wspolrzednych [x], [y] na [player].
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] x         : wspolrzedna osi X pola
+ * @param[in] y         : wspolrzedna osi Y pola
+ * @param[in] player    : numer gracza lub 0, gdy pole ma byc wolne
+ */
+static void set_field_owner(
+	gamma_t *g,
+	uint32_t x,
+	uint32_t y,
+	uint32_t player
+) {
+	set_owner_at(g, get_field_index(g, x, y), player);
+}
+
+
+/**
+ * @brief Sprawdza, czy mozemy sie poruszyc na poly gry [g] w kierunku [dir] ze
+ * wspolrzednych [x], [y].
+ * Kierunek [dir] oznacza:
+ * 		0 - gora,
+ * 		1 - prawo,
+ * 		2 - dol,
+ * 		3 - lewo.
+ * Gdy [dir] > 3, rozpatruje przypadek dir = 3.
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] x         : wspolrzedna osi X 
+ * @param[in] y         : wspolrzedna osi Y
+ * @param[in] dir       : liczba reprezentujaca kierunek, w ktorym chcemy sie
+ *                    poruszyc
+ * 
+ * @return true, gdy mozemy sie poruszyc w danym kierunku, false w przeciwnym
+ * wypadku
+ */
+static bool check_field_exists(
+	gamma_t *g,
+	uint32_t x,
+	uint32_t y,
+	uint32_t dir
+) {
+	if (dir == 0) {
+		return y > 0; // up, [y - 1][x]
+	}
+	if (dir == 1) {
+		return x + 1 < g->field_width; // right, [y][x + 1]
+	}
+	if (dir == 2) {
+		return y + 1 < g->field_height; // down, [y + 1][x]
+	}
+	return x > 0; // left, [y][x - 1]
+}
+
+
+/**
+ * Zwraca liczbe pol sasiadujacych do pola o wspolrzednych [x], [y] oraz
+ * nalezacych do gracza [player].
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] player	: gracz, ktorego pola sasiadujace do pola o
+ *                        wspolrzednych [x], [y] liczymy
+ * @param[in] x         : wspolrzedna osi X
+ * @param[in] y         : wspolrzedna osi Y
+ * 
+ * @return Liczba pol sasiadujacych do pola o wspolrzednych [x], [y] oraz
+ * nalezacych do gracza [player].
+ */
+static uint32_t get_neighbour_count(
+	gamma_t *g,
+	uint32_t player,
+	uint32_t x,
+	uint32_t y
+) {
+	uint32_t neighbour_count = 0;
+
+	for (int i = 0; i < 4; i++) {
+		uint32_t new_x = x + offset_x[i];
+		uint32_t new_y = y + offset_y[i];
+		if (
+			check_field_exists(g, x, y, i) &&
+			get_field_owner(g, new_x, new_y) == player
+		) {
+			neighbour_count++;
+		}
+	}
+
+	return neighbour_count;
+}
+
+
+/**
+ * @brief Zapisuje do [owners] roznych graczy, ktorych pola sasiaduja z polem o
+ * wspolrzednych [x], [y].
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] x         : wspolrzedna osi X
+ * @param[in] y         : wspolrzedna osi Y
+ * @param[out] owners   : tablica na co najwyzej 4 numery graczy
+ * 
+ * @return Liczba graczy zapisanych w [owners].
+ */
+static int get_neighbour_owners(
+	gamma_t *g,
+	uint32_t x,
+	uint32_t y,
+	uint32_t *owners
+) {
+	int owner_count = 0;
+
+	for (int i = 0; i < 4; i++) {
+		if (!check_field_exists(g, x, y, i)) {
+			continue;
+		}
+
+		uint32_t owner = get_field_owner(g, x + offset_x[i], y + offset_y[i]);
+		bool repeated = owner == 0;
+		for (int j = 0; j < owner_count && !repeated; j++) {
+			repeated = owners[j] == owner;
+		}
+		if (!repeated) {
+			owners[owner_count++] = owner;
+		}
+	}
+
+	return owner_count;
+}
+
+
+/**
+ * @brief Zwraca flage oznaczajaca korzen w lesie obszarow.
+ * Korzen trzyma w @ref gamma_t.area_parent te flage oraz liczbe pol obszaru,
+ * pozostale wezly trzymaja numer swojego rodzica.
+ * 
+ * @param[in] g : wskaznik na strukture przechowujaca stan gry
+ * 
+ * @return Najstarszy bit komorki lasu obszarow.
+ */
+static uint64_t get_root_flag(gamma_t *g) {
+	return (uint64_t)1 << (g->area_parent.cell_size * 8 - 1);
+}
+
+
+/**
+ * @brief Zwraca liczbe pol obszaru, ktorego korzeniem jest wezel [root].
+ * 
+ * @param[in] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] root  : numer korzenia w lesie obszarow
+ * 
+ * @return Liczba pol obszaru.
+ */
+static uint64_t get_area_size(gamma_t *g, uint64_t root) {
+	return get_cell(&g->area_parent, root) & ~get_root_flag(g);
+}
+
+
+/**
+ * @brief Ustawia komorke wezla [node] lasu obszarow na [value], zapisujac
+ * zmiane w dzienniku.
+ * 
+ * @param[in,out] g : wskaznik na strukture przechowujaca stan gry
+ * @param[in] node  : numer wezla
+ * @param[in] value : numer rodzica lub flaga korzenia z liczba pol obszaru
+ */
+static void set_area_parent(gamma_t *g, uint64_t node, uint64_t value) {
+	record_change(g, JOURNAL_PARENT, node, get_cell(&g->area_parent, node));
+	set_cell(&g->area_parent, node, value);
+}
+
+
+/**
+ * @brief Ustawia liczbe pol obszaru o korzeniu [root] na [size].
+ * 
+ * @param[in,out] g : wskaznik na strukture przechowujaca stan gry
+ * @param[in] root  : numer korzenia w lesie obszarow
+ * @param[in] size  : nowa liczba pol obszaru
+ */
+static void set_area_size(gamma_t *g, uint64_t root, uint64_t size) {
+	set_area_parent(g, root, get_root_flag(g) | size);
+}
+
+
+/**
+ * @brief Znajduje korzen wezla [node] w lesie obszarow.
+ * Znajduje korzen zgodnie z algorytmem Find & Union. Iteracyjnie przepina co
+ * drugi wezel na sciezce do korzenia (path halving), by przyspieszyc kolejne
+ * wywolania funkcji. Gdy dziennik jest wlaczony, nie przepina wezlow, by nie
+ * zapisywac w nim zmian, ktore nie zmieniaja stanu gry; glebokosc drzew
+ * ogranicza wtedy samo laczenie wedlug rozmiaru. Nie przepina tez wezlow w
+ * kafelkach wspoldzielonych z inna gra, bo ich kopiowanie mogloby sie nie
+ * udac, wiec nigdy nie alokuje pamieci.
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] node      : numer wezla
+ * 
+ * @return Numer korzenia.
+ */
+static uint64_t find_leader(gamma_t *g, uint64_t node) {
+	uint64_t root_flag = get_root_flag(g);
+	uint64_t parent = get_cell(&g->area_parent, node);
+
+	while (!(parent & root_flag)) {
+		uint64_t grandparent = get_cell(&g->area_parent, parent);
+		if (grandparent & root_flag) {
+			return parent;
+		}
+		if (
+			!g->journal.active &&
+			check_cell_writable(&g->area_parent, node)
+		) {
+			set_cell(&g->area_parent, node, grandparent);
+		}
+		node = grandparent;
+		parent = get_cell(&g->area_parent, node);
+	}
+
+	return node;
+}
+
+
+/**
+ * @brief Laczy obszary o korzeniach [root_a] i [root_b].
+ * Podpina mniejszy obszar pod korzen wiekszego (union by size).
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] root_a    : korzen pierwszego obszaru
+ * @param[in] root_b    : korzen drugiego obszaru, rozny od [root_a]
+ * 
+ * @return Korzen polaczonego obszaru.
+ */
+static uint64_t union_areas(gamma_t *g, uint64_t root_a, uint64_t root_b) {
+	uint64_t size_a = get_area_size(g, root_a);
+	uint64_t size_b = get_area_size(g, root_b);
+	if (size_a < size_b) {
+		uint64_t tmp = root_a;
+		root_a = root_b;
+		root_b = tmp;
+	}
+
+	set_area_parent(g, root_b, root_a);
+	set_area_size(g, root_a, size_a + size_b);
+
+	return root_a;
+}
+
+
+/**
+ * @brief Porzadkuje las obszarow.
+ * Przepina kazde zajete pole bezposrednio na nowy numer korzenia swojego
+ * obszaru, numerujac korzenie od 1, i usuwa wszystkie pozostale wezly.
+ * Zwalnia w ten sposob wezly, ktore zostaly po rozcinaniu obszarow. Pamiec
+ * jest alokowana przed pierwsza zmiana, wiec gdy jej zabraknie, las pozostaje
+ * bez zmian.
+ * 
+ * @param[in,out] g : wskaznik na strukture przechowujaca stan gry
+ * 
+ * @return true, gdy udalo sie zaalokowac pamiec, false w przeciwnym wypadku.
+ */
+static bool compact_area_nodes(gamma_t *g) {
+	// every taken field gets a node entry and at most one new root
+	if (!reserve_journal(g, 2 * g->taken_fields_total + 1)) {
+		return false;
+	}
+
+	// tiles shared with a clone are copied up front; tiles that were never
+	// written hold no nodes, so they are not written here either
+	uint64_t *new_node = calloc(g->area_node_count + 1, sizeof(uint64_t));
+	uint64_t *sizes = calloc(g->area_node_count + 1, sizeof(uint64_t));
+	if (
+		!new_node || !sizes ||
+		!unshare_cell_array(&g->area) ||
+		!unshare_cell_array(&g->area_parent)
+	) {
+		free(new_node);
+		free(sizes);
+		return false;
+	}
+
+	uint64_t node_count = 0;
+	if (g->sparse) {
+		uint64_t position = 0;
+		field_entry_t *entry;
+		while ((entry = field_map_next(&g->fields, &position))) {
+			if (entry->node) {
+				uint64_t root = find_leader(g, entry->node);
+				if (!new_node[root]) {
+					new_node[root] = ++node_count;
+				}
+				record_change(g, JOURNAL_NODE, entry->key - 1, entry->node);
+				entry->node = new_node[root];
+			}
+		}
+	}
+	for (uint64_t i = 0; i < g->area.length; i++) {
+		uint64_t node = get_cell(&g->area, i);
+		if (node) {
+			uint64_t root = find_leader(g, node);
+			if (!new_node[root]) {
+				new_node[root] = ++node_count;
+			}
+			set_field_node(g, i, new_node[root]);
+		}
+	}
+
+	// roots get new numbers in the order of their first field, so sizes are
+	// moved through a temporary array to avoid overwriting unread roots
+	for (uint64_t node = 1; node <= g->area_node_count; node++) {
+		if (new_node[node]) {
+			sizes[new_node[node]] = get_area_size(g, node);
+		}
+	}
+	for (uint64_t node = 1; node <= node_count; node++) {
+		set_area_size(g, node, sizes[node]);
+	}
+
+	change_counter(g, &g->area_node_count, node_count - g->area_node_count);
+	free(sizes);
+	free(new_node);
+
+	return true;
+}
+
+
+/**
+ * @brief Zwraca liczbe wezlow, po ktorej przekroczeniu las obszarow jest
+ * porzadkowany w @ref compact_area_nodes.
+ * Kazda operacja zuzywa co najwyzej kilka wezlow, a porzadkowanie zostawia
+ * najwyzej jeden wezel na zajete pole. Dla tablicowej planszy porzadkowanie
+ * przechodzi po wszystkich polach, wiec limit zalezy od ich liczby; w
+ * rzadkiej reprezentacji przechodzi tylko po zajetych polach, wiec limit
+ * rosnie razem z ich liczba.
+ * 
+ * @param[in] g : wskaznik na strukture przechowujaca stan gry
+ * 
+ * @return Limit liczby wezlow.
+ */
+static uint64_t get_area_node_limit(gamma_t *g) {
+	if (g->sparse) {
+		return 2 * g->taken_fields_total + 32;
+	}
+
+	return 2 * g->area.length + 32;
+}
+
+
+/**
+ * @brief Zapewnia miejsce na [count] nowych wezlow lasu obszarow.
+ * Gdy liczba wezlow przekroczylaby @ref get_area_node_limit, porzadkuje las
+ * w @ref compact_area_nodes, w przeciwnym wypadku w razie potrzeby
+ * powieksza tablice wezlow.
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] count     : liczba wezlow, ktore beda potrzebne
+ * 
+ * @return true, gdy udalo sie zapewnic miejsce, false w przeciwnym wypadku.
+ */
+static bool reserve_area_nodes(gamma_t *g, uint64_t count) {
+	if (g->area_node_count + count > get_area_node_limit(g)) {
+		if (!compact_area_nodes(g)) {
+			return false;
+		}
+	}
+
+	uint64_t required = g->area_node_count + count + 1;
+	if (required > g->area_parent.length) {
+		uint64_t length = 2 * g->area_parent.length;
+		if (length < required) {
+			length = required;
+		}
+		return resize_cell_array(&g->area_parent, length);
+	}
+
+	return true;
+}
+
+
+/**
+ * @brief Tworzy nowy, pusty obszar.
+ * Miejsce na wezel musi zostac wczesniej zapewnione przez
+ * @ref reserve_area_nodes.
+ * 
+ * @param[in,out] g : wskaznik na strukture przechowujaca stan gry
+ * 
+ * @return Numer korzenia nowego obszaru.
+ */
+static uint64_t new_area_node(gamma_t *g) {
+	change_counter(g, &g->area_node_count, 1);
+	uint64_t node = g->area_node_count;
+	set_area_size(g, node, 0);
+
+	return node;
+}
+
+
+/**
+ * @brief Dolicza (gdy [sign] jest rowne 1) lub odlicza (gdy [sign] jest rowne
+ * -1) wolne pole o indeksie [index] do pol dostepnych gracza o numerze
+ * [player].
+ * Zbior @ref player_page_t.available_fields zmienia tylko wtedy, gdy jest
+ * utrzymywany.
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] player    : numer gracza
+ * @param[in] index     : indeks pola z @ref get_field_index
+ * @param[in] sign      : 1, gdy pole zaczyna sasiadowac z polami gracza, -1,
+ *                        gdy przestaje sasiadowac lub zostaje zajete
+ */
+static void update_available_field(
+	gamma_t *g,
+	uint32_t player,
+	uint64_t index,
+	int sign
+) {
+	player_page_t *page = get_writable_player_page(g, player);
+	uint32_t slot = get_player_slot(player);
+	change_counter(g, &page->available_fields_adjacent[slot], sign);
+	if (!(page->tracks_available_fields >> slot & 1)) {
+		return;
+	}
+
+	cell_set_t *fields = &page->available_fields[slot];
+	if (sign > 0) {
+		if (cell_set_insert(fields, index)) {
+			record_change(g, JOURNAL_FIELD_INSERT, player - 1, index);
+		}
+	}
+	else if (cell_set_erase(fields, index)) {
+		record_change(g, JOURNAL_FIELD_ERASE, player - 1, index);
+	}
+}
+
+
+/**
+ * @brief Wylacza utrzymywanie zbioru pol dostepnych gracza o numerze
+ * [player] i zwalnia go.
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] player    : numer gracza
+ */
+static void untrack_available_fields(gamma_t *g, uint32_t player) {
+	player_page_t *page = get_writable_player_page(g, player);
+	uint32_t slot = get_player_slot(player);
+	page->tracks_available_fields &= ~((uint64_t)1 << slot);
+	cell_set_free(&page->available_fields[slot]);
+}
+
+
+/**
+ * @brief Dolicza (gdy [sign] jest rowne 1) lub odlicza (gdy [sign] jest rowne
+ * -1) zajete pole o wspolrzednych [x], [y] do zlotych celow graczy, ktorych
+ * pola z nim sasiaduja.
+ * Pole jest bezpiecznym celem, gdy jego wlasciciel ma co najwyzej jedno
+ * sasiednie pole - zabranie go nie moze wtedy rozciac obszaru. Pozostale pola
+ * trafiaja do zbioru @ref player_page_t.golden_targets. Dla wolnego pola nic
+ * nie robi.
+ * 
+ * @param[in,out] g : wskaznik na strukture przechowujaca stan gry
+ * @param[in] x     : wspolrzedna osi X pola
+ * @param[in] y     : wspolrzedna osi Y pola
+ * @param[in] sign  : 1 lub -1
+ */
+static void update_golden_target(gamma_t *g, uint32_t x, uint32_t y, int sign) {
+	uint32_t owner = get_field_owner(g, x, y);
+	if (!owner) {
+		return;
+	}
+
+	uint64_t index = get_field_index(g, x, y);
+	bool safe = get_neighbour_count(g, owner, x, y) <= 1;
+	uint32_t neighbours[4];
+	int neighbour_count = get_neighbour_owners(g, x, y, neighbours);
+
+	for (int i = 0; i < neighbour_count; i++) {
+		if (neighbours[i] == owner) {
+			continue;
+		}
+
+		player_page_t *page = get_writable_player_page(g, neighbours[i]);
+		uint32_t slot = get_player_slot(neighbours[i]);
+		cell_set_t *targets = &page->golden_targets[slot];
+		if (safe) {
+			change_counter(g, &page->safe_golden_targets[slot], sign);
+		}
+		else if (sign > 0) {
+			if (cell_set_insert(targets, index)) {
+				record_change(
+					g,
+					JOURNAL_TARGET_INSERT,
+					neighbours[i] - 1,
+					index
+				);
+			}
+		}
+		else if (cell_set_erase(targets, index)) {
+			record_change(g, JOURNAL_TARGET_ERASE, neighbours[i] - 1, index);
+		}
+	}
+}
+
+
+/**
+ * @brief Wywoluje @ref update_golden_target dla pola o wspolrzednych [x], [y]
+ * oraz jego sasiadow, czyli wszystkich pol, ktorych zlote cele zaleza od
+ * wlasciciela pola [x], [y].
+ * 
+ * @param[in,out] g : wskaznik na strukture przechowujaca stan gry
+ * @param[in] x     : wspolrzedna osi X pola
+ * @param[in] y     : wspolrzedna osi Y pola
+ * @param[in] sign  : 1 lub -1
+ */
+static void update_golden_targets_around(
+	gamma_t *g,
+	uint32_t x,
+	uint32_t y,
+	int sign
+) {
+	update_golden_target(g, x, y, sign);
+	for (int i = 0; i < 4; i++) {
+		if (check_field_exists(g, x, y, i)) {
+			update_golden_target(g, x + offset_x[i], y + offset_y[i], sign);
+		}
+	}
+}
+
+
+/**
+ * @brief Zapewnia, ze zmiana danych gracza [player] przez ruch nie bedzie
+ * wymagala alokowania pamieci.
+ * Strona danych gracza musi nalezec tylko do gry [g], a w jego zbiorach
+ * zlotych celow i pol dostepnych musi byc miejsce na @ref MOVE_SET_INSERTS
+ * nowych elementow. Gdy dziennik jest wylaczony, najpierw zmniejsza zbiory,
+ * ktore zbytnio sie skurczyly; przy wlaczonym dzienniku zbiory tylko rosna,
+ * wiec cofanie zmian tez nie alokuje pamieci.
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] player    : numer gracza
+ * 
+ * @return true, gdy udalo sie zaalokowac pamiec, false w przeciwnym wypadku.
+ */
+static bool prepare_player(gamma_t *g, uint32_t player) {
+	player_page_t *page = get_writable_player_page(g, player);
+	if (!page) {
+		return false;
+	}
+
+	uint32_t slot = get_player_slot(player);
+	cell_set_t *targets = &page->golden_targets[slot];
+	cell_set_t *fields = &page->available_fields[slot];
+	bool tracked = page->tracks_available_fields >> slot & 1;
+	if (!g->journal.active) {
+		cell_set_shrink(targets, MOVE_SET_INSERTS);
+		if (tracked) {
+			cell_set_shrink(fields, MOVE_SET_INSERTS);
+		}
+	}
+
+	return cell_set_reserve(targets, MOVE_SET_INSERTS) &&
+		(!tracked || cell_set_reserve(fields, MOVE_SET_INSERTS));
+}
+
+
+/**
+ * @brief Przygotowuje w @ref prepare_player dane gracza [player] oraz
+ * wlascicieli pol odleglych od pola o wspolrzednych [x], [y] o co najwyzej 2.
+ * Ruch na to pole lub zabranie go zmienia dane tylko tych graczy (patrz
+ * @ref update_golden_targets_around).
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] player    : numer gracza wykonujacego ruch
+ * @param[in] x         : wspolrzedna osi X pola
+ * @param[in] y         : wspolrzedna osi Y pola
+ * 
+ * @return true, gdy udalo sie zaalokowac pamiec, false w przeciwnym wypadku.
+ */
+static bool prepare_players(
+	gamma_t *g,
+	uint32_t player,
+	uint32_t x,
+	uint32_t y
+) {
+	// the neighbourhood holds 13 fields, so at most 14 players with the mover
+	uint32_t prepared[14];
+	int prepared_count = 1;
+	prepared[0] = player;
+	if (!prepare_player(g, player)) {
+		return false;
+	}
+
+	for (int64_t dy = -2; dy <= 2; dy++) {
+		int64_t reach = dy < 0 ? 2 + dy : 2 - dy;
+		for (int64_t dx = -reach; dx <= reach; dx++) {
+			int64_t new_x = (int64_t)x + dx;
+			int64_t new_y = (int64_t)y + dy;
+			if (
+				new_x < 0 || new_x >= g->field_width ||
+				new_y < 0 || new_y >= g->field_height
+			) {
+				continue;
+			}
+
+			uint32_t owner = get_field_owner(g, new_x, new_y);
+			bool repeated = owner == 0;
+			for (int i = 0; i < prepared_count && !repeated; i++) {
+				repeated = prepared[i] == owner;
+			}
+			if (!repeated) {
+				if (!prepare_player(g, owner)) {
+					return false;
+				}
+				prepared[prepared_count++] = owner;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+/**
+ * @brief Zapewnia, ze ruch gracza [player] na pole o wspolrzednych [x], [y]
+ * nie bedzie wymagal alokowania pamieci na dane planszy.
+ * Kopiuje kafelki wspoldzielone z inna gra, do ktorych ruch zapisze:
+ * kafelki pola, korzeni obszarow gracza wokol pola oraz [nodes] nowych
+ * wezlow lasu obszarow. W rzadkiej reprezentacji zapewnia miejsce na wpis
+ * pola, a gdy dziennik jest wylaczony, najpierw zmniejsza slownik, ktory
+ * zbytnio sie skurczyl. Miejsce na wezly musi zostac wczesniej zapewnione
+ * przez @ref reserve_area_nodes.
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] player    : numer gracza wykonujacego ruch
+ * @param[in] x         : wspolrzedna osi X pola
+ * @param[in] y         : wspolrzedna osi Y pola
+ * @param[in] nodes     : liczba nowych wezlow, ktore moga zostac utworzone
+ * 
+ * @return true, gdy udalo sie zaalokowac pamiec, false w przeciwnym wypadku.
+ */
+static bool prepare_field_cells(
+	gamma_t *g,
+	uint32_t player,
+	uint32_t x,
+	uint32_t y,
+	uint64_t nodes
+) {
+	uint64_t index = get_field_index(g, x, y);
+	if (g->sparse) {
+		if (!g->journal.active) {
+			field_map_shrink(&g->fields, 1);
+		}
+		if (!field_map_reserve(&g->fields, 1)) {
+			return false;
+		}
+	}
+	else if (
+		!prepare_cell(&g->field, index) ||
+		!prepare_cell(&g->area, index)
+	) {
+		return false;
+	}
+
+	for (uint64_t i = 1; i <= nodes; i++) {
+		if (!prepare_cell(&g->area_parent, g->area_node_count + i)) {
+			return false;
+		}
+	}
+
+	for (int i = 0; i < 4; i++) {
+		uint32_t new_x = x + offset_x[i];
+		uint32_t new_y = y + offset_y[i];
+		if (
+			check_field_exists(g, x, y, i) &&
+			get_field_owner(g, new_x, new_y) == player
+		) {
+			uint64_t node = get_field_node(g, get_field_index(g, new_x, new_y));
+			if (!prepare_cell(&g->area_parent, find_leader(g, node))) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+/** @brief Tworzy strukturę przechowującą stan gry.
+ * Alokuje pamięć na nową strukturę przechowującą stan gry.
+ * Inicjuje tę strukturę tak, aby reprezentowała początkowy stan gry.
+ * 
+ * @param[in] width   : szerokość planszy, liczba dodatnia,
+ * @param[in] height  : wysokość planszy, liczba dodatnia,
+ * @param[in] players : liczba graczy, liczba dodatnia,
+ * @param[in] areas   : maksymalna liczba obszarów,
+ *                      jakie może zająć jeden gracz.
+ * 
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się
+ * zaalokować pamięci lub któryś z parametrów jest niepoprawny.
+ */
+gamma_t* gamma_new(
+	uint32_t width,
+	uint32_t height,
+	uint32_t players,
+	uint32_t areas
+) {
+	gamma_options_t options;
+	gamma_options_init(&options);
+
+	return gamma_new_ex(width, height, players, areas, &options);
+}
+
+
+/** @brief Ustawia domyslne ustawienia gry.
+ * Zapisuje w @p options ustawienia, ktorych uzywa @ref gamma_new.
+ * 
+ * @param[out] options  : ustawienia, ktore wypelniamy.
+ */
+void gamma_options_init(gamma_options_t *options) {
+	options->sparse_threshold = DEFAULT_SPARSE_THRESHOLD;
+	options->layout = GAMMA_LAYOUT_ROWS;
+	options->search_nodes = DEFAULT_SEARCH_NODES;
+	options->symmetric_hash = false;
+	options->board_cache_threshold = DEFAULT_BOARD_CACHE_THRESHOLD;
+}
+
+
+/** @brief Tworzy strukture przechowujaca stan gry z podanymi ustawieniami.
+ * Dziala jak @ref gamma_new, ale uzywa ustawien @p options. Gdy tablice
+ * planszy zajmowalyby wiecej niz @ref gamma_options_t.sparse_threshold
+ * bajtow, dane pol trzymane sa tylko dla pol zajetych.
+ * 
+ * @param[in] width   : szerokość planszy, liczba dodatnia,
+ * @param[in] height  : wysokość planszy, liczba dodatnia,
+ * @param[in] players : liczba graczy, liczba dodatnia,
+ * @param[in] areas   : maksymalna liczba obszarów,
+ *                      jakie może zająć jeden gracz,
+ * @param[in] options : ustawienia gry.
+ * 
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się
+ * zaalokować pamięci lub któryś z parametrów jest niepoprawny.
+ */
+gamma_t* gamma_new_ex(
+	uint32_t width,
+	uint32_t height,
+	uint32_t players,
+	uint32_t areas,
+	const gamma_options_t *options
+) {
+	if (
+		width == 0 || height == 0 || players == 0 || areas == 0 || !options
+	) {
+		return NULL;
+	}
+
+	gamma_t *g = malloc(sizeof(gamma_t));
+	if (!g) {
+		return NULL;
+	}
+
+	g->field_width = width;
+	g->field_height = height;
+	g->player_count = players;
+	g->max_player_areas = areas;
+
+	uint64_t cell_count = (uint64_t)width * height;
+	uint8_t owner_size = get_cell_width(players);
+
+	// the blocked layout pads the board to whole blocks
+	g->layout = options->layout;
+	g->block_columns = ((uint64_t)width + BLOCK_MASK) >> BLOCK_SHIFT;
+	if (g->layout == GAMMA_LAYOUT_BLOCKED) {
+		uint64_t block_rows = ((uint64_t)height + BLOCK_MASK) >> BLOCK_SHIFT;
+		cell_count = (g->block_columns * block_rows) << (2 * BLOCK_SHIFT);
+	}
+
+	// the node numbers (bounded by @ref get_area_node_limit) and the root
+	// flag together with the area size must fit in one cell
+	uint8_t node_size = get_cell_width(4 * cell_count + 64);
+	uint64_t cell_bytes = owner_size + node_size;
+	g->sparse = cell_count > options->sparse_threshold / cell_bytes;
+	if (g->sparse) {
+		node_size = sizeof(uint64_t);
+		cell_count = 0;
+		g->layout = GAMMA_LAYOUT_ROWS;
+	}
+	field_map_init(&g->fields);
+	field_map_init(&g->area_marks);
+
+	if (!allocate_cell_array(&g->field, cell_count, owner_size)) {
+		free(g);
+		return NULL;
+	}
+
+	g->area_node_count = 0;
+	g->taken_fields_total = 0;
+	g->journal.entries = NULL;
+	g->journal.size = 0;
+	g->journal.capacity = 0;
+	g->journal.active = false;
+	g->search_nodes = options->search_nodes;
+	g->search = NULL;
+	g->hash = 0;
+	g->bracket_space = 0;
+	g->board_cache.enabled = ((uint64_t)width + 1) * height <=
+		options->board_cache_threshold;
+	g->board_cache.rows = NULL;
+	g->owner_changes = 0;
+	g->golden_cache.owner_changes = 0;
+	cell_set_init(&g->golden_cache.possible);
+	cell_set_init(&g->golden_cache.impossible);
+	g->symmetry_count = 0;
+	if (options->symmetric_hash) {
+		g->symmetry_count = width == height ? MAX_SYMMETRIES : 3;
+	}
+	for (int i = 0; i < MAX_SYMMETRIES; i++) {
+		g->symmetry_hashes[i] = 0;
+	}
+	for (int i = 0; i < 4; i++) {
+		g->area_search[i].items = NULL;
+		g->area_search[i].head = 0;
+		g->area_search[i].size = 0;
+		g->area_search[i].capacity = 0;
+	}
+
+	if (!allocate_cell_array(&g->area, cell_count, node_size)) {
+		free_cell_array(&g->field);
+		free(g);
+		return NULL;
+	}
+
+	if (!allocate_cell_array(&g->area_parent, 64, node_size)) {
+		free_cell_array(&g->field);
+		free_cell_array(&g->area);
+		free(g);
+		return NULL;
+	}
+
+	if (!player_table_init(&g->players, players)) {
+		free_cell_array(&g->field);
+		free_cell_array(&g->area);
+		free_cell_array(&g->area_parent);
+		free(g);
+		return NULL;
+	}
+
+	return g;
+}
+
+
+/** @brief Tworzy kopie stanu gry.
+ * Kopia wspoldzieli z @p g kafelki tablic planszy (patrz
+ * @ref share_cell_array) i strony danych graczy, ktore sa kopiowane przy
+ * pierwszym zapisie. Gdy dziennik @p g nie jest pusty, jego wpisy wskazuja
+ * na liczniki graczy, wiec strony danych graczy sa wtedy kopiowane od razu,
+ * by cofanie zmian w @p g nie musialo ich ponownie kopiowac.
+ * 
+ * @param[in] g : wskaznik na strukture przechowujaca stan gry.
+ * 
+ * @return Wskaznik na utworzona strukture lub NULL, gdy nie udalo sie
+ * zaalokowac pamieci lub @p g ma wartosc NULL.
+ */
+gamma_t* gamma_clone(const gamma_t *g) {
+	if (!g) {
+		return NULL;
+	}
+
+	gamma_t *clone = malloc(sizeof(gamma_t));
+	if (!clone) {
+		return NULL;
+	}
+
+	clone->field_height = g->field_height;
+	clone->field_width = g->field_width;
+	clone->player_count = g->player_count;
+	clone->max_player_areas = g->max_player_areas;
+	clone->sparse = g->sparse;
+	clone->layout = g->layout;
+	clone->block_columns = g->block_columns;
+	clone->area_node_count = g->area_node_count;
+	clone->taken_fields_total = g->taken_fields_total;
+	clone->journal.entries = NULL;
+	clone->journal.size = 0;
+	clone->journal.capacity = 0;
+	clone->journal.active = false;
+	clone->search_nodes = g->search_nodes;
+	clone->search = NULL;
+	clone->hash = g->hash;
+	clone->bracket_space = g->bracket_space;
+	clone->board_cache.enabled = g->board_cache.enabled;
+	clone->board_cache.rows = NULL;
+	clone->owner_changes = 0;
+	clone->golden_cache.owner_changes = 0;
+	cell_set_init(&clone->golden_cache.possible);
+	cell_set_init(&clone->golden_cache.impossible);
+	clone->symmetry_count = g->symmetry_count;
+	for (int i = 0; i < MAX_SYMMETRIES; i++) {
+		clone->symmetry_hashes[i] = g->symmetry_hashes[i];
+	}
+	field_map_init(&clone->area_marks);
+	for (int i = 0; i < 4; i++) {
+		clone->area_search[i].items = NULL;
+		clone->area_search[i].head = 0;
+		clone->area_search[i].size = 0;
+		clone->area_search[i].capacity = 0;
+	}
+
+	if (!share_cell_array(&clone->field, &g->field)) {
+		free(clone);
+		return NULL;
+	}
+	if (!share_cell_array(&clone->area, &g->area)) {
+		free_cell_array(&clone->field);
+		free(clone);
+		return NULL;
+	}
+	if (!share_cell_array(&clone->area_parent, &g->area_parent)) {
+		free_cell_array(&clone->field);
+		free_cell_array(&clone->area);
+		free(clone);
+		return NULL;
+	}
+	if (!share_player_table(&clone->players, &g->players)) {
+		free_cell_array(&clone->field);
+		free_cell_array(&clone->area);
+		free_cell_array(&clone->area_parent);
+		free(clone);
+		return NULL;
+	}
+	if (!field_map_copy(&clone->fields, &g->fields)) {
+		gamma_delete(clone);
+		return NULL;
+	}
+
+	for (uint64_t i = 0; g->journal.size && i < g->players.leaf_count; i++) {
+		player_page_t **leaf = clone->players.leaves[i];
+		uint64_t length = leaf ? get_leaf_length(&clone->players, i) : 0;
+		for (uint64_t j = 0; j < length; j++) {
+			if (
+				leaf[j] &&
+				!make_page_writable(&clone->players, i << PLAYER_LEAF_SHIFT | j)
+			) {
+				gamma_delete(clone);
+				return NULL;
+			}
+		}
+	}
+
+	return clone;
+}
+
+
+/** @brief Usuwa strukturę przechowującą stan gry.
+ * Usuwa z pamięci strukturę wskazywaną przez @p g.
+ * Nic nie robi, jeśli wskaźnik ten ma wartość NULL.
+ * 
+ * @param[in,out] g : wskaźnik na usuwaną strukturę.
+ */
+void gamma_delete(gamma_t *g) {
+	if (!g) {
+		return;
+	}
+	
+	free_cell_array(&g->field);
+	free_cell_array(&g->area);
+	field_map_free(&g->fields);
+	free_cell_array(&g->area_parent);
+	free(g->journal.entries);
+	for (int i = 0; i < 4; i++) {
+		free(g->area_search[i].items);
+	}
+	field_map_free(&g->area_marks);
+	search_delete(g->search);
+
+	free_player_table(&g->players);
+	free_board_cache(&g->board_cache, g->field_height);
+	cell_set_free(&g->golden_cache.possible);
+	cell_set_free(&g->golden_cache.impossible);
+
+	free(g);
+}
+
+
+/**
+ * @brief Stawia pionek gracza o numerze [player] na wolnym polu o
+ * wspolrzednych [x], [y].
+ * Laczy obszary gracza, ktore z nim sasiaduja, oraz aktualizuje pola
+ * dostepne i zlote cele graczy. Nie sprawdza, czy ruch jest legalny, i nie
+ * alokuje pamieci: musi ja wczesniej zapewnic @ref reserve_area_nodes (jeden
+ * wezel), @ref reserve_journal, @ref prepare_players oraz
+ * @ref prepare_field_cells.
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] player    : numer gracza wykonujacego ruch
+ * @param[in] x         : wspolrzedna osi X pola
+ * @param[in] y         : wspolrzedna osi Y pola
+ */
+static void occupy_field(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
+	// == sets [field]'s owner ==
+	update_golden_targets_around(g, x, y, -1);
+	set_field_owner(g, x, y, player);
+	change_taken_fields(g, player, 1);
+	change_counter(g, &g->taken_fields_total, 1);
+
+	// == connects adjacent fields of the player into one area ==
+	uint64_t root = 0;
+	for (int i = 0; i < 4; i++) {
+		uint32_t new_x = x + offset_x[i];
+		uint32_t new_y = y + offset_y[i];
+		if (
+			check_field_exists(g, x, y, i) &&
+			get_field_owner(g, new_x, new_y) == player
+		) {
+			uint64_t index = get_field_index(g, new_x, new_y);
+			uint64_t leader = find_leader(g, get_field_node(g, index));
+			if (!root) {
+				root = leader;
+			}
+			else if (leader != root) {
+				root = union_areas(g, root, leader);
+				change_occupied_areas(g, player, -1);
+			}
+		}
+	}
+
+	if (!root) {
+		root = new_area_node(g);
+		change_occupied_areas(g, player, 1);
+	}
+	set_field_node(g, get_field_index(g, x, y), root);
+	set_area_size(g, root, get_area_size(g, root) + 1);
+
+	// == manage available fields of the neighbouring players ==
+	// managing the field that has been taken
+	uint64_t index = get_field_index(g, x, y);
+	uint32_t neighbours[4];
+	int neighbour_count = get_neighbour_owners(g, x, y, neighbours);
+	for (int i = 0; i < neighbour_count; i++) {
+		update_available_field(g, neighbours[i], index, -1);
+	}
+
+	// managing adjacent fields
+	for (int i = 0; i < 4; i++) {
+		uint32_t new_x = x + offset_x[i];
+		uint32_t new_y = y + offset_y[i];
+		if (
+			check_field_exists(g, x, y, i) &&
+			get_field_owner(g, new_x, new_y) == 0 &&
+			get_neighbour_count(g, player, new_x, new_y) == 1
+		) {
+			update_available_field(
+				g,
+				player,
+				get_field_index(g, new_x, new_y),
+				1
+			);
+		}
+	}
+
+	update_golden_targets_around(g, x, y, 1);
+}
+
+
+/** @brief Wykonuje ruch.
+ * Ustawia pionek gracza @p player na polu (@p x, @p y).
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
+ *                      @p players z funkcji @ref gamma_new,
+ * @param[in] x       – numer kolumny, liczba nieujemna mniejsza od wartości
+ *                      @p width z funkcji @ref gamma_new,
+ * @param[in] y       – numer wiersza, liczba nieujemna mniejsza od wartości
+ *                      @p height z funkcji @ref gamma_new.
+ * @return Wartość @p true, jeśli ruch został wykonany, a @p false,
+ * gdy ruch jest nielegalny, któryś z parametrów jest niepoprawny lub nie
+ * udało się zaalokować pamięci (wtedy stan gry się nie zmienia).
+ */
+bool gamma_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
+	if (
+		!g ||
+		!check_player_correct(g, player) ||
+		!check_field_correct(g, x, y) ||
+		get_field_owner(g, x, y) != 0 || (
+			get_neighbour_count(g, player, x, y) == 0 &&
+			get_occupied_areas(g, player) == g->max_player_areas
+		)
+	) {
+		return false;
+	}
+
+	if (
+		!reserve_area_nodes(g, 1) ||
+		!reserve_journal(g, MOVE_JOURNAL_ENTRIES) ||
+		!prepare_players(g, player, x, y) ||
+		!prepare_field_cells(g, player, x, y, 1)
+	) {
+		return false;
+	}
+
+	occupy_field(g, player, x, y);
+
+	return true;
+}
+
+
+/**
+ * @brief Wklada pole o wspolrzednych [x], [y] na koniec kolejki [queue].
+ * 
+ * @param[in,out] queue : kolejka, do ktorej wkladamy pole
+ * @param[in] x         : wspolrzedna osi X pola
+ * @param[in] y         : wspolrzedna osi Y pola
+ * 
+ * @return true, gdy pole zostalo wlozone, false gdy nie udalo sie zaalokowac
+ * pamieci; kolejka pozostaje wtedy bez zmian.
+ */
+static bool push_position(position_queue_t *queue, uint32_t x, uint32_t y) {
+	if (queue->size == queue->capacity) {
+		uint64_t capacity = queue->capacity ? 2 * queue->capacity : 64;
+		field_position_t *items =
+			realloc(queue->items, capacity * sizeof(field_position_t));
+		if (!items) {
+			return false;
+		}
+		queue->items = items;
+		queue->capacity = capacity;
+	}
+
+	queue->items[queue->size].x = x;
+	queue->items[queue->size].y = y;
+	queue->size++;
+
+	return true;
+}
+
+
+/**
+ * @brief Sprawdza, czy kolejka [queue] zawiera jakies pole.
+ * 
+ * @param[in] queue : kolejka, ktora sprawdzamy
+ * 
+ * @return true, gdy kolejka nie jest pusta, false w przeciwnym wypadku.
+ */
+static bool has_positions(const position_queue_t *queue) {
+	return queue->head < queue->size;
+}
+
+
+/**
+ * @brief Zwraca reprezentanta grupy przeszukiwan [search] w
+ * @ref search_area_split.
+ * 
+ * @param[in] group     : tablica rodzicow grup przeszukiwan
+ * @param[in] search    : numer przeszukiwania
+ * 
+ * @return Numer przeszukiwania reprezentujacego grupe.
+ */
+static int find_search_group(const int *group, int search) {
+	while (group[search] != search) {
+		search = group[search];
+	}
+
+	return search;
+}
+
+
+/**
+ * @brief Wynik przeszukiwania obszaru w @ref search_area_split. Pola
+ * odwiedzone przez kolejne przeszukiwania zostaja w kolejkach
+ * @ref gamma_t.area_search do wywolania @ref apply_area_split.
+ * 
+ * @param count     : liczba przeszukiwan, czyli pol gracza sasiadujacych z
+ *                    zabieranym polem
+ * @param group     : reprezentant grupy kazdego przeszukiwania
+ * @param size      : liczba pol grupy (dla reprezentantow grup)
+ * @param kept      : reprezentant grupy, ktora pozostaje przy starym
+ *                    korzeniu obszaru
+ * @param parts     : liczba obszarow, na ktore rozpada sie obszar
+ * @param moved     : liczba pol przepinanych na nowe wezly lasu obszarow
  */
-void clear_field(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
-	// == resets field owner ==
-	*get_arr_32(g->field, x, y) = 0;
-	g->players[player - 1]->taken_fields--;
-	g->players[player - 1]->occupied_areas--;
+typedef struct area_split {
+	int count;
+	int group[4];
+	uint64_t size[4];
+	int kept;
+	uint64_t parts;
+	uint64_t moved;
+} area_split_t;
 
-	// == manage available_fields due to removing a players field ==
-	// managing the field that has been cleared
-	for (uint32_t i = 1; i <= g->player_count; i++) {
-		if (get_neighbour_count(g, i, x, y) > 0) {
-			g->players[i - 1]->available_fields_adjacent++;
-		}
-		else {
-			g->players[i - 1]->available_fields_far++;
-		}
+
+/**
+ * @brief Oznacza pole o indeksie [index] jako odwiedzone przez
+ * przeszukiwanie [search] i wklada je do kolejki tego przeszukiwania.
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] search    : numer przeszukiwania
+ * @param[in] index     : indeks pola z @ref get_field_index
+ * @param[in] x         : wspolrzedna osi X pola
+ * @param[in] y         : wspolrzedna osi Y pola
+ * 
+ * @return true, gdy udalo sie zaalokowac pamiec, false w przeciwnym wypadku.
+ */
+static bool visit_split_field(
+	gamma_t *g,
+	int search,
+	uint64_t index,
+	uint32_t x,
+	uint32_t y
+) {
+	if (
+		!field_map_reserve(&g->area_marks, 1) ||
+		!push_position(&g->area_search[search], x, y)
+	) {
+		return false;
 	}
 
-	// managing adjacent fields
+	field_map_get(&g->area_marks, index)->node = search + 1;
+
+	return true;
+}
+
+
+/**
+ * @brief Sprawdza, na ile czesci rozpadlby sie obszar gracza [player] po
+ * zabraniu mu pola o wspolrzednych [x], [y], nie zmieniajac stanu gry.
+ * Z kazdego sasiada zabieranego pola nalezacego do gracza rusza
+ * przeszukiwanie wszerz, ktore oznacza odwiedzane pola w slowniku
+ * @ref gamma_t.area_marks. Przeszukiwania wykonuja po jednym kroku na
+ * zmiane; gdy dwa sie spotkaja, naleza do tej samej czesci obszaru. Praca
+ * konczy sie, gdy co najwyzej jedna czesc nie zostala jeszcze w calosci
+ * odwiedzona - ta czesc pozostanie przy starym korzeniu. Gdy wszystkie czesci
+ * zostaly odwiedzone, przy korzeniu pozostaje najwieksza z nich. Czas dzialania
+ * jest wiec proporcjonalny do rozmiaru mniejszych czesci, a funkcja nie
+ * uzywa rekurencji.
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] player    : numer gracza zajmujacego pole
+ * @param[in] x         : wspolrzedna osi X zabieranego pola
+ * @param[in] y         : wspolrzedna osi Y zabieranego pola
+ * @param[out] split    : wynik przeszukiwania
+ * 
+ * @return true, gdy udalo sie zaalokowac pamiec, false w przeciwnym wypadku.
+ */
+static bool search_area_split(
+	gamma_t *g,
+	uint32_t player,
+	uint32_t x,
+	uint32_t y,
+	area_split_t *split
+) {
+	field_position_t start[4];
+	int count = 0;
 	for (int i = 0; i < 4; i++) {
 		uint32_t new_x = x + offset_x[i];
 		uint32_t new_y = y + offset_y[i];
 		if (
 			check_field_exists(g, x, y, i) &&
-			*get_arr_32(g->field, new_x, new_y) == 0 &&
-			get_neighbour_count(g, player, new_x, new_y) == 0
+			get_field_owner(g, new_x, new_y) == player
+		) {
+			start[count].x = new_x;
+			start[count].y = new_y;
+			split->group[count] = count;
+			split->size[count] = 1;
+			count++;
+		}
+	}
+
+	split->count = count;
+	split->kept = 0;
+	split->parts = count;
+	split->moved = 0;
+	if (count < 2) {
+		return true;
+	}
+
+	uint64_t removed = get_field_index(g, x, y);
+	bool success = true;
+	for (int s = 0; s < count; s++) {
+		g->area_search[s].head = 0;
+		g->area_search[s].size = 0;
+		success = success && visit_split_field(g, s,
+			get_field_index(g, start[s].x, start[s].y), start[s].x, start[s].y);
+	}
+
+	// a group is open while any of its searches has fields to visit
+	bool open[4];
+	int open_groups = count;
+	while (success && open_groups > 1) {
+		for (int s = 0; success && s < count; s++) {
+			position_queue_t *queue = &g->area_search[s];
+			if (!has_positions(queue)) {
+				continue;
+			}
+
+			field_position_t current = queue->items[queue->head++];
+			for (int i = 0; success && i < 4; i++) {
+				uint32_t new_x = current.x + offset_x[i];
+				uint32_t new_y = current.y + offset_y[i];
+				if (
+					!check_field_exists(g, current.x, current.y, i) ||
+					get_field_owner(g, new_x, new_y) != player
+				) {
+					continue;
+				}
+
+				uint64_t index = get_field_index(g, new_x, new_y);
+				if (index == removed) {
+					continue;
+				}
+
+				field_entry_t *mark = field_map_find(&g->area_marks, index);
+				if (!mark) {
+					success = visit_split_field(g, s, index, new_x, new_y);
+					split->size[s]++;
+				}
+				else {
+					int group_s = find_search_group(split->group, s);
+					int group_t = find_search_group(split->group,
+						mark->node - 1);
+					if (group_s != group_t) {
+						split->group[group_t] = group_s;
+					}
+				}
+			}
+		}
+
+		open_groups = 0;
+		for (int s = 0; s < count; s++) {
+			open[s] = false;
+		}
+		for (int s = 0; s < count; s++) {
+			int group_s = find_search_group(split->group, s);
+			if (has_positions(&g->area_search[s]) && !open[group_s]) {
+				open[group_s] = true;
+				open_groups++;
+			}
+		}
+	}
+
+	// like the queues, the marks keep their capacity for the next search
+	for (int s = 0; s < count; s++) {
+		position_queue_t *queue = &g->area_search[s];
+		for (uint64_t i = 0; i < queue->size; i++) {
+			field_map_erase(&g->area_marks,
+				get_field_index(g, queue->items[i].x, queue->items[i].y));
+		}
+	}
+	if (!success) {
+		return false;
+	}
+
+	// sizes are summed in the representatives; the open group, or the
+	// largest one when all are closed, stays with the old root
+	split->parts = 0;
+	for (int s = 0; s < count; s++) {
+		split->group[s] = find_search_group(split->group, s);
+		if (split->group[s] != s) {
+			split->size[split->group[s]] += split->size[s];
+		}
+	}
+	for (int s = 0; s < count; s++) {
+		if (split->group[s] == s) {
+			split->parts++;
+			if (
+				open[s] || (
+					!open[split->kept] &&
+					split->size[s] > split->size[split->kept]
+				)
+			) {
+				split->kept = s;
+			}
+		}
+	}
+	for (int s = 0; s < count; s++) {
+		if (split->group[s] == s && s != split->kept) {
+			split->moved += split->size[s];
+		}
+	}
+
+	return true;
+}
+
+
+/**
+ * @brief Rozcina obszar o korzeniu [root] zgodnie z wynikiem [split]
+ * przeszukiwania @ref search_area_split.
+ * Kazda grupa poza @ref area_split_t.kept dostaje nowy wezel lasu obszarow,
+ * na ktory przepinane sa jej pola. Miejsce na 3 wezly musi zostac wczesniej
+ * zapewnione przez @ref reserve_area_nodes.
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] root      : korzen rozcinanego obszaru
+ * @param[in] split     : wynik przeszukiwania obszaru
+ */
+static void apply_area_split(
+	gamma_t *g,
+	uint64_t root,
+	const area_split_t *split
+) {
+	uint64_t node[4];
+	for (int s = 0; s < split->count; s++) {
+		if (split->group[s] == s && s != split->kept) {
+			node[s] = new_area_node(g);
+			set_area_size(g, node[s], split->size[s]);
+		}
+	}
+
+	for (int s = 0; s < split->count; s++) {
+		int group_s = split->group[s];
+		position_queue_t *queue = &g->area_search[s];
+		for (uint64_t i = 0; group_s != split->kept && i < queue->size; i++) {
+			set_field_node(g,
+				get_field_index(g, queue->items[i].x, queue->items[i].y),
+				node[group_s]);
+		}
+	}
+
+	set_area_size(g, root, get_area_size(g, root) - 1 - split->moved);
+}
+
+
+/**
+ * @brief Zapewnia, ze zabranie pola o wspolrzednych [x], [y] nie bedzie
+ * wymagalo alokowania pamieci na dane planszy poza przygotowanymi w
+ * @ref prepare_field_cells.
+ * Kopiuje kafelki wspoldzielone z inna gra, do ktorych zapisze
+ * @ref clear_field: kafelek korzenia obszaru pola oraz kafelki pol
+ * przepinanych na nowe wezly zgodnie z wynikiem [split]. W rzadkiej
+ * reprezentacji przepinane pola maja juz wpisy w slowniku.
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] x         : wspolrzedna osi X zabieranego pola
+ * @param[in] y         : wspolrzedna osi Y zabieranego pola
+ * @param[in] split     : wynik przeszukiwania obszaru wlasciciela pola
+ * 
+ * @return true, gdy udalo sie zaalokowac pamiec, false w przeciwnym wypadku.
+ */
+static bool prepare_split_cells(
+	gamma_t *g,
+	uint32_t x,
+	uint32_t y,
+	const area_split_t *split
+) {
+	uint64_t node = get_field_node(g, get_field_index(g, x, y));
+	if (!prepare_cell(&g->area_parent, find_leader(g, node))) {
+		return false;
+	}
+	if (g->sparse) {
+		return true;
+	}
+
+	for (int s = 0; s < split->count; s++) {
+		position_queue_t *queue = &g->area_search[s];
+		for (
+			uint64_t i = 0;
+			split->group[s] != split->kept && i < queue->size;
+			i++
 		) {
-			g->players[player - 1]->available_fields_adjacent--;
-			g->players[player - 1]->available_fields_far++;
+			uint64_t index =
+				get_field_index(g, queue->items[i].x, queue->items[i].y);
+			if (!prepare_cell(&g->area, index)) {
+				return false;
+			}
 		}
 	}
 
-	// == fixes the leader of adjacent fields if they belong to [player] ==
-	uint64_t last_leader = 0;
+	return true;
+}
+
+
+/**
+ * @brief Zabiera pole o wspolrzednych [x], [y] od gracza o numerze [player].
+ * Ustawia pole [y][x] jako pole niczyje, nastepnie rozcina obszar gracza
+ * [player] zgodnie z wynikiem [split] przeszukiwania
+ * @ref search_area_split oraz aktualizuje pola dostepne wszystkich graczy.
+ * Nie alokuje pamieci: musi ja wczesniej zapewnic @ref reserve_area_nodes
+ * (trzy wezly), @ref reserve_journal, @ref prepare_players,
+ * @ref prepare_field_cells oraz @ref prepare_split_cells.
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] player    : numer gracza, od ktorego zabieramy pole
+ * @param[in] x         : wspolrzednia osi X pola, ktore zabieramy graczowi
+ * @param[in] y         : wspolrzednia osi Y pola, ktore zabieramy graczowi
+ * @param[in] split     : wynik przeszukiwania obszaru gracza [player]
+ */
+static void clear_field(
+	gamma_t *g,
+	uint32_t player,
+	uint32_t x,
+	uint32_t y,
+	const area_split_t *split
+) {
+	// == resets field owner ==
+	update_golden_targets_around(g, x, y, -1);
+	uint64_t index = get_field_index(g, x, y);
+	uint64_t root = find_leader(g, get_field_node(g, index));
+	set_field_node(g, index, 0);
+	set_owner_at(g, index, 0);
+	change_taken_fields(g, player, -1);
+	change_counter(g, &g->taken_fields_total, -1);
+	change_occupied_areas(g, player, (int64_t)split->parts - 1);
+
+	// == manage available fields of the neighbouring players ==
+	// managing the field that has been cleared
+	uint32_t neighbours[4];
+	int neighbour_count = get_neighbour_owners(g, x, y, neighbours);
+	for (int i = 0; i < neighbour_count; i++) {
+		update_available_field(g, neighbours[i], index, 1);
+	}
 
-	set_leader(g, player, 0, x, y);
+	// managing adjacent fields
 	for (int i = 0; i < 4; i++) {
 		uint32_t new_x = x + offset_x[i];
 		uint32_t new_y = y + offset_y[i];
 		if (
 			check_field_exists(g, x, y, i) &&
-			*get_arr_32(g->field, new_x, new_y) == player &&
-			find_leader(g, new_x, new_y) != last_leader
+			get_field_owner(g, new_x, new_y) == 0 &&
+			get_neighbour_count(g, player, new_x, new_y) == 0
 		) {
-			set_leader(
+			update_available_field(
 				g,
 				player,
-				get_array_index(new_x, new_y),
-				new_x,
-				new_y
+				get_field_index(g, new_x, new_y),
+				-1
 			);
-			last_leader = get_array_index(new_x, new_y);
-			g->players[player - 1]->occupied_areas++;
 		}
 	}
+
+	// == splits the area of [player] if the field was connecting it ==
+	if (split->count) {
+		apply_area_split(g, root, split);
+	}
+
+	update_golden_targets_around(g, x, y, 1);
+}
+
+
+/**
+ * @brief Sprawdza, czy pole o wspolrzednych [x], [y] mozna zabrac jego
+ * wlascicielowi tak, by nie przekroczyl on limitu obszarow.
+ * Najpierw szacuje liczbe czesci przez liczbe sasiednich pol wlasciciela, a
+ * gdy to nie wystarcza, liczy czesci w @ref search_area_split. Nie zmienia
+ * stanu gry.
+ * 
+ * @param[in,out] g         : wskaznik na strukture przechowujaca stan gry
+ * @param[in] x             : wspolrzedna osi X zajetego pola
+ * @param[in] y             : wspolrzedna osi Y zajetego pola
+ * @param[in,out] failed    : ustawiane na @p true, gdy nie udalo sie
+ *                            zaalokowac pamieci
+ * 
+ * @return true, gdy pole mozna zabrac, false gdy nie mozna lub nie udalo sie
+ * zaalokowac pamieci.
+ */
+static bool check_field_removable(
+	gamma_t *g,
+	uint32_t x,
+	uint32_t y,
+	bool *failed
+) {
+	uint32_t owner = get_field_owner(g, x, y);
+	uint64_t areas = get_occupied_areas(g, owner);
+	if (
+		areas - 1 + get_neighbour_count(g, owner, x, y) <=
+		g->max_player_areas
+	) {
+		return true;
+	}
+
+	area_split_t split;
+	if (!search_area_split(g, owner, x, y, &split)) {
+		*failed = true;
+		return false;
+	}
+
+	return areas - 1 + split.parts <= g->max_player_areas;
+}
+
+
+/** @brief Wykonuje zloty ruch.
+ * Ustawia pionek gracza @p player na polu (@p x, @p y) zajetym przez innego
+ * gracza, usuwajac pionek innego gracza. Przed zmiana planszy sprawdza, czy
+ * zaden z tych dwoch graczy nie bedzie mial po ruchu za duzo obszarow - liczba
+ * obszarow pozostalych graczy sie nie zmienia.
+ * 
+ * @param[in,out] g   : wskaznik na strukturę przechowujaca stan gry,
+ * @param[in] player  : numer gracza, liczba dodatnia niewieksza od wartosci
+ *                      @p players z funkcji @ref gamma_new,
+ * @param[in] x       : numer kolumny, liczba nieujemna mniejsza od wartosci
+ *                      @p width z funkcji @ref gamma_new,
+ * @param[in] y       : numer wiersza, liczba nieujemna mniejsza od wartosci
+ *                      @p height z funkcji @ref gamma_new.
+ * 
+ * @return Wartosć @p true, jesli ruch zostal wykonany, a @p false,
+ * gdy gracz wykorzystal już swoj zloty ruch, ruch jest nielegalny,
+ * ktorys z parametrow jest niepoprawny lub nie udalo sie zaalokowac pamieci
+ * (wtedy stan gry sie nie zmienia).
+ */
+bool gamma_golden_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
+	if (
+		!g ||
+		!check_player_correct(g, player) ||
+		get_golden_used(g, player) ||
+		!check_field_correct(g, x, y) ||
+		get_field_owner(g, x, y) == 0 ||
+		get_field_owner(g, x, y) == player || (
+			get_neighbour_count(g, player, x, y) == 0 &&
+			get_occupied_areas(g, player) == g->max_player_areas
+		)
+	) {
+		return false;
+	}
+
+	// the area is searched before any change, so a failed allocation leaves
+	// the game intact; clearing the field may use three nodes and the move
+	// one more
+	uint32_t owner = get_field_owner(g, x, y);
+	area_split_t split;
+	if (
+		!reserve_area_nodes(g, 4) ||
+		!search_area_split(g, owner, x, y, &split) ||
+		get_occupied_areas(g, owner) - 1 + split.parts > g->max_player_areas ||
+		!reserve_journal(g,
+			CLEAR_JOURNAL_ENTRIES + split.moved + MOVE_JOURNAL_ENTRIES + 1) ||
+		!prepare_players(g, player, x, y) ||
+		!prepare_field_cells(g, player, x, y, 4) ||
+		!prepare_split_cells(g, x, y, &split)
+	) {
+		return false;
+	}
+
+	clear_field(g, owner, x, y, &split);
+	occupy_field(g, player, x, y);
+	record_change(g, JOURNAL_GOLDEN_USED, player - 1, false);
+	store_golden_used(g, player, true);
+
+	return true;
+}
+
+
+/**
+ * @brief Pobiera z wyprzedzeniem do pamieci podrecznej dane pol, ktore
+ * odczyta ruch [move].
+ * Ruch czyta wlascicieli pol odleglych od swojego pola o co najwyzej 2 (przy
+ * aktualizacji pol dostepnych i zlotych celow) oraz wezly obszarow jego
+ * sasiadow, wiec pobiera wiersze od y - 2 do y + 2, a takze naglowki
+ * kafelkow, do ktorych zapisze. Pomija ruchy na niepoprawne pola oraz rzadka
+ * reprezentacje planszy.
+ * 
+ * @param[in] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] move  : ruch, ktorego pola pobieramy
+ */
+static void prefetch_move(gamma_t *g, const move_t *move) {
+	if (g->sparse || !check_field_correct(g, move->x, move->y)) {
+		return;
+	}
+
+	uint32_t first_y = move->y < 2 ? 0 : move->y - 2;
+	uint32_t last_y = move->y + 2;
+	if (last_y >= g->field_height || last_y < move->y) {
+		last_y = g->field_height - 1;
+	}
+
+	for (uint32_t y = first_y; y <= last_y; y++) {
+		uint64_t index = get_field_index(g, move->x, y);
+		prefetch_cell(&g->field, index);
+		if (y + 1 >= move->y && y <= move->y + 1) {
+			prefetch_cell(&g->area, index);
+		}
+	}
+
+	uint64_t index = get_field_index(g, move->x, move->y);
+	prefetch_tile(&g->field, index);
+	prefetch_tile(&g->area, index);
+}
+
+
+/**
+ * @brief Wykonuje ciag ruchow funkcja [move_function].
+ * Wspolna czesc @ref gamma_move_batch i @ref gamma_golden_move_batch.
+ * 
+ * @param[in,out] g         : wskaznik na strukture przechowujaca stan gry
+ * @param[in] moves         : tablica ruchow
+ * @param[in] n             : liczba ruchow
+ * @param[out] results      : tablica na [n] wynikow lub NULL
+ * @param[in] move_function : funkcja wykonujaca pojedynczy ruch
+ * 
+ * @return Liczba wykonanych ruchow.
+ */
+static size_t make_moves(
+	gamma_t *g,
+	const move_t *moves,
+	size_t n,
+	bool *results,
+	bool (*move_function)(gamma_t*, uint32_t, uint32_t, uint32_t)
+) {
+	size_t done = 0;
+
+	for (size_t i = 0; i < n; i++) {
+		bool result = false;
+		if (g) {
+			if (i + PREFETCH_DISTANCE < n) {
+				prefetch_move(g, &moves[i + PREFETCH_DISTANCE]);
+			}
+			result = move_function(g, moves[i].player, moves[i].x, moves[i].y);
+		}
+
+		done += result;
+		if (results) {
+			results[i] = result;
+		}
+	}
+
+	return done;
+}
+
+
+/** @brief Wykonuje ciag ruchow.
+ * Wykonuje po kolei ruchy @p moves tak, jak kolejne wywolania
+ * @ref gamma_move, pobierajac z wyprzedzeniem dane pol kolejnych ruchow.
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry,
+ * @param[in] moves     : tablica ruchow,
+ * @param[in] n         : liczba ruchow,
+ * @param[out] results  : tablica na @p n wynikow kolejnych ruchow lub NULL.
+ * 
+ * @return Liczba wykonanych ruchow.
+ */
+size_t gamma_move_batch(
+	gamma_t *g,
+	const move_t *moves,
+	size_t n,
+	bool *results
+) {
+	return make_moves(g, moves, n, results, gamma_move);
+}
+
+
+/** @brief Wykonuje ciag zlotych ruchow.
+ * Wykonuje po kolei zlote ruchy @p moves tak, jak kolejne wywolania
+ * @ref gamma_golden_move, pobierajac z wyprzedzeniem dane pol kolejnych
+ * ruchow.
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry,
+ * @param[in] moves     : tablica ruchow,
+ * @param[in] n         : liczba ruchow,
+ * @param[out] results  : tablica na @p n wynikow kolejnych ruchow lub NULL.
+ * 
+ * @return Liczba wykonanych ruchow.
+ */
+size_t gamma_golden_move_batch(
+	gamma_t *g,
+	const move_t *moves,
+	size_t n,
+	bool *results
+) {
+	return make_moves(g, moves, n, results, gamma_golden_move);
+}
+
+
+/** @brief Zaznacza stan gry, do ktorego mozna pozniej wrocic.
+ * Wlacza zapisywanie zmian stanu gry w dzienniku, jesli nie bylo wlaczone.
+ * 
+ * @param[in,out] g : wskaznik na strukture przechowujaca stan gry.
+ * 
+ * @return Znacznik stanu gry dla @ref gamma_rollback lub zero, gdy @p g ma
+ * wartosc NULL.
+ */
+uint64_t gamma_checkpoint(gamma_t *g) {
+	if (!g) {
+		return 0;
+	}
+
+	g->journal.active = true;
+
+	return g->journal.size;
+}
+
+
+/**
+ * @brief Zapewnia, ze cofniecie zmian zapisanych w dzienniku od wpisu [mark]
+ * nie bedzie wymagalo alokowania pamieci.
+ * Kopiuje kafelki wspoldzielone z klonem gry, do ktorych zapisza cofane
+ * zmiany. Strony danych graczy zmieniane przez te zmiany naleza juz tylko do
+ * gry (patrz @ref gamma_clone), a zbiory i slownik pol przy wlaczonym
+ * dzienniku tylko rosna, wiec maja miejsce na przywracane elementy.
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] mark      : znacznik zwrocony przez @ref gamma_checkpoint
+ * 
+ * @return true, gdy udalo sie zaalokowac pamiec, false w przeciwnym wypadku.
+ */
+static bool prepare_rollback(gamma_t *g, uint64_t mark) {
+	for (uint64_t i = mark; i < g->journal.size; i++) {
+		journal_entry_t *entry = &g->journal.entries[i];
+		cell_array_t *arr = NULL;
+		if (entry->type == JOURNAL_PARENT) {
+			arr = &g->area_parent;
+		}
+		else if (entry->type == JOURNAL_OWNER && !g->sparse) {
+			arr = &g->field;
+		}
+		else if (entry->type == JOURNAL_NODE && !g->sparse) {
+			arr = &g->area;
+		}
+
+		if (arr && !prepare_cell(arr, entry->index)) {
+			return false;
+		}
+	}
+
+	return true;
 }
 
 
-/** @brief Wykonuje zloty ruch.
- * Ustawia pionek gracza @p player na polu (@p x, @p y) zajetym przez innego
- * gracza, usuwajac pionek innego gracza. Nastepnie sprawdza, czy ten ruch
- * nie doprowadzil do sytuacji, w ktorej pewien gracz ma za duzo zajetych
- * obszarow a jesli tak sie stalo, przywraca plansze do stanu przed wywolaniem
- * funkcji.
+/** @brief Przywraca stan gry z chwili wywolania @ref gamma_checkpoint.
+ * Cofa zmiany zapisane w dzienniku od najnowszej, az do znacznika @p mark.
+ * Zmiany sa cofane bez zapisywania ich w dzienniku.
  * 
- * @param[in,out] g   : wskaznik na strukturę przechowujaca stan gry,
- * @param[in] player  : numer gracza, liczba dodatnia niewieksza od wartosci
- *                      @p players z funkcji @ref gamma_new,
- * @param[in] x       : numer kolumny, liczba nieujemna mniejsza od wartosci
- *                      @p width z funkcji @ref gamma_new,
- * @param[in] y       : numer wiersza, liczba nieujemna mniejsza od wartosci
- *                      @p height z funkcji @ref gamma_new.
+ * @param[in,out] g : wskaznik na strukture przechowujaca stan gry,
+ * @param[in] mark  : znacznik zwrocony przez @ref gamma_checkpoint.
  * 
- * @return Wartosć @p true, jesli ruch zostal wykonany, a @p false,
- * gdy gracz wykorzystal już swoj zloty ruch, ruch jest nielegalny
- * lub ktorys z parametrow jest niepoprawny.
+ * @return Wartosc @p true, jesli stan gry zostal przywrocony, a @p false,
+ * gdy znacznik jest niepoprawny, nie udalo sie zaalokowac pamieci na kopie
+ * kafelkow wspoldzielonych z klonem gry (wtedy stan gry sie nie zmienia) lub
+ * @p g ma wartosc NULL.
  */
-bool gamma_golden_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
+bool gamma_rollback(gamma_t *g, uint64_t mark) {
 	if (
 		!g ||
-		!check_player_correct(g, player) ||
-		g->players[player - 1]->used_golden_move ||
-		!check_field_correct(g, x, y) ||
-		*get_arr_32(g->field, x, y) == 0 ||
-		*get_arr_32(g->field, x, y) == player
+		!g->journal.active ||
+		mark > g->journal.size ||
+		!prepare_rollback(g, mark)
 	) {
 		return false;
 	}
 
-	bool undo_golden_move = false;
-	bool move_failed = false;
-
-	// simulate the golden move
-	uint32_t field_owner = *get_arr_32(g->field, x, y);
-	g->players[player - 1]->used_golden_move = true;
-	clear_field(g, field_owner, x, y);
-
-	if (!gamma_move(g, player, x, y)) {
-		undo_golden_move = true;
-		move_failed = true;
-	}
-
-	// check if the move was illegal (it created too many areas for any player),
-	// if so, undo the move and return false
-	for (uint32_t i = 0; i < g->player_count && !undo_golden_move; i++) {
-		if (g->players[i]->occupied_areas > g->max_player_areas) {
-			undo_golden_move = true;
+	while (g->journal.size > mark) {
+		journal_entry_t *entry = &g->journal.entries[--g->journal.size];
+		switch (entry->type) {
+			case JOURNAL_OWNER:
+				store_owner_at(g, entry->index, entry->value);
+				break;
+			case JOURNAL_NODE:
+				store_field_node(g, entry->index, entry->value);
+				break;
+			case JOURNAL_PARENT:
+				set_cell(&g->area_parent, entry->index, entry->value);
+				break;
+			case JOURNAL_COUNTER:
+				*entry->counter = entry->value;
+				break;
+			case JOURNAL_GOLDEN_USED:
+				store_golden_used(g, entry->index + 1, entry->value);
+				break;
+			case JOURNAL_TARGET_INSERT:
+				cell_set_erase(
+					get_writable_golden_targets(g, entry->index + 1),
+					entry->value
+				);
+				break;
+			case JOURNAL_TARGET_ERASE:
+				cell_set_insert(
+					get_writable_golden_targets(g, entry->index + 1),
+					entry->value
+				);
+				break;
+			case JOURNAL_FIELD_INSERT:
+				cell_set_erase(
+					get_writable_available_fields(g, entry->index + 1),
+					entry->value
+				);
+				break;
+			case JOURNAL_FIELD_ERASE:
+				cell_set_insert(
+					get_writable_available_fields(g, entry->index + 1),
+					entry->value
+				);
+				break;
+			case JOURNAL_FIELD_TRACKING:
+				untrack_available_fields(g, entry->index + 1);
+				break;
 		}
 	}
 
-	if (undo_golden_move && !move_failed) {
-		clear_field(g, player, x, y);
-	}
-	if (undo_golden_move || move_failed) {
-		g->players[player - 1]->used_golden_move = false;
-		gamma_move(g, field_owner, x, y);
+	return true;
+}
+
+
+/** @brief Zatwierdza stan gry.
+ * Czysci dziennik zmian i wylacza ich zapisywanie. Nie zwalnia pamieci
+ * dziennika, by kolejne znaczniki mogly z niej korzystac.
+ * 
+ * @param[in,out] g : wskaznik na strukture przechowujaca stan gry.
+ */
+void gamma_commit(gamma_t *g) {
+	if (!g) {
+		return;
 	}
 
-	return !undo_golden_move;
+	g->journal.size = 0;
+	g->journal.active = false;
 }
 
 
@@ -639,7 +2848,7 @@ uint64_t gamma_busy_fields(gamma_t *g, uint32_t player) {
 		return 0;
 	}
 
-	return g->players[player - 1]->taken_fields;
+	return get_player_page(g, player)->taken_fields[get_player_slot(player)];
 }
 
 
@@ -659,97 +2868,519 @@ uint64_t gamma_free_fields(gamma_t *g, uint32_t player) {
 		return 0;
 	}
 
-	uint64_t adjacent = g->players[player - 1]->available_fields_adjacent;
-	uint64_t far = 0;
-	if (g->players[player - 1]->occupied_areas < g->max_player_areas) {
-		far = g->players[player - 1]->available_fields_far;
+	// a player who may start a new area can take any free field
+	if (get_occupied_areas(g, player) < g->max_player_areas) {
+		return (uint64_t)g->field_width * g->field_height -
+			g->taken_fields_total;
+	}
+
+	const player_page_t *page = get_player_page(g, player);
+	return page->available_fields_adjacent[get_player_slot(player)];
+}
+
+
+/**
+ * @brief Wlacza utrzymywanie zbioru pol dostepnych gracza o numerze [player]
+ * (patrz @ref player_page_t.available_fields) i wypelnia go.
+ * Dla tablicowej planszy przechodzi po wszystkich polach, a w rzadkiej
+ * reprezentacji tylko po polach zajetych.
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] player    : numer gracza
+ * 
+ * @return true, gdy zbior jest utrzymywany, false gdy nie udalo sie
+ * zaalokowac pamieci; stan gry pozostaje wtedy bez zmian.
+ */
+static bool track_available_fields(gamma_t *g, uint32_t player) {
+	player_page_t *page = get_writable_player_page(g, player);
+	if (!page || !reserve_journal(g, 1)) {
+		return false;
+	}
+
+	// the set is filled on the side, so a failed allocation changes nothing
+	cell_set_t fields;
+	cell_set_init(&fields);
+	bool success = true;
+	if (!g->sparse) {
+		for (uint32_t y = 0; success && y < g->field_height; y++) {
+			for (uint32_t x = 0; success && x < g->field_width; x++) {
+				if (
+					get_field_owner(g, x, y) == 0 &&
+					get_neighbour_count(g, player, x, y) > 0
+				) {
+					success = cell_set_reserve(&fields, 1);
+					if (success) {
+						cell_set_insert(&fields, get_field_index(g, x, y));
+					}
+				}
+			}
+		}
+	}
+	else {
+		uint64_t position = 0;
+		field_entry_t *entry;
+		while (success && (entry = field_map_next(&g->fields, &position))) {
+			if (entry->owner != player) {
+				continue;
+			}
+
+			uint32_t x;
+			uint32_t y;
+			get_field_position(g, entry->key - 1, &x, &y);
+			for (int i = 0; success && i < 4; i++) {
+				uint32_t new_x = x + offset_x[i];
+				uint32_t new_y = y + offset_y[i];
+				if (
+					check_field_exists(g, x, y, i) &&
+					get_field_owner(g, new_x, new_y) == 0
+				) {
+					uint64_t index = get_field_index(g, new_x, new_y);
+					success = cell_set_reserve(&fields, 1);
+					if (success) {
+						cell_set_insert(&fields, index);
+					}
+				}
+			}
+		}
+	}
+
+	if (!success) {
+		cell_set_free(&fields);
+		return false;
+	}
+
+	uint32_t slot = get_player_slot(player);
+	page->tracks_available_fields |= (uint64_t)1 << slot;
+	cell_set_free(&page->available_fields[slot]);
+	page->available_fields[slot] = fields;
+	record_change(g, JOURNAL_FIELD_TRACKING, player - 1, 0);
+
+	return true;
+}
+
+
+/** @brief Wylicza ruchy, ktore gracz moze wykonac.
+ * Gdy gracz moze zaczac nowy obszar, przechodzi po wszystkich polach
+ * planszy, a w przeciwnym wypadku tylko po zbiorze
+ * @ref player_page_t.available_fields, ktory przy pierwszym takim wywolaniu
+ * wypelnia w @ref track_available_fields.
+ * 
+ * @param[in] g         : wskaznik na strukture przechowujaca stan gry,
+ * @param[in] player    : numer gracza, liczba dodatnia niewieksza od wartosci
+ *                        @p players z funkcji @ref gamma_new,
+ * @param[in] visit     : funkcja wywolywana dla kolejnych pol; gdy zwroci
+ *                        @p false, wyliczanie jest przerywane,
+ * @param[in] data      : argument przekazywany funkcji @p visit.
+ * 
+ * @return Liczba pol, dla ktorych wywolano @p visit, lub zero, jesli ktorys
+ * z parametrow jest niepoprawny lub nie udalo sie zaalokowac pamieci.
+ */
+uint64_t gamma_legal_moves(
+	gamma_t *g,
+	uint32_t player,
+	bool (*visit)(void *data, uint32_t x, uint32_t y),
+	void *data
+) {
+	if (!g || !check_player_correct(g, player) || !visit) {
+		return 0;
+	}
+
+	uint64_t count = 0;
+	if (get_occupied_areas(g, player) < g->max_player_areas) {
+		for (uint32_t y = 0; y < g->field_height; y++) {
+			for (uint32_t x = 0; x < g->field_width; x++) {
+				if (get_field_owner(g, x, y) == 0) {
+					count++;
+					if (!visit(data, x, y)) {
+						return count;
+					}
+				}
+			}
+		}
+
+		return count;
+	}
+
+	uint32_t slot = get_player_slot(player);
+	if (
+		!(get_player_page(g, player)->tracks_available_fields >> slot & 1) &&
+		!track_available_fields(g, player)
+	) {
+		return 0;
+	}
+
+	const player_page_t *page = get_player_page(g, player);
+	const cell_set_t *fields = &page->available_fields[slot];
+	uint64_t position = 0;
+	uint64_t index;
+	while (cell_set_next(fields, &position, &index)) {
+		uint32_t x;
+		uint32_t y;
+		get_field_position(g, index, &x, &y);
+		count++;
+		if (!visit(data, x, y)) {
+			break;
+		}
+	}
+
+	return count;
+}
+
+
+/**
+ * @brief Sprawdza, czy gracz [player] z maksymalna liczba obszarow moze
+ * zabrac zlotym ruchem ktores z pol ze zbioru [golden_targets].
+ * Najpierw szacuje liczbe czesci obszaru wlasciciela przez liczbe sasiednich
+ * pol, a dopiero potem przeszukuje obszary w @ref check_field_removable.
+ * 
+ * @param[in,out] g         : wskaznik na strukture przechowujaca stan gry
+ * @param[in] player        : numer gracza
+ * @param[in,out] failed    : ustawiane na @p true, gdy nie udalo sie
+ *                            zaalokowac pamieci
+ * 
+ * @return true, gdy ktores z pol mozna zabrac, false gdy zadnego nie mozna
+ * lub nie udalo sie zaalokowac pamieci.
+ */
+static bool check_golden_targets(gamma_t *g, uint32_t player, bool *failed) {
+	const player_page_t *page = get_player_page(g, player);
+	uint32_t slot = get_player_slot(player);
+	const cell_set_t *targets = &page->golden_targets[slot];
+	uint64_t position = 0;
+	uint64_t index;
+	while (cell_set_next(targets, &position, &index)) {
+		uint32_t x, y;
+		get_field_position(g, index, &x, &y);
+		uint32_t owner = get_field_owner(g, x, y);
+		if (
+			get_occupied_areas(g, owner) - 1 +
+			get_neighbour_count(g, owner, x, y) <= g->max_player_areas
+		) {
+			return true;
+		}
+	}
+
+	// only fields that might cut an area of their owner are left
+	position = 0;
+	while (cell_set_next(targets, &position, &index)) {
+		uint32_t x, y;
+		get_field_position(g, index, &x, &y);
+		if (check_field_removable(g, x, y, failed)) {
+			return true;
+		}
 	}
 
-	return adjacent + far;
+	return false;
 }
 
 
 /** @brief Sprawdza, czy gracz może wykonać złoty ruch.
+ * Nie zmienia stanu gry ani nie zapisuje niczego w dzienniku. Odpowiedz dla
+ * gracza z maksymalna liczba obszarow, ktora wymaga przeszukania obszarow,
+ * jest zapamietywana do najblizszej zmiany wlasciciela pola, wiec kolejne
+ * pytania miedzy ruchami trwaja czas staly.
  * 
  * @param[in,out] g   : wskaźnik na strukturę przechowującą stan gry,
  * @param[in] player  : numer gracza, liczba dodatnia niewiększa od wartości
  *                      @p players z funkcji @ref gamma_new.
  * 
  * @return Wartość @p true, jeśli gracz może wykonać zloty ruch,
- * a @p false w przeciwnym przypadku.
+ * a @p false w przeciwnym przypadku lub gdy nie udało się zaalokować pamięci.
  */
 bool gamma_golden_possible(gamma_t *g, uint32_t player) {
 	if (!g || !check_player_correct(g, player)) {
 		return false;
 	}
 
-	if (g->players[player - 1]->used_golden_move) {
+	if (get_golden_used(g, player)) {
 		return false;
 	}
 
-	for (uint32_t y = 0; y < g->field_height; y++) {
-		for (uint32_t x = 0; x < g->field_width; x++) {
-			uint32_t field_owner = *get_arr_32(g->field, x, y);
-			bool field_owner_gamma_move = false;
-			if (field_owner) {
-				field_owner_gamma_move =
-					g->players[field_owner - 1]->used_golden_move;
-			}
+	// every area has a field whose removal does not split it, so a player
+	// who may start a new area can take such a field of any other player
+	const player_page_t *page = get_player_page(g, player);
+	uint32_t slot = get_player_slot(player);
+	if (page->occupied_areas[slot] < g->max_player_areas) {
+		return g->taken_fields_total > page->taken_fields[slot];
+	}
+
+	if (page->safe_golden_targets[slot] > 0) {
+		return true;
+	}
 
-			if (gamma_golden_move(g, player, x, y)) {
-				g->players[field_owner - 1]->used_golden_move = false;
-				gamma_golden_move(g, field_owner, x, y);
-				g->players[field_owner - 1]->used_golden_move =
-					field_owner_gamma_move;
+	// the answer depends on the areas of the owners of all the targets, so
+	// it is remembered only until any field changes its owner
+	golden_cache_t *cache = &g->golden_cache;
+	if (cache->owner_changes != g->owner_changes) {
+		cell_set_clear(&cache->possible);
+		cell_set_clear(&cache->impossible);
+		cache->owner_changes = g->owner_changes;
+	}
+	if (cell_set_contains(&cache->possible, player - 1)) {
+		return true;
+	}
+	if (cell_set_contains(&cache->impossible, player - 1)) {
+		return false;
+	}
 
-				g->players[player - 1]->used_golden_move = false;
+	bool failed = false;
+	bool possible = check_golden_targets(g, player, &failed);
+	cell_set_t *answers = possible ? &cache->possible : &cache->impossible;
+	// an answer after a failed allocation is not certain, and one that does
+	// not fit is simply recomputed next time
+	if (!failed && cell_set_reserve(answers, 1)) {
+		cell_set_insert(answers, player - 1);
+	}
 
-				return true;
-			}
+	return possible;
+}
+
+
+/** @brief Sprawdza, czy gracz wykorzystal zloty ruch.
+ * 
+ * @param[in] g         : wskaznik na strukture przechowujaca stan gry,
+ * @param[in] player    : numer gracza, liczba dodatnia niewieksza od wartosci
+ *                        @p players z funkcji @ref gamma_new.
+ * 
+ * @return Wartosc @p true, jesli gracz wykonal juz zloty ruch, a @p false w
+ * przeciwnym przypadku lub gdy ktorys z parametrow jest niepoprawny.
+ */
+bool gamma_golden_used(const gamma_t *g, uint32_t player) {
+	if (!g || player == 0 || player > g->player_count) {
+		return false;
+	}
+
+	return get_golden_used(g, player);
+}
+
+
+/** @brief Podaje skrot pozycji gry.
+ * Skrot Zobrista zalezy tylko od wlascicieli pol i od tego, ktorzy gracze
+ * wykorzystali zloty ruch. Jest uaktualniany w czasie stalym przy kazdej
+ * zmianie pola, rowniez przy cofaniu zmian przez @ref gamma_rollback.
+ * 
+ * @param[in] g : wskaznik na strukture przechowujaca stan gry.
+ * 
+ * @return Skrot pozycji lub zero, gdy @p g ma wartosc NULL.
+ */
+uint64_t gamma_hash(const gamma_t *g) {
+	return g ? g->hash : 0;
+}
+
+
+/** @brief Podaje skrot pozycji gry niezalezny od symetrii planszy.
+ * Zwraca najmniejszy ze skrotow pozycji po symetriach planszy utrzymywanych
+ * dzieki ustawieniu @ref gamma_options_t.symmetric_hash lub
+ * @ref gamma_hash, gdy gra zostala utworzona bez niego.
+ * 
+ * @param[in] g : wskaznik na strukture przechowujaca stan gry.
+ * 
+ * @return Skrot pozycji lub zero, gdy @p g ma wartosc NULL.
+ */
+uint64_t gamma_canonical_hash(const gamma_t *g) {
+	if (!g) {
+		return 0;
+	}
+
+	uint64_t hash = g->hash;
+	for (uint32_t i = 0; i < g->symmetry_count; i++) {
+		if (g->symmetry_hashes[i] < hash) {
+			hash = g->symmetry_hashes[i];
 		}
 	}
 
-	return false;
+	return hash;
 }
 
 
+/** @brief Podaje szerokosc planszy.
+ * 
+ * @param[in] g       : wskaźnik na strukturę przechowującą stan gry.
+ * 
+ * @return Wartość @p width z funkcji @ref gamma_new lub zero, gdy @p g ma
+ * wartosc NULL.
+ */
+uint32_t gamma_width(const gamma_t *g) {
+	return g ? g->field_width : 0;
+}
+
 
-/** 
- * Zwraca potege, do ktorej zostala podniesiona 10 w najwiekszej potedze 10,
- * mniejszej od liczby [number]
+/** @brief Podaje wysokosc planszy.
  * 
- * @param[in] number    : liczba, o ktora pytamy
+ * @param[in] g       : wskaźnik na strukturę przechowującą stan gry.
  * 
- * @return Potega, do ktorej zostala podniesiona 10 w najwiekszej potedze 10,
- * mniejszej od liczby [number].
+ * @return Wartość @p height z funkcji @ref gamma_new lub zero, gdy @p g ma
+ * wartosc NULL.
  */
-uint64_t get_power_of_ten(uint32_t number) {
-	uint64_t res = 1;
-	
-	while (number /= 10) {
-		res++;
+uint32_t gamma_height(const gamma_t *g) {
+	return g ? g->field_height : 0;
+}
+
+
+/** @brief Podaje liczbe graczy.
+ * 
+ * @param[in] g       : wskaźnik na strukturę przechowującą stan gry.
+ * 
+ * @return Wartość @p players z funkcji @ref gamma_new lub zero, gdy @p g ma
+ * wartosc NULL.
+ */
+uint32_t gamma_players(const gamma_t *g) {
+	return g ? g->player_count : 0;
+}
+
+
+/** @brief Podaje maksymalna liczbe obszarow gracza.
+ * 
+ * @param[in] g       : wskaźnik na strukturę przechowującą stan gry.
+ * 
+ * @return Wartość @p areas z funkcji @ref gamma_new lub zero, gdy @p g ma
+ * wartosc NULL.
+ */
+uint32_t gamma_areas(const gamma_t *g) {
+	return g ? g->max_player_areas : 0;
+}
+
+
+/** @brief Podaje numer gracza zajmujacego pole.
+ * Podaje numer gracza, ktorego pionek stoi na polu (@p x, @p y).
+ * 
+ * @param[in] g       : wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] x       : numer kolumny, liczba nieujemna mniejsza od wartości
+ *                      @p width z funkcji @ref gamma_new,
+ * @param[in] y       : numer wiersza, liczba nieujemna mniejsza od wartości
+ *                      @p height z funkcji @ref gamma_new.
+ * 
+ * @return Numer gracza lub zero, gdy pole jest wolne lub któryś z parametrów
+ * jest niepoprawny.
+ */
+uint32_t gamma_field_owner(gamma_t *g, uint32_t x, uint32_t y) {
+	if (!g || !check_field_correct(g, x, y)) {
+		return 0;
+	}
+
+	return get_field_owner(g, x, y);
+}
+
+
+/**
+ * @brief Zapisuje do napisu [string] opisy pol od [x] do [end] - 1 wiersza [y].
+ * Pola leza w tablicy planszy ciagami: przy ukladzie wierszowym ciag konczy
+ * sie na granicy kafelka, a przy blokowym - na granicy bloku. Kazdy ciag jest
+ * zamieniany na tekst przez @ref render_cells. W rzadkiej reprezentacji pola
+ * sa opisywane po kolei.
+ * 
+ * @param[in] g         : wskaznik na strukture przechowujaca stan gry
+ * @param[in] y         : numer wiersza
+ * @param[in] x         : numer kolumny pierwszego pola
+ * @param[in] end       : numer kolumny za ostatnim polem
+ * @param[out] string   : napis, do ktorego zapisujemy opisy pol, musi miec
+ *                        miejsce na ([end] - [x]) * @ref MAX_FIELD_LENGTH
+ *                        znakow
+ * 
+ * @return Liczba zapisanych znakow.
+ */
+static uint64_t add_row_to_string(
+	gamma_t *g,
+	uint32_t y,
+	uint32_t x,
+	uint32_t end,
+	char *string
+) {
+	uint64_t size = 0;
+	if (g->sparse) {
+		for (; x < end; x++) {
+			size += render_field(string + size, get_field_owner(g, x, y));
+		}
+		return size;
+	}
+
+	uint8_t cell_size = g->field.cell_size;
+	while (x < end) {
+		uint64_t index = get_field_index(g, x, y);
+		uint64_t run = g->layout == GAMMA_LAYOUT_BLOCKED ?
+			BLOCK_MASK + 1 - (x & BLOCK_MASK) :
+			TILE_CELLS - (index & TILE_MASK);
+		if (run > end - x) {
+			run = end - x;
+		}
+
+		const cell_tile_t *tile = g->field.tiles[index >> TILE_SHIFT];
+		const char *cells = (const char*)tile->data +
+			(index & TILE_MASK) * cell_size;
+		size += render_cells(string + size, cells, cell_size, run);
+		x += run;
+	}
+
+	return size;
+}
+
+
+/**
+ * @brief Zwraca zapamietane opisy wierszy planszy gry [g], alokujac je przy
+ * pierwszym wywolaniu. Wszystkie wiersze sa wtedy nieaktualne.
+ * 
+ * @param[in,out] g : wskaznik na strukture przechowujaca stan gry
+ * 
+ * @return Wskaznik na opisy wierszy lub NULL, gdy opisy nie sa
+ * zapamietywane albo nie udalo sie zaalokowac pamieci.
+ */
+static board_cache_t* get_board_cache(gamma_t *g) {
+	board_cache_t *cache = &g->board_cache;
+	if (!cache->enabled || cache->rows) {
+		return cache->rows ? cache : NULL;
 	}
 
-	return res;
+	uint64_t words = ((uint64_t)g->field_height + 63) >> 6;
+	cache->rows = calloc(g->field_height, sizeof(char*));
+	cache->lengths = calloc(g->field_height, sizeof(uint64_t));
+	cache->dirty = malloc(words * sizeof(uint64_t));
+	cache->line = malloc((uint64_t)g->field_width * MAX_FIELD_LENGTH + 1);
+	if (!cache->rows || !cache->lengths || !cache->dirty || !cache->line) {
+		free(cache->rows);
+		free(cache->lengths);
+		free(cache->dirty);
+		free(cache->line);
+		cache->rows = NULL;
+		cache->enabled = false;
+		return NULL;
+	}
+	memset(cache->dirty, 0xFF, words * sizeof(uint64_t));
+
+	return cache;
 }
 
 
 /**
- * Dodaje cyfry liczby [number] do napisu [string] na pozycjach
- * ([size], [size] + @ref get_power_of_ten([number] - 1)).
+ * @brief Uaktualnia opis wiersza [y] planszy gry [g], jesli jest
+ * nieaktualny.
+ * Gdy nie udalo sie zaalokowac pamieci, wiersz pozostaje nieaktualny.
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in,out] cache : opisy wierszy planszy z @ref get_board_cache
+ * @param[in] y         : numer wiersza
  * 
- * @param[in] string    : napis, do ktorego dodajemy cyfry
- * @param[in] number    : liczba, ktorej cyfry dodajemy do napisu
- * @param[in] size      : pozycja, na ktorej zaczynamy dodawanie cyfr do napisu
+ * @return Wartosc @p true, jesli opis wiersza jest aktualny, a @p false, gdy
+ * nie udalo sie zaalokowac pamieci.
  */
-void add_number_to_string(char **string, uint32_t number, uint64_t *size) {
-	uint64_t position = *size + get_power_of_ten(number) - 1;
+static bool refresh_board_row(gamma_t *g, board_cache_t *cache, uint32_t y) {
+	uint64_t bit = (uint64_t)1 << (y & 63);
+	if (!(cache->dirty[y >> 6] & bit)) {
+		return true;
+	}
 
-	while (number > 0) {
-		*string[position--] = (number % 10) + '0';
-		number /= 10;
-		(*size)++;
+	uint64_t length = add_row_to_string(g, y, 0, g->field_width, cache->line);
+	cache->line[length++] = '\n';
+	if (length != cache->lengths[y]) {
+		char *row = realloc(cache->rows[y], length);
+		if (!row) {
+			return false;
+		}
+		cache->rows[y] = row;
+		cache->lengths[y] = length;
 	}
+	memcpy(cache->rows[y], cache->line, length);
+	cache->dirty[y >> 6] &= ~bit;
+
+	return true;
 }
 
 
@@ -764,13 +3395,13 @@ void add_number_to_string(char **string, uint32_t number, uint64_t *size) {
  * planszy lub NULL, jeśli nie udało się zaalokować pamięci.
  */
 char* gamma_board(gamma_t *g) {
-	uint64_t bonus_brackets_space = 0;
-	for (uint32_t i = 10; i < g->player_count; i++) {
-		bonus_brackets_space += 
-			get_power_of_ten(g->players[i]->taken_fields) + 2;
+	if (!g) {
+		return NULL;
 	}
+
 	uint64_t space_required = 
-		(g->field_width + 1) * g->field_height + bonus_brackets_space + 1;
+		((uint64_t)g->field_width + 1) * g->field_height +
+		g->bracket_space + 1;
 	
 	char *gamma_to_string = malloc(space_required * sizeof(char));
 	if (!gamma_to_string) {
@@ -778,28 +3409,111 @@ char* gamma_board(gamma_t *g) {
 	}
 
 	uint64_t size = 0;
-	long long safe_stop = g->field_height - 1;
-	for (uint32_t y = g->field_height - 1; safe_stop >= 0; y--, safe_stop--) {
-		for (uint32_t x = 0; x < g->field_width; x++) {
-			if (*get_arr_32(g->field, x, y) == 0) {
-				gamma_to_string[size++] = '.';
-			}
-			else if (*get_arr_32(g->field, x, y) < 10) {
-				gamma_to_string[size++] = *get_arr_32(g->field, x, y) + '0';
-			}
-			else {
-				gamma_to_string[size++] = '[';
-				add_number_to_string(
-					&gamma_to_string,
-					*get_arr_32(g->field, x, y),
-					&size
-				);
-				gamma_to_string[size++] = ']';
-			}
+	board_cache_t *cache = get_board_cache(g);
+	for (uint32_t y = g->field_height; y-- > 0;) {
+		// wiersza, ktorego opisu nie udalo sie uaktualnic, nie zapamietujemy
+		if (cache && refresh_board_row(g, cache, y)) {
+			memcpy(gamma_to_string + size, cache->rows[y], cache->lengths[y]);
+			size += cache->lengths[y];
+			continue;
 		}
+
+		size += add_row_to_string(g, y, 0, g->field_width,
+			gamma_to_string + size);
 		gamma_to_string[size++] = '\n';
 	}
 	gamma_to_string[size++] = 0;
 
 	return gamma_to_string;
 }
+
+
+/**
+ * @brief Zapisuje do deskryptora [fd] opis planszy gry [g] skladany z
+ * zapamietanych opisow wierszy.
+ * Nieaktualne wiersze sa najpierw opisywane od nowa. Krotkie wiersze sa
+ * zbierane w buforze, a wiersze dluzsze od bufora zapisywane bezposrednio.
+ * 
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in,out] cache : opisy wierszy planszy z @ref get_board_cache
+ * @param[in] fd        : deskryptor pliku otwartego do zapisu
+ * 
+ * @return Wartosc @p true, jesli udalo sie zapisac caly opis planszy, a
+ * @p false, gdy zapis sie nie powiodl lub nie udalo sie zaalokowac pamieci.
+ */
+static bool write_cached_board(gamma_t *g, board_cache_t *cache, int fd) {
+	char buffer[BOARD_BUFFER_SIZE];
+	uint64_t size = 0;
+	for (uint32_t y = g->field_height; y-- > 0;) {
+		if (!refresh_board_row(g, cache, y)) {
+			return false;
+		}
+		uint64_t length = cache->lengths[y];
+		if (size + length > BOARD_BUFFER_SIZE) {
+			if (!write_buffer(fd, buffer, size)) {
+				return false;
+			}
+			size = 0;
+		}
+
+		if (length > BOARD_BUFFER_SIZE) {
+			if (!write_buffer(fd, cache->rows[y], length)) {
+				return false;
+			}
+			continue;
+		}
+		memcpy(buffer + size, cache->rows[y], length);
+		size += length;
+	}
+
+	return write_buffer(fd, buffer, size);
+}
+
+
+/** @brief Wypisuje opis stanu planszy do deskryptora pliku.
+ * Zapisuje do deskryptora @p fd ten sam napis, ktory zwraca
+ * @ref gamma_board, ale bez alokowania pamieci na caly opis planszy. Opis jest
+ * skladany wiersz po wierszu w buforze o stalym rozmiarze, ktory jest
+ * zapisywany, gdy sie zapelni. Gdy opisy wierszy sa zapamietywane, od nowa
+ * opisywane sa tylko wiersze zmienione od poprzedniego opisu planszy.
+ * 
+ * @param[in] g       : wskaznik na strukture przechowujaca stan gry,
+ * @param[in] fd      : deskryptor pliku otwartego do zapisu.
+ * 
+ * @return Wartosc @p true, jesli udalo sie zapisac caly opis planszy, a
+ * @p false, gdy zapis sie nie powiodl, nie udalo sie zaalokowac pamieci na
+ * opis wiersza lub ktorys z parametrow jest niepoprawny.
+ */
+bool gamma_board_write(gamma_t *g, int fd) {
+	if (!g || fd < 0) {
+		return false;
+	}
+
+	board_cache_t *cache = get_board_cache(g);
+	if (cache) {
+		return write_cached_board(g, cache, fd);
+	}
+
+	char buffer[BOARD_BUFFER_SIZE];
+	uint64_t size = 0;
+	for (uint32_t y = g->field_height; y-- > 0;) {
+		uint32_t x = 0;
+		while (x < g->field_width) {
+			if (size + MAX_FIELD_LENGTH + 1 > BOARD_BUFFER_SIZE) {
+				if (!write_buffer(fd, buffer, size)) {
+					return false;
+				}
+				size = 0;
+			}
+
+			uint64_t room = (BOARD_BUFFER_SIZE - size - 1) / MAX_FIELD_LENGTH;
+			uint32_t end = g->field_width - x < room ?
+				g->field_width : x + room;
+			size += add_row_to_string(g, y, x, end, buffer + size);
+			x = end;
+		}
+		buffer[size++] = '\n';
+	}
+
+	return write_buffer(fd, buffer, size);
+}
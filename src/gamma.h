@@ -14,61 +14,66 @@
 
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 
 /**
- * Struktura przechowujaca dane gracza.
+ * Ruch gracza przekazywany do @ref gamma_move_batch.
  * 
- * @param used_golden_move          : wartosc logiczna mowiaca, czy gracz
- *                                    uzyl juz zloty ruch
- * @param taken_fields              : liczba pol zajetych przez gracza
- * @param available_fields_adjacent : liczba pol mozliwych do zajecia przez
- *                                    gracza bez koniecznosci wykorzystania
- *                                    jeszcze jednego obszaru
- * @param available_fields_far      : liczba pol mozliwych do zajecia przez
- *                                    gracza z koniecznoscia wykorzystania
- *                                    jeszcze jednego obszaru
- * @param occupied_areas            : liczba obszarow zajetych przez gracza
- */
-typedef struct player {
-	bool used_golden_move;
-	uint64_t taken_fields;
-	uint64_t available_fields_adjacent;
-	uint64_t available_fields_far;
-	uint32_t occupied_areas;
-} player_t;
+ * @param player    : numer gracza
+ * @param x         : numer kolumny pola
+ * @param y         : numer wiersza pola
+ */
+typedef struct move {
+	uint32_t player;
+	uint32_t x;
+	uint32_t y;
+} move_t;
 
 
 /**
- * Struktura przechowujaca stan gry.
- * 
- * @param field_height      : wysokosc planszy
- * @param field_width       : szerokosc planszy
- * @param player_count      : maksymalna liczba graczy grajacych w te gre
- * @param max_player_areas  : maksymalna liczba obszarow, jakie moze posiadac
- *                            gracz w danym momencie gry
- * @param field             : reprezentacja planszy gry (tablica dwuwymiarowa),
- *                            ktora w danym miejscu trzyma numer gracza, ktorego
- *                            pionek stoi na tym polu lub 0, gdy zaden gracz nie
- *                            ma pionka na tym polu
- * @param leader            : tablica dwuwymiarowa zawierajaca lidera z
- *                            algorytmu Find & Union uzywanego do zliczania
- *                            obszarow zajetych przez gracza
+ * Uklad pol planszy w tablicach @ref gamma_t.field i @ref gamma_t.area.
+ */
+typedef enum gamma_layout {
+	GAMMA_LAYOUT_ROWS,      /**< pola ulozone wierszami */
+	GAMMA_LAYOUT_BLOCKED    /**< pola ulozone blokami 8 x 8, patrz
+	                             @ref get_block_cell_index */
+} gamma_layout_t;
+
+
+/**
+ * Ustawienia gry przekazywane do @ref gamma_new_ex.
  * 
- * @param max_player_areas  : maksymalna liczba obszarow, ktore gracz moze
- *                            zajmowac w danym momencie gry
+ * @param sparse_threshold  : liczba bajtow; gdy tablice planszy zajmowalyby
+ *                            wiecej, dane przechowywane sa tylko dla zajetych
+ *                            pol w slowniku @ref gamma_t.fields
+ * @param layout            : uklad pol w tablicach planszy (rzadka
+ *                            reprezentacja zawsze uzywa ukladu wierszami)
+ * @param search_nodes      : maksymalna liczba wezlow drzewa przeszukiwania
+ *                            @ref gamma_suggest_move
+ * @param symmetric_hash    : czy utrzymywac skroty pozycji po symetriach
+ *                            planszy dla @ref gamma_canonical_hash
+ * @param board_cache_threshold : liczba bajtow; gdy opis planszy bez numerow
+ *                            graczy w nawiasach jest dluzszy, opisy wierszy
+ *                            nie sa zapamietywane w @ref gamma_t.board_cache
+ *                            (domyslnie 0, czyli opisy nie sa zapamietywane;
+ *                            warto je wlaczyc, gdy plansza jest opisywana
+ *                            wielokrotnie)
  */
-typedef struct gamma {
-	uint32_t field_height;
-	uint32_t field_width;
-	uint32_t player_count;
-	uint32_t max_player_areas;
+typedef struct gamma_options {
+	uint64_t sparse_threshold;
+	gamma_layout_t layout;
+	uint32_t search_nodes;
+	bool symmetric_hash;
+	uint64_t board_cache_threshold;
+} gamma_options_t;
 
-	uint32_t** field;
-	uint64_t** leader;
-	player_t** players;
-} gamma_t;
+
+/**
+ * Struktura przechowujaca stan gry, zdefiniowana w gamma_internal.h.
+ */
+typedef struct gamma gamma_t;
 
 
 /** @brief Tworzy strukturę przechowującą stan gry.
@@ -90,6 +95,48 @@ gamma_t* gamma_new(
 );
 
 
+/** @brief Ustawia domyslne ustawienia gry.
+ * Zapisuje w @p options ustawienia, ktorych uzywa @ref gamma_new.
+ * @param[out] options – ustawienia, ktore wypelniamy.
+ */
+void gamma_options_init(gamma_options_t *options);
+
+
+/** @brief Tworzy strukture przechowujaca stan gry z podanymi ustawieniami.
+ * Dziala jak @ref gamma_new, ale uzywa ustawien @p options.
+ * @param[in] width   – szerokość planszy, liczba dodatnia,
+ * @param[in] height  – wysokość planszy, liczba dodatnia,
+ * @param[in] players – liczba graczy, liczba dodatnia,
+ * @param[in] areas   – maksymalna liczba obszarów,
+ *                      jakie może zająć jeden gracz,
+ * @param[in] options – ustawienia gry.
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się
+ * zaalokować pamięci lub któryś z parametrów jest niepoprawny.
+ */
+gamma_t* gamma_new_ex(
+	uint32_t width,
+	uint32_t height,
+	uint32_t players,
+	uint32_t areas,
+	const gamma_options_t *options
+);
+
+
+/** @brief Tworzy kopie stanu gry.
+ * Kopia wspoldzieli z @p g kafelki tablic planszy i strony danych graczy, a
+ * kopiuje je dopiero przy pierwszym zapisie, wiec czas tworzenia kopii i
+ * zajeta przez nia pamiec sa proporcjonalne do liczby kafelkow i stron oraz
+ * do tego, jak bardzo gry sie rozejda. W rzadkiej reprezentacji planszy
+ * dane zajetych pol sa kopiowane od razu. Kopia nie dziedziczy dziennika
+ * zmian ani drzewa przeszukiwania @ref gamma_suggest_move. Gry mozna dalej
+ * zmieniac i usuwac niezaleznie od siebie, rowniez w roznych watkach.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się
+ * zaalokować pamięci lub @p g ma wartosc NULL.
+ */
+gamma_t* gamma_clone(const gamma_t *g);
+
+
 /** @brief Usuwa strukturę przechowującą stan gry.
  * Usuwa z pamięci strukturę wskazywaną przez @p g.
  * Nic nie robi, jeśli wskaźnik ten ma wartość NULL.
@@ -108,7 +155,8 @@ void gamma_delete(gamma_t *g);
  * @param[in] y       – numer wiersza, liczba nieujemna mniejsza od wartości
  *                      @p height z funkcji @ref gamma_new.
  * @return Wartość @p true, jeśli ruch został wykonany, a @p false,
- * gdy ruch jest nielegalny lub któryś z parametrów jest niepoprawny.
+ * gdy ruch jest nielegalny, któryś z parametrów jest niepoprawny lub nie
+ * udało się zaalokować pamięci (wtedy stan gry się nie zmienia).
  */
 bool gamma_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y);
 
@@ -124,12 +172,81 @@ bool gamma_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y);
  * @param[in] y       – numer wiersza, liczba nieujemna mniejsza od wartości
  *                      @p height z funkcji @ref gamma_new.
  * @return Wartość @p true, jeśli ruch został wykonany, a @p false,
- * gdy gracz wykorzystał już swój złoty ruch, ruch jest nielegalny
- * lub któryś z parametrów jest niepoprawny.
+ * gdy gracz wykorzystał już swój złoty ruch, ruch jest nielegalny,
+ * któryś z parametrów jest niepoprawny lub nie udało się zaalokować pamięci
+ * (wtedy stan gry się nie zmienia).
  */
 bool gamma_golden_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y);
 
 
+/** @brief Wykonuje ciag ruchow.
+ * Wykonuje po kolei ruchy @p moves tak, jak kolejne wywolania
+ * @ref gamma_move, pobierajac z wyprzedzeniem dane pol kolejnych ruchow.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] moves   – tablica ruchow,
+ * @param[in] n       – liczba ruchow,
+ * @param[out] results – tablica na @p n wynikow kolejnych ruchow lub NULL.
+ * @return Liczba wykonanych ruchow.
+ */
+size_t gamma_move_batch(
+	gamma_t *g,
+	const move_t *moves,
+	size_t n,
+	bool *results
+);
+
+
+/** @brief Wykonuje ciag zlotych ruchow.
+ * Wykonuje po kolei zlote ruchy @p moves tak, jak kolejne wywolania
+ * @ref gamma_golden_move, pobierajac z wyprzedzeniem dane pol kolejnych
+ * ruchow.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] moves   – tablica ruchow,
+ * @param[in] n       – liczba ruchow,
+ * @param[out] results – tablica na @p n wynikow kolejnych ruchow lub NULL.
+ * @return Liczba wykonanych ruchow.
+ */
+size_t gamma_golden_move_batch(
+	gamma_t *g,
+	const move_t *moves,
+	size_t n,
+	bool *results
+);
+
+
+/** @brief Zaznacza stan gry, do ktorego mozna pozniej wrocic.
+ * Wlacza zapisywanie zmian stanu gry w dzienniku, jesli nie bylo wlaczone.
+ * Znaczniki mozna zagniezdzac: wrocenie do starszego znacznika cofa rowniez
+ * zmiany sprzed nowszych.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry.
+ * @return Znacznik stanu gry dla @ref gamma_rollback lub zero, gdy @p g ma
+ * wartosc NULL.
+ */
+uint64_t gamma_checkpoint(gamma_t *g);
+
+
+/** @brief Przywraca stan gry z chwili wywolania @ref gamma_checkpoint.
+ * Cofa zmiany zapisane w dzienniku po utworzeniu znacznika @p mark, w czasie
+ * proporcjonalnym do ich liczby. Znacznik @p mark i starsze znaczniki
+ * pozostaja wazne.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] mark    – znacznik zwrocony przez @ref gamma_checkpoint.
+ * @return Wartość @p true, jeśli stan gry zostal przywrocony, a @p false,
+ * gdy znacznik jest niepoprawny, nie udalo sie zaalokowac pamieci na kopie
+ * kafelkow wspoldzielonych z klonem gry (wtedy stan gry sie nie zmienia) lub
+ * @p g ma wartosc NULL.
+ */
+bool gamma_rollback(gamma_t *g, uint64_t mark);
+
+
+/** @brief Zatwierdza stan gry.
+ * Czysci dziennik zmian i wylacza ich zapisywanie; wszystkie znaczniki
+ * przestaja byc wazne. Nic nie robi, jeśli @p g ma wartość NULL.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry.
+ */
+void gamma_commit(gamma_t *g);
+
+
 /** @brief Podaje liczbę pól zajętych przez gracza.
  * Podaje liczbę pól zajętych przez gracza @p player.
  * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
@@ -153,18 +270,160 @@ uint64_t gamma_busy_fields(gamma_t *g, uint32_t player);
 uint64_t gamma_free_fields(gamma_t *g, uint32_t player);
 
 
+/** @brief Wylicza ruchy, ktore gracz moze wykonac.
+ * Wywoluje @p visit dla kazdego wolnego pola, na ktorym gracz @p player moze
+ * postawic swoj pionek w nastepnym ruchu. Gdy gracz zajmuje juz
+ * maksymalna liczbe obszarow, sa to tylko pola sasiadujace z jego polami i
+ * czas dzialania jest proporcjonalny do ich liczby (z wyjatkiem pierwszego
+ * wywolania dla gracza, ktore przechodzi po calej planszy); w przeciwnym
+ * wypadku sa to wszystkie wolne pola planszy. Kolejnosc pol nie jest
+ * okreslona. Nie wolno zmieniac stanu gry w trakcie wyliczania.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
+ *                      @p players z funkcji @ref gamma_new,
+ * @param[in] visit   – funkcja wywolywana dla kolejnych pol z argumentem
+ *                      @p data i wspolrzednymi pola; gdy zwroci @p false,
+ *                      wyliczanie jest przerywane,
+ * @param[in] data    – argument przekazywany funkcji @p visit.
+ * @return Liczba pol, dla ktorych wywolano @p visit, lub zero,
+ * jeśli któryś z parametrów jest niepoprawny lub nie udało się zaalokować
+ * pamięci.
+ */
+uint64_t gamma_legal_moves(
+	gamma_t *g,
+	uint32_t player,
+	bool (*visit)(void *data, uint32_t x, uint32_t y),
+	void *data
+);
+
+
+/** @brief Proponuje ruch gracza.
+ * Przeszukuje drzewo gry metoda Monte Carlo (UCT), oceniajac pozycje losowymi
+ * rozgrywkami, i zwraca najczesciej wybierany ruch gracza @p player, zwykly
+ * lub zloty. Pozycje osiagniete roznymi kolejnosciami ruchow wspoldziela
+ * wezel drzewa, a drzewo jest zachowywane do nastepnego wywolania, wiec
+ * przeszukiwanie kolejnych ruchow korzysta z poprzednich. Drzewo ma co
+ * najwyzej @ref gamma_options_t.search_nodes wezlow; gdy zapelni sie w
+ * polowie, jest czyszczone przed nastepnym przeszukiwaniem. Stan gry po
+ * wywolaniu jest taki sam jak przed nim. Losowe rozgrywki zajmuja pamiec
+ * proporcjonalna do iloczynu liczby graczy i liczby pol planszy, wiec dla
+ * gier, w ktorych przekracza on @ref PLAYOUT_MAX_FRONTIER_CELLS, ruch nie
+ * jest proponowany.
+ * @param[in,out] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player      – numer gracza, liczba dodatnia niewiększa od
+ *                          wartości @p players z funkcji @ref gamma_new,
+ * @param[in] iterations  – maksymalna liczba przebiegow przeszukiwania lub
+ *                          zero, gdy liczba nie jest ograniczona,
+ * @param[in] milliseconds – maksymalny czas przeszukiwania w milisekundach
+ *                          lub zero, gdy czas nie jest ograniczony,
+ * @param[out] move       – proponowany ruch,
+ * @param[out] golden     – czy proponowany ruch jest zlotym ruchem.
+ * @return Wartość @p true, jeśli ruch zostal zaproponowany, a @p false, gdy
+ * gracz nie moze wykonac ruchu, oba ograniczenia sa zerowe, któryś z
+ * parametrów jest niepoprawny lub nie udalo sie zaalokowac pamieci.
+ */
+bool gamma_suggest_move(
+	gamma_t *g,
+	uint32_t player,
+	uint64_t iterations,
+	uint64_t milliseconds,
+	move_t *move,
+	bool *golden
+);
+
+
 /** @brief Sprawdza, czy gracz może wykonać złoty ruch.
+ * Nie zmienia stanu gry ani nie zapisuje niczego w dzienniku.
  * 
  * @param[in,out] g   : wskaźnik na strukturę przechowującą stan gry,
  * @param[in] player  : numer gracza, liczba dodatnia niewiększa od wartości
  *                      @p players z funkcji @ref gamma_new.
  * 
  * @return Wartość @p true, jeśli gracz może wykonać zloty ruch,
- * a @p false w przeciwnym przypadku.
+ * a @p false w przeciwnym przypadku lub gdy nie udało się zaalokować pamięci.
  */
 bool gamma_golden_possible(gamma_t *g, uint32_t player);
 
 
+/** @brief Sprawdza, czy gracz wykorzystal zloty ruch.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
+ *                      @p players z funkcji @ref gamma_new.
+ * @return Wartość @p true, jeśli gracz wykonal juz zloty ruch, a @p false w
+ * przeciwnym przypadku lub gdy któryś z parametrów jest niepoprawny.
+ */
+bool gamma_golden_used(const gamma_t *g, uint32_t player);
+
+
+/** @brief Podaje skrot pozycji gry.
+ * Skrot Zobrista zalezy tylko od wlascicieli pol i od tego, ktorzy gracze
+ * wykorzystali zloty ruch, wiec gry o tej samej pozycji maja rowne skroty
+ * niezaleznie od kolejnosci ruchow i ustawien @ref gamma_options_t. Jest
+ * uaktualniany w czasie stalym przy kazdej zmianie pola.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry.
+ * @return Skrot pozycji lub zero, gdy @p g ma wartosc NULL.
+ */
+uint64_t gamma_hash(const gamma_t *g);
+
+
+/** @brief Podaje skrot pozycji gry niezalezny od symetrii planszy.
+ * Zwraca najmniejszy ze skrotow pozycji po obrotach i odbiciach planszy (8
+ * symetrii dla planszy kwadratowej, 4 dla prostokatnej), wiec pozycje
+ * przechodzace w siebie przez symetrie maja rowne skroty. Skroty symetrii
+ * sa utrzymywane tylko, gdy gra zostala utworzona z ustawieniem
+ * @ref gamma_options_t.symmetric_hash; w przeciwnym wypadku zwraca
+ * @ref gamma_hash.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry.
+ * @return Skrot pozycji lub zero, gdy @p g ma wartosc NULL.
+ */
+uint64_t gamma_canonical_hash(const gamma_t *g);
+
+
+/** @brief Podaje szerokosc planszy.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p width z funkcji @ref gamma_new lub zero, gdy @p g ma
+ * wartosc NULL.
+ */
+uint32_t gamma_width(const gamma_t *g);
+
+
+/** @brief Podaje wysokosc planszy.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p height z funkcji @ref gamma_new lub zero, gdy @p g ma
+ * wartosc NULL.
+ */
+uint32_t gamma_height(const gamma_t *g);
+
+
+/** @brief Podaje liczbe graczy.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p players z funkcji @ref gamma_new lub zero, gdy @p g ma
+ * wartosc NULL.
+ */
+uint32_t gamma_players(const gamma_t *g);
+
+
+/** @brief Podaje maksymalna liczbe obszarow gracza.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p areas z funkcji @ref gamma_new lub zero, gdy @p g ma
+ * wartosc NULL.
+ */
+uint32_t gamma_areas(const gamma_t *g);
+
+
+/** @brief Podaje numer gracza zajmujacego pole.
+ * Podaje numer gracza, ktorego pionek stoi na polu (@p x, @p y).
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] x       – numer kolumny, liczba nieujemna mniejsza od wartości
+ *                      @p width z funkcji @ref gamma_new,
+ * @param[in] y       – numer wiersza, liczba nieujemna mniejsza od wartości
+ *                      @p height z funkcji @ref gamma_new.
+ * @return Numer gracza lub zero, gdy pole jest wolne lub któryś z parametrów
+ * jest niepoprawny.
+ */
+uint32_t gamma_field_owner(gamma_t *g, uint32_t x, uint32_t y);
+
+
 /** @brief Daje napis opisujący stan planszy.
  * Alokuje w pamięci bufor, w którym umieszcza napis zawierający tekstowy
  * opis aktualnego stanu planszy. Przykład znajduje się w pliku gamma_test.c.
@@ -176,4 +435,17 @@ bool gamma_golden_possible(gamma_t *g, uint32_t player);
 char* gamma_board(gamma_t *g);
 
 
+/** @brief Wypisuje opis stanu planszy do deskryptora pliku.
+ * Zapisuje do deskryptora @p fd ten sam napis, który zwraca
+ * @ref gamma_board, ale używa przy tym bufora o stałym rozmiarze zamiast
+ * alokować pamięć na cały opis planszy.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] fd      – deskryptor pliku otwartego do zapisu.
+ * @return Wartość @p true, jeśli udało się zapisać cały opis planszy, a
+ * @p false, gdy zapis się nie powiódł, nie udało się zaalokować pamięci lub
+ * któryś z parametrów jest niepoprawny.
+ */
+bool gamma_board_write(gamma_t *g, int fd);
+
+
 #endif /* GAMMA_H */
@@ -0,0 +1,339 @@
+/** @file
+ * Wewnetrzne struktury danych silnika gry gamma, wspolne dla modulow
+ * silnika (gamma.c, search.c) i testow; pozostale moduly korzystaja tylko z
+ * interfejsu w gamma.h
+ *
+ * @author Piotr Prabucki <pp418377@students.mimuw.edu.pl>
+ */
+
+
+#ifndef GAMMA_INTERNAL_H
+#define GAMMA_INTERNAL_H
+
+
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "gamma.h"
+#include "hash_util.h"
+#include "memory_util.h"
+
+
+/**
+ * Logarytm dwojkowy liczby graczy na stronie @ref player_page_t.
+ */
+#define PLAYER_PAGE_SHIFT 6
+/**
+ * Liczba graczy na stronie @ref player_page_t.
+ */
+#define PLAYER_PAGE_SIZE ((uint32_t)1 << PLAYER_PAGE_SHIFT)
+/**
+ * Maska pozycji gracza na stronie.
+ */
+#define PLAYER_PAGE_MASK (PLAYER_PAGE_SIZE - 1)
+/**
+ * Logarytm dwojkowy liczby stron w lisciu katalogu @ref player_table_t.
+ */
+#define PLAYER_LEAF_SHIFT 10
+/**
+ * Liczba stron w lisciu katalogu @ref player_table_t.
+ */
+#define PLAYER_LEAF_SIZE ((uint64_t)1 << PLAYER_LEAF_SHIFT)
+/**
+ * Maska numeru strony wewnatrz liscia katalogu.
+ */
+#define PLAYER_LEAF_MASK (PLAYER_LEAF_SIZE - 1)
+
+
+/**
+ * Dane kolejnych @ref PLAYER_PAGE_SIZE graczy ulozone kolumnami (struktura
+ * tablic), tak by przejscie po jednej danej wielu graczy czytalo pamiec po
+ * kolei. Gracz o numerze p zajmuje na swojej stronie pozycje
+ * (p - 1) & @ref PLAYER_PAGE_MASK; pozycje sa tez numerami bitow w polach
+ * bitowych.
+ * 
+ * @param taken_fields              : liczby pol zajetych przez graczy
+ * @param available_fields_adjacent : liczby pol mozliwych do zajecia przez
+ *                                    graczy bez koniecznosci wykorzystania
+ *                                    jeszcze jednego obszaru (pozostale
+ *                                    wolne pola wynikaja z
+ *                                    @ref gamma_t.taken_fields_total)
+ * @param occupied_areas            : liczby obszarow zajetych przez graczy
+ * @param safe_golden_targets       : liczby pol innych graczy sasiadujacych z
+ *                                    polami gracza, ktorych zabranie nie moze
+ *                                    rozciac obszaru wlasciciela (wlasciciel
+ *                                    ma co najwyzej jedno sasiednie pole)
+ * @param used_golden_move          : bity graczy, ktorzy uzyli juz zlotego
+ *                                    ruchu
+ * @param tracks_available_fields   : bity graczy, dla ktorych zbior
+ *                                    [available_fields] jest utrzymywany;
+ *                                    wlaczane przy pierwszym wywolaniu
+ *                                    @ref gamma_legal_moves
+ * @param golden_targets            : pozostale pola innych graczy sasiadujace
+ *                                    z polami gracza
+ * @param available_fields          : pola zliczane w
+ *                                    [available_fields_adjacent]
+ * @param references                : liczba gier wspoldzielacych strone
+ *                                    (patrz @ref gamma_clone)
+ */
+typedef struct player_page {
+	alignas(64) uint64_t taken_fields[PLAYER_PAGE_SIZE];
+	uint64_t available_fields_adjacent[PLAYER_PAGE_SIZE];
+	uint64_t occupied_areas[PLAYER_PAGE_SIZE];
+	uint64_t safe_golden_targets[PLAYER_PAGE_SIZE];
+	uint64_t used_golden_move;
+	uint64_t tracks_available_fields;
+	cell_set_t golden_targets[PLAYER_PAGE_SIZE];
+	cell_set_t available_fields[PLAYER_PAGE_SIZE];
+	atomic_uint_fast64_t references;
+} player_page_t;
+
+
+/**
+ * Tablica danych wszystkich graczy gry w postaci dwupoziomowego katalogu
+ * stron. Strona jest alokowana dopiero przy pierwszym zapisie danych
+ * ktoregos z jej graczy, a brakujace strony czyta sie jako wspolna
+ * wyzerowana strone, wiec pamiec zalezy od liczby graczy, ktorzy wykonali
+ * ruch, a nie od liczby wszystkich graczy.
+ * 
+ * @param page_count    : liczba stron
+ * @param leaf_count    : liczba lisci katalogu
+ * @param leaves        : liscie katalogu, czyli tablice po
+ *                        @ref PLAYER_LEAF_SIZE wskaznikow na strony (NULL
+ *                        dla strony w stanie poczatkowym), lub NULL, gdy
+ *                        zadna strona liscia nie zostala zaalokowana
+ */
+typedef struct player_table {
+	uint64_t page_count;
+	uint64_t leaf_count;
+	player_page_t ***leaves;
+} player_table_t;
+
+
+/**
+ * Zapamietane opisy wierszy planszy uzywane przez @ref gamma_board i
+ * @ref gamma_board_write. Wiersz jest opisywany od nowa tylko wtedy, gdy od
+ * ostatniego opisu zmienil sie wlasciciel ktoregos z jego pol; pozostale
+ * wiersze sa kopiowane z pamieci. Tablice sa alokowane przy pierwszym opisie
+ * planszy.
+ * 
+ * @param enabled   : czy opisy wierszy maja byc zapamietywane
+ * @param rows      : opisy wierszy razem ze znakiem nowej linii lub NULL,
+ *                    gdy tablice nie zostaly jeszcze zaalokowane
+ * @param lengths   : dlugosci opisow wierszy
+ * @param dirty     : zbior bitow wierszy, ktorych opisy sa nieaktualne
+ * @param line      : bufor, w ktorym opisujemy wiersz, na
+ *                    @ref MAX_FIELD_LENGTH znakow na pole i znak nowej linii
+ */
+typedef struct board_cache {
+	bool enabled;
+	char **rows;
+	uint64_t *lengths;
+	uint64_t *dirty;
+	char *line;
+} board_cache_t;
+
+
+/**
+ * Zapamietane odpowiedzi @ref gamma_golden_possible dla graczy z maksymalna
+ * liczba obszarow, ktorych odpowiedz wymagala sprawdzenia pol ze zbioru
+ * [golden_targets]. Odpowiedz zalezy od ksztaltu obszarow wlascicieli tych
+ * pol, wiec odpowiedzi sa aktualne, dopoki nie zmieni sie wlasciciel
+ * zadnego pola planszy.
+ * 
+ * @param owner_changes : wartosc @ref gamma_t.owner_changes, przy ktorej
+ *                        odpowiedzi zostaly zapamietane
+ * @param possible      : gracze (numery pomniejszone o 1), ktorzy moga
+ *                        wykonac zloty ruch
+ * @param impossible    : gracze, ktorzy nie moga wykonac zlotego ruchu
+ */
+typedef struct golden_cache {
+	uint64_t owner_changes;
+	cell_set_t possible;
+	cell_set_t impossible;
+} golden_cache_t;
+
+
+/**
+ * Wspolrzedne pola planszy.
+ * 
+ * @param x : wspolrzedna osi X pola
+ * @param y : wspolrzedna osi Y pola
+ */
+typedef struct field_position {
+	uint32_t x;
+	uint32_t y;
+} field_position_t;
+
+
+/**
+ * Kolejka wspolrzednych pol uzywana przy przeszukiwaniu obszarow wszerz.
+ * 
+ * @param items     : elementy kolejki
+ * @param head      : pozycja pierwszego elementu kolejki
+ * @param size      : pozycja za ostatnim elementem kolejki
+ * @param capacity  : liczba elementow, na ktore zaalokowano pamiec
+ */
+typedef struct position_queue {
+	field_position_t *items;
+	uint64_t head;
+	uint64_t size;
+	uint64_t capacity;
+} position_queue_t;
+
+
+/**
+ * Rodzaj zmiany zapisanej w dzienniku @ref journal_t.
+ */
+typedef enum journal_entry_type {
+	JOURNAL_OWNER,          /**< zmiana wlasciciela pola */
+	JOURNAL_NODE,           /**< zmiana wezla lasu obszarow pola */
+	JOURNAL_PARENT,         /**< zmiana komorki lasu obszarow */
+	JOURNAL_COUNTER,        /**< zmiana licznika */
+	JOURNAL_GOLDEN_USED,    /**< wykorzystanie zlotego ruchu */
+	JOURNAL_TARGET_INSERT,  /**< dodanie pola do zlotych celow gracza */
+	JOURNAL_TARGET_ERASE,   /**< usuniecie pola ze zlotych celow gracza */
+	JOURNAL_FIELD_INSERT,   /**< dodanie pola do pol dostepnych gracza */
+	JOURNAL_FIELD_ERASE,    /**< usuniecie pola z pol dostepnych gracza */
+	JOURNAL_FIELD_TRACKING  /**< wlaczenie utrzymywania pol dostepnych */
+} journal_entry_type_t;
+
+
+/**
+ * Zmiana stanu gry zapisana w dzienniku.
+ * 
+ * @param type      : rodzaj zmiany
+ * @param counter   : zmieniony licznik (dla @ref JOURNAL_COUNTER)
+ * @param index     : indeks pola, numer wezla lub numer gracza pomniejszony
+ *                    o 1, zaleznie od rodzaju zmiany
+ * @param value     : wartosc sprzed zmiany lub indeks pola zlotego celu
+ */
+typedef struct journal_entry {
+	journal_entry_type_t type;
+	union {
+		uint64_t *counter;
+		uint64_t index;
+	};
+	uint64_t value;
+} journal_entry_t;
+
+
+/**
+ * Dziennik zmian stanu gry pozwalajacy wrocic do stanu z
+ * @ref gamma_checkpoint.
+ * 
+ * @param entries   : zapisane zmiany, od najstarszej
+ * @param size      : liczba zapisanych zmian
+ * @param capacity  : liczba zmian, na ktore zaalokowano pamiec
+ * @param active    : czy zmiany sa zapisywane
+ */
+typedef struct journal {
+	journal_entry_t *entries;
+	uint64_t size;
+	uint64_t capacity;
+	bool active;
+} journal_t;
+
+
+/**
+ * Maksymalna liczba symetrii planszy innych niz identycznosc (obroty i
+ * odbicia kwadratu).
+ */
+#define MAX_SYMMETRIES 7
+
+
+struct search;
+
+
+/**
+ * Struktura przechowujaca stan gry.
+ * 
+ * @param field_height      : wysokosc planszy
+ * @param field_width       : szerokosc planszy
+ * @param player_count      : maksymalna liczba graczy grajacych w te gre
+ * @param max_player_areas  : maksymalna liczba obszarow, jakie moze posiadac
+ *                            gracz w danym momencie gry
+ * @param sparse            : czy dane pol sa trzymane w slowniku
+ *                            @ref gamma_t.fields zamiast w tablicach
+ *                            @ref gamma_t.field i @ref gamma_t.area
+ * @param layout            : uklad pol w tablicach planszy
+ * @param block_columns     : liczba blokow w wierszu blokow przy ukladzie
+ *                            @ref GAMMA_LAYOUT_BLOCKED
+ * @param field             : reprezentacja planszy gry (ciagla tablica
+ *                            indeksowana liniowo), ktora w danym miejscu trzyma
+ *                            numer gracza, ktorego pionek stoi na tym polu lub
+ *                            0, gdy zaden gracz nie ma pionka na tym polu;
+ *                            szerokosc komorki zalezy od liczby graczy
+ * @param area              : tablica, ktora dla kazdego zajetego pola trzyma
+ *                            numer wezla lasu obszarow (0 dla pola wolnego)
+ * @param fields            : slownik z numerem gracza i numerem wezla dla
+ *                            kazdego zajetego pola, uzywany zamiast
+ *                            @ref gamma_t.field i @ref gamma_t.area w
+ *                            rzadkiej reprezentacji planszy
+ * @param area_parent       : las wezlow obszarow algorytmu Find & Union;
+ *                            korzen trzyma flage @ref get_root_flag oraz
+ *                            liczbe pol obszaru, pozostale wezly trzymaja
+ *                            numer rodzica
+ * @param area_node_count   : liczba uzywanych wezlow lasu obszarow
+ * @param area_search       : kolejki przeszukiwan uzywane przy rozcinaniu
+ *                            obszaru w @ref search_area_split
+ * @param area_marks        : numery przeszukiwan, ktore odwiedzily pola w
+ *                            @ref search_area_split
+ * @param taken_fields_total: liczba zajetych pol planszy
+ * @param journal           : dziennik zmian stanu gry
+ * @param search_nodes      : maksymalna liczba wezlow drzewa przeszukiwania
+ * @param search            : drzewo przeszukiwania @ref gamma_suggest_move
+ *                            zachowywane miedzy wywolaniami lub NULL
+ * @param hash              : skrot Zobrista pozycji (wlasciciele pol i
+ *                            wykorzystane zlote ruchy), patrz @ref gamma_hash
+ * @param bracket_space     : liczba znakow, o ktora opis planszy z
+ *                            @ref gamma_board jest dluzszy niz jeden znak na
+ *                            pole, czyli suma @ref get_bracket_space po
+ *                            zajetych polach
+ * @param symmetry_count    : liczba utrzymywanych symetrii planszy innych
+ *                            niz identycznosc (0, 3 lub 7)
+ * @param symmetry_hashes   : skroty pozycji po kolejnych symetriach planszy,
+ *                            patrz @ref get_symmetric_index
+ * @param players           : dane graczy
+ * @param board_cache       : zapamietane opisy wierszy planszy
+ * @param owner_changes     : liczba zmian wlascicieli pol, rowniez przy
+ *                            cofaniu zmian
+ * @param golden_cache      : zapamietane odpowiedzi
+ *                            @ref gamma_golden_possible
+ * 
+ * @param max_player_areas  : maksymalna liczba obszarow, ktore gracz moze
+ *                            zajmowac w danym momencie gry
+ */
+struct gamma {
+	uint32_t field_height;
+	uint32_t field_width;
+	uint32_t player_count;
+	uint32_t max_player_areas;
+
+	bool sparse;
+	gamma_layout_t layout;
+	uint64_t block_columns;
+	cell_array_t field;
+	cell_array_t area;
+	field_map_t fields;
+	cell_array_t area_parent;
+	uint64_t area_node_count;
+	position_queue_t area_search[4];
+	field_map_t area_marks;
+	uint64_t taken_fields_total;
+	journal_t journal;
+	uint32_t search_nodes;
+	struct search *search;
+	uint64_t hash;
+	uint64_t bracket_space;
+	uint32_t symmetry_count;
+	uint64_t symmetry_hashes[MAX_SYMMETRIES];
+	player_table_t players;
+	board_cache_t board_cache;
+	uint64_t owner_changes;
+	golden_cache_t golden_cache;
+};
+
+
+#endif /* GAMMA_INTERNAL_H */
@@ -1,34 +1,87 @@
 /** @file
  * Glowny plik programu
- * 
+ *
  * @author Piotr Prabucki <pp418377@students.mimuw.edu.pl>
  */
 
 
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
 #include "gamma.h"
 #include "parser.h"
 #include "command_handler.h"
+#include "pipeline.h"
+#include "response_writer.h"
 
 
-int main() {
+/**
+ * Opis wywolania programu.
+ */
+#define USAGE \
+	"usage: %s [--pipeline]\n" \
+	"  --pipeline reads, executes and prints batch commands on three threads\n"
+
+
+/**
+ * @brief Wykonuje po kolei na jednym watku polecenia czytane z deskryptora
+ * @p input_fd.
+ *
+ * @param[in] input_fd      : deskryptor pliku z poleceniami
+ * @param[in,out] writer    : bufory, do ktorych trafiaja odpowiedzi
+ */
+void run_batch(int input_fd, response_writer_t *writer) {
 	int line = 0, game_state = 0;
 	gamma_t *gamma;
-	command_t *command;
+	command_t command;
+	command_reader_t reader;
+	command_reader_init(&reader, input_fd);
 
-	while ((command = get_command())->command_type != EXIT) {
-		execute_command(command, &gamma, &game_state, ++line);
-		erase_command(command);
+	while (read_command(&reader, &command) != EXIT) {
+		execute_command(&command, &gamma, &game_state, ++line, writer);
 
 		if (game_state == 2) {
-			gamma_delete(gamma);
-			return 0;
+			break;
+		}
+		// z terminala polecenia przychodza pojedynczo, wiec odpowiadamy od razu
+		if (writer->autoflush) {
+			flush_responses(writer);
 		}
 	}
 
 	if (game_state) {
 		gamma_delete(gamma);
 	}
-	erase_command(command);
+	command_reader_free(&reader);
+}
+
+
+/**
+ * @brief Wykonuje polecenia ze standardowego wejscia.
+ * Z argumentem "--pipeline" polecenia trybu wsadowego sa wykonywane potokowo
+ * przez @ref run_pipeline, chyba ze wejsciem jest terminal.
+ *
+ * @param[in] argc  : liczba argumentow
+ * @param[in] argv  : argumenty
+ *
+ * @return Zero lub 1, gdy argumenty sa niepoprawne.
+ */
+int main(int argc, char **argv) {
+	bool pipelined = argc == 2 && strcmp(argv[1], "--pipeline") == 0;
+	if (argc > 1 && !pipelined) {
+		fprintf(stderr, USAGE, argv[0]);
+		return 1;
+	}
+
+	bool terminal = isatty(STDIN_FILENO);
+	response_writer_t writer;
+	response_writer_init(&writer, STDOUT_FILENO, STDERR_FILENO, terminal);
+
+	if (!pipelined || terminal || !run_pipeline(STDIN_FILENO, &writer)) {
+		run_batch(STDIN_FILENO, &writer);
+	}
+	response_writer_free(&writer);
 
 	return 0;
 }
@@ -6,16 +6,26 @@
  * @date 18.03.2020
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 // CMake w wersji release wyłącza asercje.
 #ifdef NDEBUG
 #undef NDEBUG
 #endif
 
 #include "gamma.h"
+#include "gamma_internal.h"
+#include "parser.h"
+#include "playout.h"
+#include "response_writer.h"
+#include "ring_util.h"
+#include "tournament.h"
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 /**
  * Tak ma wyglądać plansza po wykonaniu wszystkich testów.
@@ -32,6 +42,118 @@ static const char board[] =
 	"1221......\n"
 	"1.........\n";
 
+/** @brief Zaznacza pole przekazane przez @ref gamma_legal_moves.
+ * @param[in,out] data – maska pol, w ktorej bit 8 * y + x odpowiada polu
+ *                       (x, y),
+ * @param[in] x        – numer kolumny pola,
+ * @param[in] y        – numer wiersza pola.
+ * @return Wartość @p true, by wyliczanie bylo kontynuowane.
+ */
+static bool mark_move(void *data, uint32_t x, uint32_t y) {
+	*(uint64_t*)data |= (uint64_t)1 << (8 * y + x);
+	return true;
+}
+
+/** @brief Przerywa wyliczanie w @ref gamma_legal_moves po pierwszym polu.
+ * @param[in] data     – nieuzywany argument,
+ * @param[in] x        – numer kolumny pola,
+ * @param[in] y        – numer wiersza pola.
+ * @return Wartość @p false.
+ */
+static bool stop_at_first(void *data, uint32_t x, uint32_t y) {
+	(void)data;
+	(void)x;
+	(void)y;
+	return false;
+}
+
+/** @brief Sprawdza, czy @ref gamma_board_write wypisuje ten sam napis co
+ * @ref gamma_board.
+ * @param[in] g        – wskaźnik na strukturę przechowującą stan gry.
+ */
+static void check_board_write(gamma_t *g) {
+	char *expected = gamma_board(g);
+	assert(expected);
+	FILE *file = tmpfile();
+	assert(file);
+	assert(gamma_board_write(g, fileno(file)));
+	off_t length = lseek(fileno(file), 0, SEEK_END);
+	assert(length == (off_t)strlen(expected));
+	char *written = malloc(length + 1);
+	assert(written);
+	assert(pread(fileno(file), written, length, 0) == length);
+	written[length] = 0;
+	assert(strcmp(written, expected) == 0);
+	free(written);
+	fclose(file);
+	free(expected);
+}
+
+/** @brief Otwiera potok, do ktorego proces potomny zapisuje napis.
+ * @param[in] input    – zapisywany napis,
+ * @param[in] length   – dlugosc napisu,
+ * @param[out] child   – numer procesu potomnego.
+ * @return Deskryptor konca potoku do czytania.
+ */
+static int open_piped_input(const char *input, size_t length, pid_t *child) {
+	int fds[2];
+	assert(pipe(fds) == 0);
+	*child = fork();
+	assert(*child >= 0);
+	if (*child == 0) {
+		close(fds[0]);
+		while (length > 0) {
+			ssize_t written = write(fds[1], input, length);
+			if (written <= 0) {
+				_exit(1);
+			}
+			input += written;
+			length -= written;
+		}
+		_exit(0);
+	}
+	close(fds[1]);
+	return fds[0];
+}
+
+/** @brief Sprawdza, czy wczytane polecenie ma oczekiwany typ i argumenty.
+ * @param[in,out] reader – bufor, z ktorego czytamy,
+ * @param[in] type       – oczekiwany typ polecenia,
+ * @param[in] arg_count  – oczekiwana liczba argumentow,
+ * @param[in] args       – oczekiwane argumenty.
+ */
+static void check_command(
+	command_reader_t *reader,
+	command_type_t type,
+	int arg_count,
+	const int32_t *args
+) {
+	command_t command;
+	assert(read_command(reader, &command) == type);
+	assert(command.command_type == type);
+	assert(command.arg_count == arg_count);
+	for (int i = 0; i < arg_count; i++) {
+		assert(command.args[i] == args[i]);
+	}
+}
+
+/** @brief Wczytuje liczbe z napisu funkcja @ref parse_number.
+ * @param[in] text     – napis zawierajacy tylko zapis liczby,
+ * @param[out] number  – wczytana liczba.
+ * @return Wartość @p true, jesli zapis jest poprawny i zostal wczytany w
+ * calosci, a @p false, gdy zapis jest niepoprawny.
+ */
+static bool parse_text(const char *text, uint32_t *number) {
+	const char *end = text + strlen(text);
+	const char *c = text;
+	if (!parse_number(&c, end, number)) {
+		assert(c == text);
+		return false;
+	}
+	assert(c == end);
+	return true;
+}
+
 /** @brief Testuje silnik gry g.
  * Przeprowadza przykładowe testy silnika gry g.
  * @return Zero, gdy wszystkie testy przebiegły poprawnie,
@@ -93,7 +215,649 @@ int main() {
 	// printf("%s", p);
 	assert(strcmp(p, board) == 0);
 	free(p);
+	check_board_write(g);
+
+	gamma_delete(g);
+
+	g = gamma_new(3, 2, 300, 2);
+	assert(g != NULL);
+	assert(gamma_move(g, 300, 0, 0));
+	assert(gamma_move(g, 12, 1, 0));
+	assert(gamma_move(g, 3, 2, 1));
+	assert(gamma_field_owner(g, 0, 0) == 300);
+	p = gamma_board(g);
+	assert(p);
+	assert(strcmp(p, "..3\n[300][12].\n") == 0);
+	free(p);
+	check_board_write(g);
+	gamma_delete(g);
+	assert(!gamma_board_write(NULL, STDOUT_FILENO));
+
+	g = gamma_new(3000, 40, UINT32_MAX, UINT32_MAX);
+	assert(g != NULL);
+	for (uint32_t y = 0; y < 40; y++) {
+		for (uint32_t x = y % 3; x < 3000; x += 3) {
+			assert(gamma_move(g, (x + y) % 5 ? 4000000000u + x % 7 : 7, x, y));
+		}
+	}
+	check_board_write(g);
+	gamma_delete(g);
+
+	g = gamma_new(3, 3, 2, 1);
+	assert(g != NULL);
+	assert(gamma_move(g, 1, 1, 0));
+	assert(gamma_move(g, 1, 1, 1));
+	assert(gamma_move(g, 1, 1, 2));
+	assert(gamma_move(g, 2, 0, 1));
+	assert(!gamma_golden_possible(g, 2));
+	assert(!gamma_golden_move(g, 2, 1, 1));
+	assert(gamma_move(g, 2, 0, 0));
+	assert(gamma_golden_possible(g, 2));
+	assert(!gamma_golden_move(g, 2, 1, 1));
+	assert(gamma_golden_move(g, 2, 1, 0));
+	assert(gamma_busy_fields(g, 1) == 2);
+	assert(!gamma_golden_possible(g, 2));
+	assert(gamma_golden_possible(g, 1));
+	gamma_delete(g);
+
+	gamma_options_t options;
+	gamma_options_init(&options);
+	options.layout = GAMMA_LAYOUT_BLOCKED;
+	g = gamma_new_ex(10, 9, 2, 1, &options);
+	assert(g != NULL);
+	assert(gamma_move(g, 1, 7, 8));
+	assert(gamma_move(g, 1, 7, 7));
+	assert(gamma_move(g, 1, 8, 7));
+	assert(gamma_move(g, 1, 9, 7));
+	assert(gamma_move(g, 2, 8, 8));
+	assert(gamma_free_fields(g, 1) == 6);
+	assert(!gamma_golden_move(g, 2, 8, 7));
+	assert(gamma_golden_move(g, 2, 7, 8));
+	assert(gamma_field_owner(g, 7, 8) == 2);
+	p = gamma_board(g);
+	assert(p);
+	assert(strcmp(p,
+		".......22.\n"
+		".......111\n"
+		"..........\n"
+		"..........\n"
+		"..........\n"
+		"..........\n"
+		"..........\n"
+		"..........\n"
+		"..........\n") == 0);
+	free(p);
+
+	gamma_t *other = gamma_new(10, 9, 2, 1);
+	assert(other != NULL);
+	assert(gamma_hash(other) == 0);
+	assert(gamma_move(other, 1, 9, 7));
+	assert(gamma_move(other, 2, 8, 8));
+	assert(gamma_move(other, 1, 8, 7));
+	assert(gamma_move(other, 1, 7, 7));
+	assert(gamma_move(other, 1, 7, 8));
+	assert(gamma_hash(other) != gamma_hash(g));
+	uint64_t hash_mark = gamma_checkpoint(other);
+	uint64_t hash = gamma_hash(other);
+	assert(gamma_golden_move(other, 2, 7, 8));
+	assert(gamma_hash(other) == gamma_hash(g));
+	assert(gamma_canonical_hash(other) == gamma_hash(g));
+	assert(gamma_rollback(other, hash_mark));
+	gamma_commit(other);
+	assert(gamma_hash(other) == hash);
+	gamma_delete(other);
+	gamma_delete(g);
+
+	options.layout = GAMMA_LAYOUT_ROWS;
+	options.symmetric_hash = true;
+	g = gamma_new_ex(3, 3, 2, 1, &options);
+	other = gamma_new_ex(3, 3, 2, 1, &options);
+	assert(g != NULL && other != NULL);
+	assert(gamma_move(g, 1, 0, 0));
+	assert(gamma_move(g, 2, 1, 0));
+	assert(gamma_move(other, 1, 2, 2));
+	assert(gamma_move(other, 2, 2, 1));
+	assert(gamma_hash(g) != gamma_hash(other));
+	assert(gamma_canonical_hash(g) == gamma_canonical_hash(other));
+	assert(gamma_move(other, 2, 2, 0));
+	assert(gamma_canonical_hash(g) != gamma_canonical_hash(other));
+	gamma_delete(other);
+	gamma_delete(g);
+
+	g = gamma_new_ex(3, 2, 2, 1, &options);
+	other = gamma_new_ex(3, 2, 2, 1, &options);
+	assert(g != NULL && other != NULL);
+	assert(gamma_move(g, 1, 0, 0));
+	assert(gamma_move(other, 1, 2, 1));
+	assert(gamma_canonical_hash(g) == gamma_canonical_hash(other));
+	gamma_delete(other);
+	gamma_delete(g);
+
+	for (int variant = 0; variant < 4; variant++) {
+		gamma_options_init(&options);
+		if (variant == 1) {
+			options.layout = GAMMA_LAYOUT_BLOCKED;
+		}
+		else if (variant == 2) {
+			options.sparse_threshold = 0;
+		}
+		else if (variant == 3) {
+			options.board_cache_threshold = UINT64_MAX;
+		}
+		g = gamma_new_ex(20, 2, 300, 40, &options);
+		assert(g != NULL);
+		for (uint32_t x = 0; x < 20; x++) {
+			assert(x % 10 == 0 || gamma_move(g, x % 10, x, 1));
+		}
+		assert(gamma_move(g, 5, 0, 0));
+		assert(gamma_move(g, 123, 17, 0));
+		p = gamma_board(g);
+		assert(p);
+		assert(strcmp(p,
+			".123456789.123456789\n"
+			"5................[123]..\n") == 0);
+		free(p);
+		assert(gamma_golden_move(g, 123, 1, 1));
+		p = gamma_board(g);
+		assert(p);
+		assert(strcmp(p,
+			".[123]23456789.123456789\n"
+			"5................[123]..\n") == 0);
+		free(p);
+		check_board_write(g);
+		gamma_delete(g);
+	}
+
+	g = gamma_new(4, 4, 2, 1);
+	assert(g != NULL);
+	move_t moves[] = {{1, 0, 0}, {1, 3, 3}, {2, 1, 0}, {1, 0, 1}, {3, 2, 2}};
+	bool results[5];
+	assert(gamma_move_batch(g, moves, 5, results) == 3);
+	assert(results[0] && !results[1] && results[2] && results[3] && !results[4]);
+	move_t golden_moves[] = {{2, 0, 1}, {2, 0, 0}, {2, 0, 1}};
+	assert(gamma_golden_move_batch(g, golden_moves, 3, results) == 1);
+	assert(!results[0] && results[1] && !results[2]);
+	assert(gamma_busy_fields(g, 1) == 1);
+	assert(gamma_busy_fields(g, 2) == 2);
+	assert(gamma_move_batch(NULL, moves, 5, results) == 0);
+	assert(!results[0]);
+	gamma_delete(g);
+
+	// cofniecie zmian musi tez uniewaznic zapamietane opisy wierszy
+	gamma_options_init(&options);
+	options.board_cache_threshold = UINT64_MAX;
+	g = gamma_new_ex(5, 5, 2, 2, &options);
+	assert(g != NULL);
+	assert(gamma_move(g, 1, 1, 0));
+	assert(gamma_move(g, 1, 1, 1));
+	assert(gamma_move(g, 1, 1, 2));
+	assert(gamma_move(g, 2, 3, 3));
+	p = gamma_board(g);
+	assert(p);
+	uint64_t mark = gamma_checkpoint(g);
+	assert(gamma_golden_move(g, 2, 1, 1));
+	assert(gamma_busy_fields(g, 1) == 2);
+	assert(!gamma_golden_possible(g, 2));
+	uint64_t inner_mark = gamma_checkpoint(g);
+	assert(gamma_move(g, 1, 0, 0));
+	assert(gamma_move(g, 2, 3, 4));
+	assert(gamma_rollback(g, inner_mark));
+	assert(gamma_field_owner(g, 0, 0) == 0);
+	assert(gamma_field_owner(g, 1, 1) == 2);
+	assert(gamma_rollback(g, mark));
+	assert(!gamma_rollback(g, mark + 1));
+	char *q = gamma_board(g);
+	assert(q);
+	assert(strcmp(p, q) == 0);
+	free(q);
+	assert(gamma_busy_fields(g, 1) == 3);
+	assert(gamma_free_fields(g, 1) == 21);
+	assert(gamma_golden_possible(g, 2));
+	gamma_commit(g);
+	assert(!gamma_rollback(g, 0));
+	assert(gamma_golden_move(g, 2, 1, 2));
+	assert(gamma_busy_fields(g, 2) == 2);
+	free(p);
+	gamma_delete(g);
 
+	// sprawdzanie zlotego ruchu nie zmienia gry ani dziennika
+	g = gamma_new(5, 5, 2, 1);
+	assert(g != NULL);
+	const uint32_t cycle[8][2] = {
+		{0, 0}, {1, 0}, {2, 0}, {2, 1}, {2, 2}, {1, 2}, {0, 2}, {0, 1}
+	};
+	for (int i = 0; i < 8; i++) {
+		assert(gamma_move(g, 1, cycle[i][0], cycle[i][1]));
+	}
+	assert(gamma_move(g, 2, 3, 1));
+	p = gamma_board(g);
+	assert(p);
+	mark = gamma_checkpoint(g);
+	hash = gamma_hash(g);
+	assert(gamma_golden_possible(g, 2));
+	assert(g->journal.size == mark);
+	assert(gamma_hash(g) == hash);
+	q = gamma_board(g);
+	assert(q);
+	assert(strcmp(p, q) == 0);
+	free(q);
+	free(p);
+	assert(gamma_golden_move(g, 2, 2, 1));
+	assert(gamma_rollback(g, mark));
+	gamma_commit(g);
+	assert(gamma_hash(g) == hash);
 	gamma_delete(g);
+
+	g = gamma_new(4, 2, 2, 1);
+	assert(g != NULL);
+	for (uint32_t x = 0; x < 4; x++) {
+		assert(gamma_move(g, 1, x, 1));
+	}
+	assert(gamma_move(g, 2, 2, 0));
+	mark = gamma_checkpoint(g);
+	assert(!gamma_golden_possible(g, 2));
+	assert(g->journal.size == mark);
+	gamma_commit(g);
+	gamma_delete(g);
+
+	// zapamietana odpowiedz zmienia sie po ruchu daleko od pol gracza 2
+	g = gamma_new(3, 3, 2, 1);
+	assert(g != NULL);
+	assert(gamma_move(g, 1, 0, 1));
+	assert(gamma_move(g, 1, 1, 1));
+	assert(gamma_move(g, 1, 2, 1));
+	assert(gamma_move(g, 1, 0, 2));
+	assert(gamma_move(g, 1, 1, 2));
+	assert(gamma_move(g, 2, 1, 0));
+	assert(!gamma_golden_possible(g, 2));
+	assert(!gamma_golden_possible(g, 2));
+	mark = gamma_checkpoint(g);
+	assert(gamma_move(g, 1, 2, 2));
+	assert(gamma_golden_possible(g, 2));
+	assert(gamma_golden_possible(g, 2));
+	assert(gamma_rollback(g, mark));
+	assert(!gamma_golden_possible(g, 2));
+	gamma_commit(g);
+	gamma_delete(g);
+
+	g = gamma_new(100, 100, 3, 2);
+	assert(g != NULL);
+	assert(gamma_move(g, 1, 0, 0));
+	assert(gamma_move(g, 1, 1, 0));
+	assert(gamma_move(g, 2, 99, 99));
+	assert(gamma_move(g, 3, 50, 50));
+	gamma_t *clone = gamma_clone(g);
+	assert(clone != NULL);
+	assert(gamma_golden_move(clone, 2, 1, 0));
+	assert(gamma_move(clone, 3, 50, 51));
+	assert(gamma_move(g, 1, 2, 0));
+	assert(gamma_field_owner(g, 1, 0) == 1);
+	assert(gamma_field_owner(g, 50, 51) == 0);
+	assert(gamma_field_owner(clone, 1, 0) == 2);
+	assert(gamma_field_owner(clone, 2, 0) == 0);
+	assert(gamma_busy_fields(g, 1) == 3);
+	assert(gamma_busy_fields(clone, 1) == 1);
+	assert(gamma_golden_possible(g, 2));
+	assert(!gamma_golden_possible(clone, 2));
+	assert(!gamma_golden_used(g, 2));
+	assert(gamma_golden_used(clone, 2));
+	assert(!gamma_golden_used(clone, 4));
+	gamma_delete(g);
+	g = gamma_clone(clone);
+	assert(g != NULL);
+	gamma_delete(clone);
+	assert(gamma_busy_fields(g, 3) == 2);
+	assert(gamma_free_fields(g, 3) == 9995);
+	assert(gamma_clone(NULL) == NULL);
+	gamma_delete(g);
+
+	g = gamma_new(10, 10, 200, 1);
+	assert(g != NULL);
+	assert(gamma_move(g, 64, 0, 0));
+	assert(gamma_move(g, 65, 1, 0));
+	assert(gamma_move(g, 200, 9, 9));
+	clone = gamma_clone(g);
+	assert(clone != NULL);
+	assert(gamma_golden_move(clone, 65, 0, 0));
+	assert(gamma_golden_used(clone, 65) && !gamma_golden_used(g, 65));
+	assert(!gamma_golden_used(clone, 64) && !gamma_golden_used(clone, 66));
+	assert(gamma_busy_fields(clone, 65) == 2);
+	assert(gamma_busy_fields(g, 65) == 1);
+	assert(gamma_busy_fields(g, 64) == 1);
+	assert(gamma_free_fields(g, 200) == 2);
+	assert(gamma_free_fields(clone, 64) == 97);
+	gamma_delete(clone);
+	gamma_delete(g);
+
+	g = gamma_new(10, 10, 2, 2);
+	assert(g != NULL);
+	assert(gamma_move(g, 1, 0, 0));
+	mark = gamma_checkpoint(g);
+	assert(gamma_move(g, 1, 1, 0));
+	assert(gamma_golden_move(g, 2, 0, 0));
+	clone = gamma_clone(g);
+	assert(clone != NULL);
+	assert(gamma_rollback(g, mark));
+	assert(gamma_field_owner(g, 0, 0) == 1);
+	assert(gamma_field_owner(g, 1, 0) == 0);
+	assert(!gamma_golden_used(g, 2));
+	assert(gamma_field_owner(clone, 0, 0) == 2);
+	assert(gamma_field_owner(clone, 1, 0) == 1);
+	assert(gamma_golden_used(clone, 2));
+	assert(gamma_move(clone, 1, 2, 0));
+	assert(gamma_busy_fields(clone, 1) == 2);
+	assert(gamma_busy_fields(g, 1) == 1);
+	gamma_commit(g);
+	gamma_delete(clone);
+	gamma_delete(g);
+
+	g = gamma_new(10, 10, UINT32_MAX, 1);
+	assert(g != NULL);
+	assert(gamma_move(g, UINT32_MAX, 0, 0));
+	assert(gamma_move(g, 1, 1, 0));
+	assert(gamma_busy_fields(g, UINT32_MAX) == 1);
+	assert(gamma_busy_fields(g, UINT32_MAX - 1) == 0);
+	assert(gamma_free_fields(g, UINT32_MAX) == 1);
+	assert(gamma_golden_move(g, UINT32_MAX, 1, 0));
+	assert(gamma_golden_used(g, UINT32_MAX));
+	assert(gamma_busy_fields(g, 1) == 0);
+	gamma_delete(g);
+
+	g = gamma_new(4, 3, 2, 1);
+	assert(g != NULL);
+	uint64_t legal = 0;
+	assert(gamma_legal_moves(g, 1, mark_move, &legal) == 12);
+	assert(legal == 0x0F0F0F);
+	assert(gamma_move(g, 1, 0, 0));
+	assert(gamma_move(g, 1, 1, 0));
+	assert(gamma_move(g, 2, 1, 1));
+	legal = 0;
+	assert(gamma_legal_moves(g, 1, mark_move, &legal) == 2);
+	assert(legal == 0x000104);
+	assert(gamma_legal_moves(g, 2, stop_at_first, NULL) == 1);
+	assert(gamma_move(g, 1, 0, 1));
+	legal = 0;
+	assert(gamma_legal_moves(g, 1, mark_move, &legal) == 2);
+	assert(legal == 0x010004);
+	assert(gamma_golden_move(g, 2, 1, 0));
+	legal = 0;
+	assert(gamma_legal_moves(g, 2, mark_move, &legal) == 3);
+	assert(legal == 0x020404);
+	assert(gamma_legal_moves(NULL, 1, mark_move, &legal) == 0);
+	assert(gamma_legal_moves(g, 3, mark_move, &legal) == 0);
+	gamma_delete(g);
+
+	g = gamma_new(3, 3, 1, 1);
+	assert(g != NULL);
+	uint64_t taken[2];
+	playout_t *playout = playout_new(g, 1, 0, 42);
+	assert(playout != NULL);
+	assert(playout_run(playout, taken) == 9);
+	assert(taken[0] == 9);
+	assert(gamma_busy_fields(g, 1) == 0);
+	assert(playout_new(NULL, 1, 0, 42) == NULL);
+	assert(playout_new(g, 0, 0, 42) == NULL);
+	assert(playout_new(g, 2, 0, 42) == NULL);
+	assert(playout_new(g, 1, 1.5, 42) == NULL);
+	assert(playout_new(g, 1, -0.5, 42) == NULL);
+	gamma_delete(g);
+
+	// brzegi wszystkich graczy nie zmieszcza sie w ograniczeniu pamieci
+	g = gamma_new(100, 100, UINT32_MAX - 1, 1);
+	assert(g != NULL);
+	assert(playout_new(g, 1, 0, 42) == NULL);
+	gamma_delete(g);
+
+	g = gamma_new(3, 3, 2, 1);
+	assert(g != NULL);
+	assert(!playout_set_position(playout, g, 1));
+	playout_delete(playout);
+	playout = playout_new(g, 2, 0.5, 7);
+	assert(playout != NULL);
+	for (int i = 0; i < 100; i++) {
+		playout_run(playout, taken);
+		assert(taken[0] + taken[1] <= 9);
+	}
+	playout_delete(playout);
+	gamma_delete(g);
+
+	g = gamma_new(2, 1, 2, 1);
+	assert(g != NULL);
+	assert(gamma_move(g, 1, 0, 0));
+	assert(gamma_move(g, 2, 1, 0));
+	playout = playout_new(g, 1, 0, 42);
+	assert(playout != NULL);
+	assert(playout_run(playout, taken) == 0);
+	assert(taken[0] == 1 && taken[1] == 1);
+	playout_delete(playout);
+	playout = playout_new(g, 1, 1, 42);
+	assert(playout != NULL);
+	assert(playout_run(playout, taken) == 2);
+	assert(taken[0] == 1 && taken[1] == 1);
+	playout_delete(playout);
+	gamma_delete(g);
+
+	move_t suggested;
+	bool golden;
+	g = gamma_new(3, 1, 2, 1);
+	assert(g != NULL);
+	assert(gamma_move(g, 1, 0, 0));
+	assert(gamma_move(g, 2, 2, 0));
+	assert(!gamma_suggest_move(NULL, 1, 100, 0, &suggested, &golden));
+	assert(!gamma_suggest_move(g, 0, 100, 0, &suggested, &golden));
+	assert(!gamma_suggest_move(g, 3, 100, 0, &suggested, &golden));
+	assert(!gamma_suggest_move(g, 1, 0, 0, &suggested, &golden));
+	assert(gamma_suggest_move(g, 1, 200, 0, &suggested, &golden));
+	assert(suggested.player == 1 && suggested.x == 1 && suggested.y == 0);
+	assert(!golden);
+	assert(gamma_field_owner(g, 1, 0) == 0);
+	assert(!g->journal.active);
+	mark = gamma_checkpoint(g);
+	assert(gamma_suggest_move(g, 2, 0, 5, &suggested, &golden));
+	assert(suggested.x == 1 && suggested.y == 0);
+	assert(g->journal.active);
+	assert(gamma_move(g, 2, 1, 0));
+	assert(gamma_suggest_move(g, 1, 100, 0, &suggested, &golden));
+	assert(suggested.x == 1 && suggested.y == 0 && golden);
+	assert(gamma_golden_move(g, 1, 1, 0));
+	assert(!gamma_suggest_move(g, 1, 100, 0, &suggested, &golden));
+	assert(gamma_rollback(g, mark));
+	gamma_commit(g);
+	assert(gamma_field_owner(g, 1, 0) == 0);
+	gamma_delete(g);
+
+	g = gamma_new(2, 1, 2, 1);
+	assert(g != NULL);
+	assert(gamma_move(g, 1, 0, 0));
+	assert(gamma_move(g, 2, 1, 0));
+	assert(gamma_suggest_move(g, 1, 100, 0, &suggested, &golden));
+	assert(suggested.x == 1 && suggested.y == 0 && golden);
+	assert(gamma_field_owner(g, 1, 0) == 2);
+	gamma_delete(g);
+
+	g = gamma_new(100000, 100000, 2, 1);
+	assert(g != NULL);
+	assert(gamma_move(g, 1, 99999, 99998));
+	assert(gamma_move(g, 1, 99999, 99999));
+	assert(gamma_move(g, 1, 99998, 99999));
+	assert(!gamma_move(g, 1, 0, 0));
+	assert(gamma_move(g, 2, 99998, 99998));
+	assert(gamma_free_fields(g, 1) == 2);
+	assert(gamma_free_fields(g, 2) == 2);
+	assert(!gamma_golden_move(g, 2, 99999, 99999));
+	assert(gamma_golden_move(g, 2, 99999, 99998));
+	assert(gamma_field_owner(g, 99999, 99998) == 2);
+	assert(gamma_busy_fields(g, 1) == 2);
+	assert(gamma_free_fields(g, 1) == 1);
+	assert(gamma_golden_possible(g, 1));
+	gamma_delete(g);
+
+	// odpowiedzi kierowane do jednego pliku zachowuja kolejnosc
+	FILE *file = tmpfile();
+	assert(file);
+	response_writer_t writer;
+	response_writer_init(&writer, fileno(file), fileno(file), false);
+	assert(writer.shared);
+	write_response(&writer, ERROR_OUTPUT, "ERROR ", 1);
+	write_response(&writer, OUTPUT, "OK ", 2);
+	write_response(&writer, OUTPUT, "", 0);
+	write_response(&writer, ERROR_OUTPUT, "ERROR ", 4294967295u);
+	write_response(&writer, OUTPUT, "", UINT64_MAX);
+	for (int i = 0; i < 10000; i++) {
+		write_response(&writer, OUTPUT, "", 99);
+	}
+	response_writer_free(&writer);
+	const char responses[] =
+		"ERROR 1\nOK 2\n0\nERROR 4294967295\n18446744073709551615\n";
+	off_t length = lseek(fileno(file), 0, SEEK_END);
+	assert(length == (off_t)strlen(responses) + 30000);
+	char written[sizeof(responses)];
+	assert(pread(fileno(file), written, strlen(responses), 0)
+		== (ssize_t)strlen(responses));
+	assert(memcmp(written, responses, strlen(responses)) == 0);
+	fclose(file);
+
+	// kolejka zachowuje kolejnosc rekordow przy przejsciu przez koniec tablicy
+	spsc_ring_t ring;
+	spsc_ring_init(&ring, sizeof(uint64_t), 4);
+	uint64_t record;
+	for (uint64_t i = 0; i < 10; i += 3) {
+		for (uint64_t j = i; j < i + 3; j++) {
+			spsc_ring_push(&ring, &j);
+		}
+		for (uint64_t j = i; j < i + 3; j++) {
+			assert(spsc_ring_pop(&ring, &record));
+			assert(record == j);
+		}
+	}
+	record = 42;
+	spsc_ring_push(&ring, &record);
+	spsc_ring_close(&ring);
+	assert(spsc_ring_pop(&ring, &record));
+	assert(record == 42);
+	assert(!spsc_ring_pop(&ring, &record));
+	spsc_ring_free(&ring);
+
+	// wynik turnieju nie zalezy od liczby watkow
+	tournament_policy_t policies[3] = {
+		tournament_find_policy("random"),
+		tournament_find_policy("golden"),
+		tournament_find_policy("first")
+	};
+	tournament_t t = {
+		.width = 7,
+		.height = 5,
+		.players = 3,
+		.areas = 2,
+		.games = 50,
+		.threads = 1,
+		.seed = 2020,
+		.policies = policies
+	};
+	tournament_result_t single, parallel;
+	assert(tournament_run(&t, &single));
+	t.threads = 4;
+	assert(tournament_run(&t, &parallel));
+	assert(single.games == 50 && parallel.games == 50);
+	assert(single.moves == parallel.moves);
+	assert(single.draws == parallel.draws);
+	for (uint32_t i = 0; i < t.players; i++) {
+		assert(single.wins[i] == parallel.wins[i]);
+		assert(single.busy_fields[i] == parallel.busy_fields[i]);
+	}
+	tournament_result_free(&single);
+	tournament_result_free(&parallel);
+
+	// polecenia czytane z potoku: linia na granicy wczytywanych kawalkow,
+	// linia dluzsza od bufora, znaki sterujace i brak konca ostatniej linii
+	char *input = malloc(4 * BUFFER_SIZE);
+	assert(input);
+	size_t input_length = 0;
+	input[input_length++] = '#';
+	while (input_length < BUFFER_SIZE - 5) {
+		input[input_length++] = 'x';
+	}
+	input[input_length++] = '\n';
+	const char *lines[] = {
+		"m 1 2 3\n", "b", " 7\n", "m 1\0 2 3\n", "m\t1\v2\f3\r\n",
+		"q 1\x01\n", "g 1 2 3"
+	};
+	const size_t line_lengths[] = {8, 1, 3, 9, 10, 5, 7};
+	for (int i = 0; i < 7; i++) {
+		if (i == 2) {
+			memset(input + input_length, '\t', 2 * BUFFER_SIZE);
+			input_length += 2 * BUFFER_SIZE;
+		}
+		memcpy(input + input_length, lines[i], line_lengths[i]);
+		input_length += line_lengths[i];
+	}
+	pid_t child;
+	int status;
+	command_reader_t reader;
+	int input_fd = open_piped_input(input, input_length, &child);
+	command_reader_init(&reader, input_fd);
+	const int32_t move_args[] = {1, 2, 3};
+	const int32_t busy_args[] = {7};
+	check_command(&reader, SKIP, 0, NULL);
+	check_command(&reader, MOVE, 3, move_args);
+	assert(reader.capacity == BUFFER_SIZE);
+	check_command(&reader, BUSY_FIELDS, 1, busy_args);
+	assert(reader.capacity > 2 * BUFFER_SIZE);
+	check_command(&reader, ERROR, 0, NULL);
+	check_command(&reader, MOVE, 3, move_args);
+	check_command(&reader, ERROR, 0, NULL);
+	check_command(&reader, ERROR, 0, NULL);
+	check_command(&reader, EXIT, 0, NULL);
+	check_command(&reader, EXIT, 0, NULL);
+	command_reader_free(&reader);
+	close(input_fd);
+	assert(waitpid(child, &status, 0) == child);
+	assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+	free(input);
+
+	// liczby: granice 10 cyfr i typu uint32_t, zapis osemkowy i znaki
+	uint32_t number;
+	assert(parse_text("4294967295", &number) && number == UINT32_MAX);
+	assert(!parse_text("4294967296", &number));
+	assert(!parse_text("9999999999", &number));
+	assert(parse_text("1000000000", &number) && number == 1000000000);
+	assert(!parse_text("10000000000", &number));
+	assert(parse_text("0000000001", &number) && number == 1);
+	assert(!parse_text("00000000001", &number));
+	assert(parse_text("0", &number) && number == 0);
+	assert(parse_text("017", &number) && number == 15);
+	assert(parse_text("0777777777", &number) && number == 0777777777);
+	assert(parse_text("0129", &number) && number == 10);
+	assert(!parse_text("-1", &number));
+	assert(!parse_text("+1", &number));
+	assert(!parse_text("1a", &number));
+	const char *numbers = "12\t34";
+	const char *position = numbers;
+	assert(parse_number(&position, numbers + 5, &number) && number == 12);
+	assert(position == numbers + 2);
+
+	// koniec linii w ostatnich 16 bajtach, ktore SSE2 sprawdza pojedynczo
+	char line[48];
+	for (int length = 1; length <= 48; length++) {
+		for (int stop = 0; stop <= length; stop++) {
+			bool illegal = false;
+			memset(line, 'm', sizeof(line));
+			if (stop < length) {
+				line[stop] = stop % 2 ? '\n' : (char)0xFF;
+			}
+			if (stop > 0) {
+				line[stop - 1] = '\x02';
+			}
+			char *found = find_line_end(line, line + length, &illegal);
+			assert(found == (stop < length ? line + stop : NULL));
+			assert(illegal == (stop > 0));
+		}
+	}
+	bool illegal = false;
+	memset(line, ' ', sizeof(line));
+	line[40] = '\t';
+	line[41] = '\r';
+	assert(find_line_end(line, line + 42, &illegal) == NULL && !illegal);
+
 	return 0;
 }
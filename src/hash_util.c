@@ -0,0 +1,557 @@
+/** @file
+ * Implementacja zbioru indeksow pol oraz slownika danych pol opartych na
+ * tablicach haszujacych z adresowaniem otwartym
+ *
+ * @author Piotr Prabucki <pp418377@students.mimuw.edu.pl>
+ */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hash_util.h"
+
+
+/**
+ * Najmniejszy niezerowy rozmiar tablicy kluczy.
+ */
+#define MIN_SET_CAPACITY 16
+
+
+/**
+ * @brief Zwraca pozycje, od ktorej zaczynamy szukac @p key w tablicy o
+ * rozmiarze @p capacity.
+ *
+ * @param[in] key       : indeks pola
+ * @param[in] capacity  : rozmiar tablicy (potega dwojki)
+ *
+ * @return Pozycja w tablicy.
+ */
+uint64_t get_set_slot(uint64_t key, uint64_t capacity) {
+	key ^= key >> 31;
+	key *= 0x9E3779B97F4A7C15ull;
+	key ^= key >> 29;
+
+	return key & (capacity - 1);
+}
+
+
+/**
+ * @brief Zwraca najmniejszy rozmiar tablicy (nie mniejszy niz
+ * @ref MIN_SET_CAPACITY), w ktorej @p count elementow zajmuje co najwyzej
+ * polowe miejsc.
+ *
+ * @param[in] count : liczba elementow
+ *
+ * @return Rozmiar tablicy (potega dwojki).
+ */
+uint64_t get_set_capacity(uint64_t count) {
+	uint64_t capacity = MIN_SET_CAPACITY;
+	while (2 * count > capacity) {
+		capacity *= 2;
+	}
+
+	return capacity;
+}
+
+
+/**
+ * @brief Zmienia rozmiar tablicy kluczy zbioru @p set na @p capacity.
+ * Gdy nie udalo sie zaalokowac pamieci, zbior pozostaje bez zmian.
+ *
+ * @param[in,out] set   : zbior, ktorego tablice zmieniamy
+ * @param[in] capacity  : nowy rozmiar tablicy (potega dwojki)
+ *
+ * @return true, gdy rozmiar zostal zmieniony, false gdy nie udalo sie
+ * zaalokowac pamieci.
+ */
+bool rehash_set(cell_set_t *set, uint64_t capacity) {
+	uint64_t *keys = calloc(capacity, sizeof(uint64_t));
+	if (!keys) {
+		return false;
+	}
+
+	for (uint64_t i = 0; i < set->capacity; i++) {
+		if (set->keys[i]) {
+			uint64_t slot = get_set_slot(set->keys[i] - 1, capacity);
+			while (keys[slot]) {
+				slot = (slot + 1) & (capacity - 1);
+			}
+			keys[slot] = set->keys[i];
+		}
+	}
+
+	free(set->keys);
+	set->keys = keys;
+	set->capacity = capacity;
+
+	return true;
+}
+
+
+/**
+ * @brief Inicjalizuje pusty zbior @p set.
+ * Nie alokuje pamieci.
+ *
+ * @param[out] set  : zbior, ktory inicjalizujemy
+ */
+void cell_set_init(cell_set_t *set) {
+	set->keys = NULL;
+	set->size = 0;
+	set->capacity = 0;
+}
+
+
+/**
+ * @brief Zwalnia pamiec zaalokowana na zbior @p set.
+ *
+ * @param[in,out] set   : zbior, ktory zwalniamy
+ */
+void cell_set_free(cell_set_t *set) {
+	free(set->keys);
+	cell_set_init(set);
+}
+
+
+/**
+ * @brief Usuwa wszystkie elementy zbioru @p set.
+ * Zostawia tablice kluczy, wiec nie alokuje ani nie zwalnia pamieci.
+ *
+ * @param[in,out] set   : zbior, ktory czyscimy
+ */
+void cell_set_clear(cell_set_t *set) {
+	if (set->size) {
+		memset(set->keys, 0, set->capacity * sizeof(uint64_t));
+		set->size = 0;
+	}
+}
+
+
+/**
+ * @brief Inicjalizuje zbior @p copy elementami zbioru @p set.
+ * Kopia ma taki sam rozmiar tablicy kluczy jak @p set.
+ *
+ * @param[out] copy : zbior, ktory inicjalizujemy
+ * @param[in] set   : kopiowany zbior
+ *
+ * @return true, gdy udalo sie zaalokowac pamiec, false w przeciwnym wypadku
+ * (wtedy @p copy jest pustym zbiorem).
+ */
+bool cell_set_copy(cell_set_t *copy, const cell_set_t *set) {
+	cell_set_init(copy);
+	if (!set->capacity) {
+		return true;
+	}
+
+	copy->keys = malloc(set->capacity * sizeof(uint64_t));
+	if (!copy->keys) {
+		return false;
+	}
+	memcpy(copy->keys, set->keys, set->capacity * sizeof(uint64_t));
+	copy->size = set->size;
+	copy->capacity = set->capacity;
+
+	return true;
+}
+
+
+/**
+ * @brief Zapewnia w zbiorze @p set miejsce na @p count nowych elementow, tak
+ * by ich dodanie nie wymagalo alokowania pamieci.
+ *
+ * @param[in,out] set   : zbior, w ktorym zapewniamy miejsce
+ * @param[in] count     : liczba nowych elementow
+ *
+ * @return true, gdy miejsce jest zapewnione, false gdy nie udalo sie
+ * zaalokowac pamieci; zbior pozostaje wtedy bez zmian.
+ */
+bool cell_set_reserve(cell_set_t *set, uint64_t count) {
+	uint64_t capacity = get_set_capacity(set->size + count);
+
+	return capacity <= set->capacity || rehash_set(set, capacity);
+}
+
+
+/**
+ * @brief Zmniejsza tablice kluczy zbioru @p set, gdy elementy zajmuja mniej
+ * niz 1/8 jej miejsc, zostawiajac miejsce na @p count nowych elementow.
+ * Zmniejszanie jest tylko optymalizacja, wiec gdy nie udalo sie zaalokowac
+ * pamieci, zbior pozostaje bez zmian.
+ *
+ * @param[in,out] set   : zbior, ktorego tablice zmniejszamy
+ * @param[in] count     : liczba nowych elementow
+ */
+void cell_set_shrink(cell_set_t *set, uint64_t count) {
+	uint64_t capacity = set->capacity;
+	while (
+		capacity > MIN_SET_CAPACITY &&
+		8 * set->size < capacity &&
+		2 * (set->size + count) <= capacity / 2
+	) {
+		capacity /= 2;
+	}
+
+	if (capacity < set->capacity) {
+		rehash_set(set, capacity);
+	}
+}
+
+
+/**
+ * @brief Sprawdza, czy @p key nalezy do zbioru @p set.
+ *
+ * @param[in] set   : zbior, ktory przeszukujemy
+ * @param[in] key   : szukany indeks pola
+ *
+ * @return true, gdy @p key nalezy do zbioru, false w przeciwnym wypadku.
+ */
+bool cell_set_contains(const cell_set_t *set, uint64_t key) {
+	if (!set->size) {
+		return false;
+	}
+
+	uint64_t slot = get_set_slot(key, set->capacity);
+	while (set->keys[slot]) {
+		if (set->keys[slot] == key + 1) {
+			return true;
+		}
+		slot = (slot + 1) & (set->capacity - 1);
+	}
+
+	return false;
+}
+
+
+/**
+ * @brief Dodaje @p key do zbioru @p set.
+ * Nie alokuje pamieci: miejsce na nowy element musi zostac wczesniej
+ * zapewnione przez @ref cell_set_reserve.
+ *
+ * @param[in,out] set   : zbior, do ktorego dodajemy
+ * @param[in] key       : dodawany indeks pola
+ *
+ * @return true, gdy @p key zostal dodany, false gdy juz nalezal do zbioru.
+ */
+bool cell_set_insert(cell_set_t *set, uint64_t key) {
+	uint64_t slot = get_set_slot(key, set->capacity);
+	while (set->keys[slot]) {
+		if (set->keys[slot] == key + 1) {
+			return false;
+		}
+		slot = (slot + 1) & (set->capacity - 1);
+	}
+
+	set->keys[slot] = key + 1;
+	set->size++;
+
+	return true;
+}
+
+
+/**
+ * @brief Usuwa @p key ze zbioru @p set.
+ * Przesuwa wstecz klucze z dalszej czesci ciagu probkowania, wiec tablica nie
+ * zawiera nagrobkow. Nie zmienia rozmiaru tablicy (patrz
+ * @ref cell_set_shrink).
+ *
+ * @param[in,out] set   : zbior, z ktorego usuwamy
+ * @param[in] key       : usuwany indeks pola
+ *
+ * @return true, gdy @p key zostal usuniety, false gdy nie nalezal do zbioru.
+ */
+bool cell_set_erase(cell_set_t *set, uint64_t key) {
+	if (!set->size) {
+		return false;
+	}
+
+	uint64_t mask = set->capacity - 1;
+	uint64_t slot = get_set_slot(key, set->capacity);
+	while (set->keys[slot] != key + 1) {
+		if (!set->keys[slot]) {
+			return false;
+		}
+		slot = (slot + 1) & mask;
+	}
+
+	uint64_t hole = slot;
+	uint64_t next = (hole + 1) & mask;
+	for (; set->keys[next]; next = (next + 1) & mask) {
+		uint64_t home = get_set_slot(set->keys[next] - 1, set->capacity);
+		// the key may fill the hole only if the hole lies on its probe path
+		if (((next - home) & mask) >= ((next - hole) & mask)) {
+			set->keys[hole] = set->keys[next];
+			hole = next;
+		}
+	}
+	set->keys[hole] = 0;
+	set->size--;
+
+	return true;
+}
+
+
+/**
+ * @brief Przechodzi po elementach zbioru @p set.
+ * Przed pierwszym wywolaniem @p position nalezy ustawic na 0. Zbioru nie
+ * wolno zmieniac w trakcie przechodzenia.
+ *
+ * @param[in] set           : zbior, po ktorym przechodzimy
+ * @param[in,out] position  : pozycja w tablicy kluczy
+ * @param[out] key          : kolejny element zbioru
+ *
+ * @return true, gdy znaleziono kolejny element, false gdy przejscie sie
+ * skonczylo.
+ */
+bool cell_set_next(const cell_set_t *set, uint64_t *position, uint64_t *key) {
+	while (*position < set->capacity) {
+		uint64_t stored = set->keys[(*position)++];
+		if (stored) {
+			*key = stored - 1;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/**
+ * @brief Zmienia rozmiar tablicy wpisow slownika @p map na @p capacity.
+ * Gdy nie udalo sie zaalokowac pamieci, slownik pozostaje bez zmian.
+ *
+ * @param[in,out] map   : slownik, ktorego tablice zmieniamy
+ * @param[in] capacity  : nowy rozmiar tablicy (potega dwojki)
+ *
+ * @return true, gdy rozmiar zostal zmieniony, false gdy nie udalo sie
+ * zaalokowac pamieci.
+ */
+bool rehash_map(field_map_t *map, uint64_t capacity) {
+	field_entry_t *entries = calloc(capacity, sizeof(field_entry_t));
+	if (!entries) {
+		return false;
+	}
+
+	for (uint64_t i = 0; i < map->capacity; i++) {
+		if (map->entries[i].key) {
+			uint64_t slot = get_set_slot(map->entries[i].key - 1, capacity);
+			while (entries[slot].key) {
+				slot = (slot + 1) & (capacity - 1);
+			}
+			entries[slot] = map->entries[i];
+		}
+	}
+
+	free(map->entries);
+	map->entries = entries;
+	map->capacity = capacity;
+
+	return true;
+}
+
+
+/**
+ * @brief Inicjalizuje pusty slownik @p map.
+ * Nie alokuje pamieci.
+ *
+ * @param[out] map  : slownik, ktory inicjalizujemy
+ */
+void field_map_init(field_map_t *map) {
+	map->entries = NULL;
+	map->size = 0;
+	map->capacity = 0;
+}
+
+
+/**
+ * @brief Zwalnia pamiec zaalokowana na slownik @p map.
+ *
+ * @param[in,out] map   : slownik, ktory zwalniamy
+ */
+void field_map_free(field_map_t *map) {
+	free(map->entries);
+	field_map_init(map);
+}
+
+
+/**
+ * @brief Inicjalizuje slownik @p copy wpisami slownika @p map.
+ * Kopia ma taki sam rozmiar tablicy wpisow jak @p map.
+ *
+ * @param[out] copy : slownik, ktory inicjalizujemy
+ * @param[in] map   : kopiowany slownik
+ *
+ * @return true, gdy udalo sie zaalokowac pamiec, false w przeciwnym wypadku
+ * (wtedy @p copy jest pustym slownikiem).
+ */
+bool field_map_copy(field_map_t *copy, const field_map_t *map) {
+	field_map_init(copy);
+	if (!map->capacity) {
+		return true;
+	}
+
+	copy->entries = malloc(map->capacity * sizeof(field_entry_t));
+	if (!copy->entries) {
+		return false;
+	}
+	memcpy(copy->entries, map->entries, map->capacity * sizeof(field_entry_t));
+	copy->size = map->size;
+	copy->capacity = map->capacity;
+
+	return true;
+}
+
+
+/**
+ * @brief Szuka w slowniku @p map wpisu pola o indeksie @p key.
+ *
+ * @param[in] map   : slownik, ktory przeszukujemy
+ * @param[in] key   : indeks pola
+ *
+ * @return Wskaznik na wpis lub NULL, gdy pola nie ma w slowniku. Wskaznik
+ * traci waznosc po dodaniu lub usunieciu wpisu.
+ */
+field_entry_t* field_map_find(const field_map_t *map, uint64_t key) {
+	if (!map->size) {
+		return NULL;
+	}
+
+	uint64_t slot = get_set_slot(key, map->capacity);
+	while (map->entries[slot].key) {
+		if (map->entries[slot].key == key + 1) {
+			return &map->entries[slot];
+		}
+		slot = (slot + 1) & (map->capacity - 1);
+	}
+
+	return NULL;
+}
+
+
+/**
+ * @brief Zapewnia w slowniku @p map miejsce na @p count nowych wpisow, tak by
+ * ich dodanie nie wymagalo alokowania pamieci.
+ *
+ * @param[in,out] map   : slownik, w ktorym zapewniamy miejsce
+ * @param[in] count     : liczba nowych wpisow
+ *
+ * @return true, gdy miejsce jest zapewnione, false gdy nie udalo sie
+ * zaalokowac pamieci; slownik pozostaje wtedy bez zmian.
+ */
+bool field_map_reserve(field_map_t *map, uint64_t count) {
+	uint64_t capacity = get_set_capacity(map->size + count);
+
+	return capacity <= map->capacity || rehash_map(map, capacity);
+}
+
+
+/**
+ * @brief Zmniejsza tablice wpisow slownika @p map, gdy wpisy zajmuja mniej
+ * niz 1/8 jej miejsc, zostawiajac miejsce na @p count nowych wpisow, tak jak
+ * @ref cell_set_shrink.
+ *
+ * @param[in,out] map   : slownik, ktorego tablice zmniejszamy
+ * @param[in] count     : liczba nowych wpisow
+ */
+void field_map_shrink(field_map_t *map, uint64_t count) {
+	uint64_t capacity = map->capacity;
+	while (
+		capacity > MIN_SET_CAPACITY &&
+		8 * map->size < capacity &&
+		2 * (map->size + count) <= capacity / 2
+	) {
+		capacity /= 2;
+	}
+
+	if (capacity < map->capacity) {
+		rehash_map(map, capacity);
+	}
+}
+
+
+/**
+ * @brief Zwraca wpis pola o indeksie @p key, dodajac do slownika @p map
+ * wyzerowany wpis, gdy pola w nim nie bylo.
+ * Nie alokuje pamieci: miejsce na nowy wpis musi zostac wczesniej zapewnione
+ * przez @ref field_map_reserve.
+ *
+ * @param[in,out] map   : slownik, w ktorym szukamy
+ * @param[in] key       : indeks pola
+ *
+ * @return Wskaznik na wpis. Wskaznik traci waznosc po dodaniu lub usunieciu
+ * wpisu.
+ */
+field_entry_t* field_map_get(field_map_t *map, uint64_t key) {
+	uint64_t slot = get_set_slot(key, map->capacity);
+	while (map->entries[slot].key) {
+		if (map->entries[slot].key == key + 1) {
+			return &map->entries[slot];
+		}
+		slot = (slot + 1) & (map->capacity - 1);
+	}
+
+	map->entries[slot].key = key + 1;
+	map->entries[slot].node = 0;
+	map->entries[slot].owner = 0;
+	map->size++;
+
+	return &map->entries[slot];
+}
+
+
+/**
+ * @brief Usuwa ze slownika @p map wpis pola o indeksie @p key.
+ * Przesuwa wstecz wpisy z dalszej czesci ciagu probkowania i nie zmienia
+ * rozmiaru tablicy, tak jak @ref cell_set_erase.
+ *
+ * @param[in,out] map   : slownik, z ktorego usuwamy
+ * @param[in] key       : indeks pola
+ */
+void field_map_erase(field_map_t *map, uint64_t key) {
+	if (!map->size) {
+		return;
+	}
+
+	uint64_t mask = map->capacity - 1;
+	uint64_t slot = get_set_slot(key, map->capacity);
+	while (map->entries[slot].key != key + 1) {
+		if (!map->entries[slot].key) {
+			return;
+		}
+		slot = (slot + 1) & mask;
+	}
+
+	uint64_t hole = slot;
+	uint64_t next = (hole + 1) & mask;
+	for (; map->entries[next].key; next = (next + 1) & mask) {
+		uint64_t home = get_set_slot(map->entries[next].key - 1, map->capacity);
+		if (((next - home) & mask) >= ((next - hole) & mask)) {
+			map->entries[hole] = map->entries[next];
+			hole = next;
+		}
+	}
+	map->entries[hole].key = 0;
+	map->size--;
+}
+
+
+/**
+ * @brief Przechodzi po wpisach slownika @p map.
+ * Przed pierwszym wywolaniem @p position nalezy ustawic na 0. Mozna zmieniac
+ * dane wpisow, ale nie wolno dodawac ani usuwac wpisow w trakcie przechodzenia.
+ *
+ * @param[in] map           : slownik, po ktorym przechodzimy
+ * @param[in,out] position  : pozycja w tablicy wpisow
+ *
+ * @return Wskaznik na kolejny wpis lub NULL, gdy przejscie sie skonczylo.
+ */
+field_entry_t* field_map_next(const field_map_t *map, uint64_t *position) {
+	while (*position < map->capacity) {
+		field_entry_t *entry = &map->entries[(*position)++];
+		if (entry->key) {
+			return entry;
+		}
+	}
+
+	return NULL;
+}
@@ -0,0 +1,284 @@
+/** @file
+ * Interfejs modulu zawierajacego zbior indeksow pol oraz slownik danych pol
+ * oparte na tablicach haszujacych z adresowaniem otwartym
+ *
+ * @author Piotr Prabucki <pp418377@students.mimuw.edu.pl>
+ */
+
+
+#ifndef HASH_UTIL_H
+#define HASH_UTIL_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/**
+ * @brief Zbior indeksow pol.
+ * Tablica haszujaca z adresowaniem otwartym i liniowym probkowaniem. Klucz
+ * jest trzymany powiekszony o 1, wiec 0 oznacza wolne miejsce. Dodawanie i
+ * usuwanie elementow nie alokuje pamieci: tablica jest powiekszana tylko
+ * przez @ref cell_set_reserve, a zmniejszana przez @ref cell_set_shrink, gdy
+ * zapelnienie spadnie ponizej 1/8, dzieki czemu przejscie po wszystkich
+ * elementach trwa czas proporcjonalny do ich liczby (nie mniej niz minimalny
+ * rozmiar tablicy).
+ *
+ * @param keys      : tablica kluczy
+ * @param size      : liczba elementow zbioru
+ * @param capacity  : rozmiar tablicy kluczy (potega dwojki lub 0)
+ */
+typedef struct cell_set {
+	uint64_t *keys;
+	uint64_t size;
+	uint64_t capacity;
+} cell_set_t;
+
+
+/**
+ * @brief Inicjalizuje pusty zbior @p set.
+ * Nie alokuje pamieci.
+ *
+ * @param[out] set  : zbior, ktory inicjalizujemy
+ */
+void cell_set_init(cell_set_t *set);
+
+
+/**
+ * @brief Zwalnia pamiec zaalokowana na zbior @p set.
+ *
+ * @param[in,out] set   : zbior, ktory zwalniamy
+ */
+void cell_set_free(cell_set_t *set);
+
+
+/**
+ * @brief Usuwa wszystkie elementy zbioru @p set.
+ * Zostawia tablice kluczy, wiec nie alokuje ani nie zwalnia pamieci.
+ *
+ * @param[in,out] set   : zbior, ktory czyscimy
+ */
+void cell_set_clear(cell_set_t *set);
+
+
+/**
+ * @brief Inicjalizuje zbior @p copy elementami zbioru @p set.
+ *
+ * @param[out] copy : zbior, ktory inicjalizujemy
+ * @param[in] set   : kopiowany zbior
+ *
+ * @return true, gdy udalo sie zaalokowac pamiec, false w przeciwnym wypadku
+ * (wtedy @p copy jest pustym zbiorem).
+ */
+bool cell_set_copy(cell_set_t *copy, const cell_set_t *set);
+
+
+/**
+ * @brief Zapewnia w zbiorze @p set miejsce na @p count nowych elementow, tak
+ * by ich dodanie nie wymagalo alokowania pamieci.
+ *
+ * @param[in,out] set   : zbior, w ktorym zapewniamy miejsce
+ * @param[in] count     : liczba nowych elementow
+ *
+ * @return true, gdy miejsce jest zapewnione, false gdy nie udalo sie
+ * zaalokowac pamieci; zbior pozostaje wtedy bez zmian.
+ */
+bool cell_set_reserve(cell_set_t *set, uint64_t count);
+
+
+/**
+ * @brief Zmniejsza tablice kluczy zbioru @p set, gdy elementy zajmuja mniej
+ * niz 1/8 jej miejsc, zostawiajac miejsce na @p count nowych elementow.
+ * Gdy nie udalo sie zaalokowac pamieci, zbior pozostaje bez zmian.
+ *
+ * @param[in,out] set   : zbior, ktorego tablice zmniejszamy
+ * @param[in] count     : liczba nowych elementow
+ */
+void cell_set_shrink(cell_set_t *set, uint64_t count);
+
+
+/**
+ * @brief Sprawdza, czy @p key nalezy do zbioru @p set.
+ *
+ * @param[in] set   : zbior, ktory przeszukujemy
+ * @param[in] key   : szukany indeks pola
+ *
+ * @return true, gdy @p key nalezy do zbioru, false w przeciwnym wypadku.
+ */
+bool cell_set_contains(const cell_set_t *set, uint64_t key);
+
+
+/**
+ * @brief Dodaje @p key do zbioru @p set.
+ * Nie alokuje pamieci: miejsce na nowy element musi zostac wczesniej
+ * zapewnione przez @ref cell_set_reserve.
+ *
+ * @param[in,out] set   : zbior, do ktorego dodajemy
+ * @param[in] key       : dodawany indeks pola
+ *
+ * @return true, gdy @p key zostal dodany, false gdy juz nalezal do zbioru.
+ */
+bool cell_set_insert(cell_set_t *set, uint64_t key);
+
+
+/**
+ * @brief Usuwa @p key ze zbioru @p set.
+ * Nie zmienia rozmiaru tablicy kluczy.
+ *
+ * @param[in,out] set   : zbior, z ktorego usuwamy
+ * @param[in] key       : usuwany indeks pola
+ *
+ * @return true, gdy @p key zostal usuniety, false gdy nie nalezal do zbioru.
+ */
+bool cell_set_erase(cell_set_t *set, uint64_t key);
+
+
+/**
+ * @brief Przechodzi po elementach zbioru @p set.
+ * Przed pierwszym wywolaniem @p position nalezy ustawic na 0. Zbioru nie
+ * wolno zmieniac w trakcie przechodzenia.
+ *
+ * @param[in] set           : zbior, po ktorym przechodzimy
+ * @param[in,out] position  : pozycja w tablicy kluczy
+ * @param[out] key          : kolejny element zbioru
+ *
+ * @return true, gdy znaleziono kolejny element, false gdy przejscie sie
+ * skonczylo.
+ */
+bool cell_set_next(const cell_set_t *set, uint64_t *position, uint64_t *key);
+
+
+/**
+ * @brief Dane zajetego pola przechowywane w slowniku @ref field_map_t.
+ *
+ * @param key   : indeks pola powiekszony o 1 (0 oznacza wolne miejsce)
+ * @param node  : numer wezla lasu obszarow
+ * @param owner : numer gracza zajmujacego pole
+ */
+typedef struct field_entry {
+	uint64_t key;
+	uint64_t node;
+	uint32_t owner;
+} field_entry_t;
+
+
+/**
+ * @brief Slownik przypisujacy indeksom pol ich dane.
+ * Tablica haszujaca z adresowaniem otwartym i liniowym probkowaniem, w ktorej
+ * pamiec zajmuja tylko pola obecne w slowniku.
+ *
+ * @param entries   : tablica wpisow
+ * @param size      : liczba wpisow slownika
+ * @param capacity  : rozmiar tablicy wpisow (potega dwojki lub 0)
+ */
+typedef struct field_map {
+	field_entry_t *entries;
+	uint64_t size;
+	uint64_t capacity;
+} field_map_t;
+
+
+/**
+ * @brief Inicjalizuje pusty slownik @p map.
+ * Nie alokuje pamieci.
+ *
+ * @param[out] map  : slownik, ktory inicjalizujemy
+ */
+void field_map_init(field_map_t *map);
+
+
+/**
+ * @brief Zwalnia pamiec zaalokowana na slownik @p map.
+ *
+ * @param[in,out] map   : slownik, ktory zwalniamy
+ */
+void field_map_free(field_map_t *map);
+
+
+/**
+ * @brief Inicjalizuje slownik @p copy wpisami slownika @p map.
+ *
+ * @param[out] copy : slownik, ktory inicjalizujemy
+ * @param[in] map   : kopiowany slownik
+ *
+ * @return true, gdy udalo sie zaalokowac pamiec, false w przeciwnym wypadku
+ * (wtedy @p copy jest pustym slownikiem).
+ */
+bool field_map_copy(field_map_t *copy, const field_map_t *map);
+
+
+/**
+ * @brief Szuka w slowniku @p map wpisu pola o indeksie @p key.
+ *
+ * @param[in] map   : slownik, ktory przeszukujemy
+ * @param[in] key   : indeks pola
+ *
+ * @return Wskaznik na wpis lub NULL, gdy pola nie ma w slowniku. Wskaznik
+ * traci waznosc po dodaniu lub usunieciu wpisu.
+ */
+field_entry_t* field_map_find(const field_map_t *map, uint64_t key);
+
+
+/**
+ * @brief Zapewnia w slowniku @p map miejsce na @p count nowych wpisow, tak by
+ * ich dodanie nie wymagalo alokowania pamieci.
+ *
+ * @param[in,out] map   : slownik, w ktorym zapewniamy miejsce
+ * @param[in] count     : liczba nowych wpisow
+ *
+ * @return true, gdy miejsce jest zapewnione, false gdy nie udalo sie
+ * zaalokowac pamieci; slownik pozostaje wtedy bez zmian.
+ */
+bool field_map_reserve(field_map_t *map, uint64_t count);
+
+
+/**
+ * @brief Zmniejsza tablice wpisow slownika @p map, gdy wpisy zajmuja mniej
+ * niz 1/8 jej miejsc, zostawiajac miejsce na @p count nowych wpisow.
+ * Gdy nie udalo sie zaalokowac pamieci, slownik pozostaje bez zmian.
+ *
+ * @param[in,out] map   : slownik, ktorego tablice zmniejszamy
+ * @param[in] count     : liczba nowych wpisow
+ */
+void field_map_shrink(field_map_t *map, uint64_t count);
+
+
+/**
+ * @brief Zwraca wpis pola o indeksie @p key, dodajac do slownika @p map
+ * wyzerowany wpis, gdy pola w nim nie bylo.
+ * Nie alokuje pamieci: miejsce na nowy wpis musi zostac wczesniej zapewnione
+ * przez @ref field_map_reserve.
+ *
+ * @param[in,out] map   : slownik, w ktorym szukamy
+ * @param[in] key       : indeks pola
+ *
+ * @return Wskaznik na wpis. Wskaznik traci waznosc po dodaniu lub usunieciu
+ * wpisu.
+ */
+field_entry_t* field_map_get(field_map_t *map, uint64_t key);
+
+
+/**
+ * @brief Usuwa ze slownika @p map wpis pola o indeksie @p key.
+ * Nie zmienia rozmiaru tablicy wpisow.
+ *
+ * @param[in,out] map   : slownik, z ktorego usuwamy
+ * @param[in] key       : indeks pola
+ */
+void field_map_erase(field_map_t *map, uint64_t key);
+
+
+/**
+ * @brief Przechodzi po wpisach slownika @p map.
+ * Przed pierwszym wywolaniem @p position nalezy ustawic na 0. Mozna zmieniac
+ * dane wpisow, ale nie wolno dodawac ani usuwac wpisow w trakcie przechodzenia.
+ *
+ * @param[in] map           : slownik, po ktorym przechodzimy
+ * @param[in,out] position  : pozycja w tablicy wpisow
+ *
+ * @return Wskaznik na kolejny wpis lub NULL, gdy przejscie sie skonczylo.
+ */
+field_entry_t* field_map_next(const field_map_t *map, uint64_t *position);
+
+
+#endif /* HASH_UTIL_H */
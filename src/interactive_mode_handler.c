@@ -12,7 +12,6 @@
 #include <termios.h>
 #include <sys/ioctl.h>
 #include "gamma.h"
-#include "array_util.h"
 
 
 /**
@@ -55,19 +54,19 @@ void print_board(
 	long long cursor_pos_x,
 	long long cursor_pos_y
 ) {
-	for (long long y = gamma->field_height - 1; y >= 0; y--) {
-		for (uint32_t x = 0; x < gamma->field_width; x++) {
+	for (long long y = gamma_height(gamma) - 1; y >= 0; y--) {
+		for (uint32_t x = 0; x < gamma_width(gamma); x++) {
 			// highlighting the cursor position
-			if (y == gamma->field_height - cursor_pos_y && x == cursor_pos_x) {
+			if (y == gamma_height(gamma) - cursor_pos_y && x == cursor_pos_x) {
 				printf("\033[46;1m");
 			}
-			else if (*get_arr_32(gamma->field, x, y) == player) {
+			else if (gamma_field_owner(gamma, x, y) == player) {
 				printf("\033[44;1m");
 			}
 
 			// printing the cell's value or '.' if its not occupied
-			if (*get_arr_32(gamma->field, x, y) > 0) {
-				printf("%*u", cell_size, *get_arr_32(gamma->field, x, y));
+			if (gamma_field_owner(gamma, x, y) > 0) {
+				printf("%*u", cell_size, gamma_field_owner(gamma, x, y));
 			} else {
 				char *dot = ".";
 				printf("%*s", cell_size, dot);
@@ -75,15 +74,15 @@ void print_board(
 
 			// ending the highlighting for the cursor
 			if (
-				(y == gamma->field_height - cursor_pos_y &&
+				(y == gamma_height(gamma) - cursor_pos_y &&
 					x == cursor_pos_x) ||
-				*get_arr_32(gamma->field, x, y) == player
+				gamma_field_owner(gamma, x, y) == player
 			) {
 				printf("\033[0m");
 			}
 
 			// adding a space if its not the last cell in the row
-			if (x != gamma->field_width - 1) {
+			if (x != gamma_width(gamma) - 1) {
 				printf(" ");
 			}
 		}
@@ -97,7 +96,7 @@ void print_board(
 		gamma_free_fields(gamma, player)
 	);
 	printf("GOLDEN MOVE: ");
-	if (gamma->players[player - 1]->used_golden_move) {
+	if (gamma_golden_used(gamma, player)) {
 		printf("UN");
 	}
 	printf("AVAILABLE\n");
@@ -320,12 +319,14 @@ void handle_interactive_input(
  */
 int validate_terminal_size(gamma_t *gamma) {
 	struct winsize info;
-    ioctl(STDOUT_FILENO, TIOCGWINSZ, &info);
+	if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &info) != 0) {
+		return 0;
+	}
 
-	int cell_size = get_cell_size(gamma->player_count) + 1;
+	int cell_size = get_cell_size(gamma_players(gamma)) + 1;
 
-	int game_width = cell_size * gamma->field_width - 1;
-	int game_height = gamma->field_height + 4;
+	int game_width = cell_size * gamma_width(gamma) - 1;
+	int game_height = gamma_height(gamma) + 4;
 
 	return info.ws_col > game_width && info.ws_row > game_height;
 }
@@ -0,0 +1,185 @@
+/** @file
+ * Porownanie wydajnosci ukladow planszy @ref GAMMA_LAYOUT_ROWS i
+ * @ref GAMMA_LAYOUT_BLOCKED na typowych obciazeniach silnika gry gamma
+ *
+ * @author Piotr Prabucki <pp418377@students.mimuw.edu.pl>
+ */
+
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "gamma.h"
+
+
+/**
+ * Bok planszy uzywanej w pomiarach (plansza ma ponad 10^7 pol).
+ */
+#define BENCH_SIDE 4096
+/**
+ * Liczba ruchow w pomiarze losowych ruchow.
+ */
+#define RANDOM_MOVES 4000000
+/**
+ * Liczba zlotych ruchow rozcinajacych waz w pomiarze rozcinania obszarow.
+ */
+#define SNAKE_CUTS 32
+
+
+/**
+ * @brief Zwraca czas w sekundach od ustalonej chwili.
+ *
+ * @return Czas w sekundach.
+ */
+double get_time(void) {
+	struct timespec now;
+	timespec_get(&now, TIME_UTC);
+
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+
+/**
+ * @brief Zwraca kolejna liczbe pseudolosowa (xorshift).
+ *
+ * @param[in,out] state : stan generatora, rozny od zera
+ *
+ * @return Liczba pseudolosowa.
+ */
+uint64_t next_random(uint64_t *state) {
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+
+	return *state;
+}
+
+
+/**
+ * @brief Tworzy gre na planszy @ref BENCH_SIDE x @ref BENCH_SIDE.
+ * Konczy program z kodem 1, gdy nie udalo sie jej utworzyc.
+ *
+ * @param[in] layout    : uklad pol planszy
+ * @param[in] players   : liczba graczy
+ *
+ * @return Wskaznik na strukture przechowujaca stan gry.
+ */
+gamma_t* new_bench_game(gamma_layout_t layout, uint32_t players) {
+	gamma_options_t options;
+	gamma_options_init(&options);
+	options.layout = layout;
+
+	gamma_t *g = gamma_new_ex(
+		BENCH_SIDE,
+		BENCH_SIDE,
+		players,
+		UINT32_MAX,
+		&options
+	);
+	if (!g) {
+		exit(1);
+	}
+
+	return g;
+}
+
+
+/**
+ * @brief Mierzy czas @ref RANDOM_MOVES ruchow w losowe pola, przeplatanych
+ * zapytaniami o liczbe wolnych pol.
+ *
+ * @param[in] layout    : uklad pol planszy
+ *
+ * @return Czas w sekundach.
+ */
+double bench_random_moves(gamma_layout_t layout) {
+	gamma_t *g = new_bench_game(layout, 8);
+	uint64_t state = 88172645463325252ull;
+	uint64_t free_fields = 0;
+
+	double start = get_time();
+	for (uint32_t i = 0; i < RANDOM_MOVES; i++) {
+		uint64_t r = next_random(&state);
+		uint32_t player = 1 + r % 8;
+		gamma_move(g, player, (r >> 8) % BENCH_SIDE, (r >> 32) % BENCH_SIDE);
+		free_fields += gamma_free_fields(g, player);
+	}
+	double time = get_time() - start;
+
+	gamma_delete(g);
+	if (!free_fields) {
+		printf("unexpected result\n");
+	}
+
+	return time;
+}
+
+
+/**
+ * @brief Mierzy czas budowania i rozcinania dlugiego obszaru.
+ * Gracz 1 zajmuje plansze wezem z pionowych kolumn polaczonych na przemian u
+ * gory i u dolu planszy, a nastepnie kolejni gracze zlotymi ruchami
+ * przecinaja kolumny, co wymusza przeszukiwanie rozcinanych czesci.
+ *
+ * @param[in] layout        : uklad pol planszy
+ * @param[out] fill_time    : czas budowania weza w sekundach
+ * @param[out] cut_time     : czas rozcinania weza w sekundach
+ */
+void bench_snake(gamma_layout_t layout, double *fill_time, double *cut_time) {
+	gamma_t *g = new_bench_game(layout, SNAKE_CUTS + 1);
+
+	double start = get_time();
+	for (uint32_t x = 0; x < BENCH_SIDE; x += 2) {
+		for (uint32_t y = 0; y < BENCH_SIDE; y++) {
+			gamma_move(g, 1, x, y);
+		}
+		if (x + 1 < BENCH_SIDE) {
+			gamma_move(g, 1, x + 1, (x / 2) % 2 ? 0 : BENCH_SIDE - 1);
+		}
+	}
+
+	*fill_time = get_time() - start;
+
+	uint64_t state = 2463534242ull;
+	start = get_time();
+	for (uint32_t player = 2; player <= SNAKE_CUTS + 1; player++) {
+		uint64_t r = next_random(&state);
+		uint32_t x = 2 * (r % (BENCH_SIDE / 2));
+		gamma_golden_move(g, player, x, 1 + (r >> 32) % (BENCH_SIDE - 2));
+	}
+	*cut_time = get_time() - start;
+
+	gamma_delete(g);
+}
+
+
+/**
+ * @brief Wypisuje czasy obciazen dla obu ukladow planszy.
+ *
+ * @return Zero.
+ */
+int main() {
+	printf("board %d x %d\n", BENCH_SIDE, BENCH_SIDE);
+	printf("%-16s %10s %10s\n", "workload", "rows [s]", "blocked [s]");
+	printf(
+		"%-16s %10.3f %10.3f\n",
+		"random moves",
+		bench_random_moves(GAMMA_LAYOUT_ROWS),
+		bench_random_moves(GAMMA_LAYOUT_BLOCKED)
+	);
+
+	double fill_time[2];
+	double cut_time[2];
+	bench_snake(GAMMA_LAYOUT_ROWS, &fill_time[0], &cut_time[0]);
+	bench_snake(GAMMA_LAYOUT_BLOCKED, &fill_time[1], &cut_time[1]);
+	printf(
+		"%-16s %10.3f %10.3f\n",
+		"column fill",
+		fill_time[0],
+		fill_time[1]
+	);
+	printf("%-16s %10.3f %10.3f\n", "snake cuts", cut_time[0], cut_time[1]);
+
+	return 0;
+}
@@ -1,94 +1,298 @@
 /** @file
  * Implementacja funkcji pomocniczych sluzacych do zarzadzania pamiecia
- * przy tablicach dwuwymiarowych
+ * przy tablicach przechowujacych dane pol planszy
  *
  * @author Piotr Prabucki <pp418377@students.mimuw.edu.pl>
  */
 
 
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+#include "memory_util.h"
 
 
 /**
- * @brief Tworzy dwuwymiarowa tablice.
- * Alokuje pamiec na dwuwymiarowa tablice typu uint32_t.
- * 
- * @param[in] n : drugi wymiar tablicy
- * @param[in] m : pierwszy wymiar tablicy
- * 
- * @return Wskaznik na tablice lub NULL, gdy nie udalo sie zaalokowac pamieci.
+ * Wspolny wyzerowany kafelek, na ktory wskazuja kafelki tablic, do ktorych
+ * nic nie zapisano. Jego licznik odwolan jest zawsze rowny 0, wiec zapis do
+ * niego zawsze przechodzi przez @ref make_tile_writable.
  */
-uint32_t** allocate_2d_array_uint32(uint64_t n, uint64_t m) {
-	uint32_t **arr = (uint32_t**)calloc(n, sizeof(uint32_t*));
-	if (!arr) {
-		return NULL;
+static cell_tile_t zero_tile;
+
+
+/**
+ * @brief Zwraca liczbe kafelkow potrzebnych na @p length komorek.
+ *
+ * @param[in] length    : liczba komorek tablicy
+ *
+ * @return Liczba kafelkow.
+ */
+uint64_t get_tile_count(uint64_t length) {
+	return (length + TILE_MASK) >> TILE_SHIFT;
+}
+
+
+/**
+ * @brief Zwraca liczbe bajtow, ktore zajmuje kafelek tablicy @p arr.
+ *
+ * @param[in] arr   : tablica
+ *
+ * @return Rozmiar kafelka w bajtach.
+ */
+size_t get_tile_size(const cell_array_t *arr) {
+	return offsetof(cell_tile_t, data) + TILE_CELLS * arr->cell_size;
+}
+
+
+/**
+ * @brief Oddaje kafelek @p tile, zwalniajac go, gdy nie uzywa go juz zadna
+ * tablica.
+ *
+ * @param[in,out] tile  : kafelek, ktorego juz nie uzywamy
+ */
+void release_tile(cell_tile_t *tile) {
+	if (
+		tile != &zero_tile &&
+		atomic_fetch_sub_explicit(&tile->references, 1, memory_order_acq_rel)
+			== 1
+	) {
+		free(tile);
 	}
+}
 
-	uint32_t *arr_data = calloc(n * m, sizeof(uint32_t));
-	if (!arr_data) {
-		free(arr);
-		return NULL;
+
+/**
+ * @brief Zwraca najmniejszy rozmiar komorki (w bajtach), w ktorym miesci sie
+ * kazda wartosc z przedzialu [0, @p max_value].
+ *
+ * @param[in] max_value : najwieksza wartosc, jaka bedzie trzymana w tablicy
+ *
+ * @return Rozmiar komorki: 1, 2, 4 lub 8.
+ */
+uint8_t get_cell_width(uint64_t max_value) {
+	if (max_value <= UINT8_MAX) {
+		return 1;
+	}
+	if (max_value <= UINT16_MAX) {
+		return 2;
+	}
+	if (max_value <= UINT32_MAX) {
+		return 4;
 	}
+	return 8;
+}
+
+
+/**
+ * @brief Tworzy wyzerowana tablice @p arr.
+ * Alokuje pamiec tylko na wskazniki kafelkow, ustawione na wspolny
+ * wyzerowany kafelek; kafelki dostaja pamiec przy pierwszym zapisie.
+ *
+ * @param[out] arr      : tablica, ktora inicjalizujemy
+ * @param[in] length    : liczba komorek tablicy
+ * @param[in] cell_size : rozmiar komorki w bajtach (1, 2, 4 lub 8)
+ *
+ * @return true, gdy udalo sie zaalokowac pamiec, false w przeciwnym wypadku.
+ */
+bool allocate_cell_array(cell_array_t *arr, uint64_t length, uint8_t cell_size) {
+	arr->cell_size = cell_size;
+	arr->length = 0;
+	arr->tiles = NULL;
+
+	return resize_cell_array(arr, length);
+}
 
-	for(uint32_t i = 0; i < n; i++) {
-		arr[i] = arr_data + i * m;
+
+/**
+ * @brief Zmienia liczbe komorek tablicy @p arr na @p length.
+ * Nowe komorki sa wyzerowane. Kafelki nie sa przenoszone, wiec czas
+ * dzialania zalezy tylko od liczby kafelkow.
+ *
+ * @param[in,out] arr   : tablica stworzona w @ref allocate_cell_array
+ * @param[in] length    : nowa liczba komorek tablicy
+ *
+ * @return true, gdy udalo sie zaalokowac pamiec, false w przeciwnym wypadku
+ * (wtedy tablica pozostaje niezmieniona).
+ */
+bool resize_cell_array(cell_array_t *arr, uint64_t length) {
+	uint64_t old_count = get_tile_count(arr->length);
+	uint64_t count = get_tile_count(length);
+	if (count > SIZE_MAX / sizeof(cell_tile_t*)) {
+		return false;
+	}
+
+	// cells cut off from the last tile must read as zero when it grows back;
+	// the tile is made writable first, so a failed copy changes nothing
+	uint64_t tail = length & TILE_MASK;
+	if (length < arr->length && tail && arr->tiles[count - 1] != &zero_tile) {
+		cell_tile_t *tile = make_tile_writable(arr, count - 1);
+		if (!tile) {
+			return false;
+		}
+		memset(
+			(char*)tile->data + tail * arr->cell_size,
+			0,
+			(TILE_CELLS - tail) * arr->cell_size
+		);
+	}
+
+	if (count > old_count) {
+		cell_tile_t **tiles = realloc(arr->tiles, count * sizeof(cell_tile_t*));
+		if (!tiles) {
+			return false;
+		}
+		for (uint64_t i = old_count; i < count; i++) {
+			tiles[i] = &zero_tile;
+		}
+		arr->tiles = tiles;
+	}
+	else if (count < old_count) {
+		for (uint64_t i = count; i < old_count; i++) {
+			release_tile(arr->tiles[i]);
+		}
+		if (count == 0) {
+			free(arr->tiles);
+			arr->tiles = NULL;
+		}
+		else {
+			// a failed shrink leaves the larger block, which is still valid
+			cell_tile_t **tiles =
+				realloc(arr->tiles, count * sizeof(cell_tile_t*));
+			if (tiles) {
+				arr->tiles = tiles;
+			}
+		}
 	}
 
-  	return arr;
+	arr->length = length;
+
+	return true;
 }
 
 
 /**
- * @brief Tworzy dwuwymiarowa tablice.
- * Alokuje pamiec na dwuwymiarowa tablice typu uint64_t.
- * 
- * @param[in] n : drugi wymiar tablicy
- * @param[in] m : pierwszy wymiar tablicy
- * 
- * @return Wskaznik na tablice lub NULL, gdy nie udalo sie zaalokowac pamieci.
+ * @brief Tworzy tablice @p copy o tej samej zawartosci co @p arr.
+ * Kafelki sa wspoldzielone przez obie tablice, wiec czas dzialania i
+ * zajeta pamiec sa proporcjonalne do liczby kafelkow, a nie komorek.
+ *
+ * @param[out] copy : tablica, ktora inicjalizujemy
+ * @param[in] arr   : tablica stworzona w @ref allocate_cell_array
+ *
+ * @return true, gdy udalo sie zaalokowac pamiec, false w przeciwnym wypadku.
  */
-uint64_t** allocate_2d_array_uint64(uint64_t n, uint64_t m) {
-	uint64_t **arr = (uint64_t**)calloc(n, sizeof(uint64_t*));
-	if (!arr) {
-		return NULL;
+bool share_cell_array(cell_array_t *copy, const cell_array_t *arr) {
+	uint64_t count = get_tile_count(arr->length);
+
+	copy->cell_size = arr->cell_size;
+	copy->length = arr->length;
+	copy->tiles = NULL;
+	if (count == 0) {
+		return true;
+	}
+
+	copy->tiles = malloc(count * sizeof(cell_tile_t*));
+	if (!copy->tiles) {
+		return false;
+	}
+
+	for (uint64_t i = 0; i < count; i++) {
+		cell_tile_t *tile = arr->tiles[i];
+		if (tile != &zero_tile) {
+			atomic_fetch_add_explicit(
+				&tile->references,
+				1,
+				memory_order_relaxed
+			);
+		}
+		copy->tiles[i] = tile;
 	}
 
-	uint64_t *arr_data = calloc(n * m, sizeof(uint64_t));
-	if (!arr_data) {
-		free(arr);
+	return true;
+}
+
+
+/**
+ * @brief Zapewnia, ze kafelek o numerze @p tile tablicy @p arr nalezy tylko
+ * do niej.
+ * Kopiuje kafelek wspoldzielony z inna tablica, a w miejsce wspolnego
+ * wyzerowanego kafelka alokuje nowy.
+ *
+ * @param[in,out] arr   : tablica, do ktorej bedziemy zapisywac
+ * @param[in] tile      : numer kafelka
+ *
+ * @return Wskaznik na kafelek, do ktorego mozna zapisywac, lub NULL, gdy nie
+ * udalo sie zaalokowac pamieci; tablica pozostaje wtedy bez zmian.
+ */
+cell_tile_t* make_tile_writable(cell_array_t *arr, uint64_t tile) {
+	cell_tile_t *old_tile = arr->tiles[tile];
+	if (
+		atomic_load_explicit(&old_tile->references, memory_order_acquire) == 1
+	) {
+		return old_tile;
+	}
+
+	cell_tile_t *new_tile;
+	if (old_tile == &zero_tile) {
+		new_tile = calloc(1, get_tile_size(arr));
+	}
+	else {
+		new_tile = malloc(get_tile_size(arr));
+	}
+	if (!new_tile) {
 		return NULL;
 	}
 
-	for(uint32_t i = 0; i < n; i++) {
-		arr[i] = arr_data + i * m;
+	if (old_tile != &zero_tile) {
+		memcpy(new_tile->data, old_tile->data, TILE_CELLS * arr->cell_size);
+		release_tile(old_tile);
 	}
+	atomic_init(&new_tile->references, 1);
+	arr->tiles[tile] = new_tile;
 
-  	return arr;
+	return new_tile;
 }
 
 
 /**
- * @brief Zwalnia pamiec zaalokowana na tablice [arr].
- * Tablica jest typu uint32_t.
- * 
- * @param[in] arr   : tablica dwuwymiarowa, stworzona w
- *                    @ref allocate_2d_array_uint32
+ * @brief Zapewnia, ze wszystkie kafelki tablicy @p arr, do ktorych cos
+ * zapisano, naleza tylko do niej (patrz @ref make_tile_writable).
+ * Kafelki wskazujace na wspolny wyzerowany kafelek pozostaja bez zmian.
+ *
+ * @param[in,out] arr   : tablica, do ktorej bedziemy zapisywac
+ *
+ * @return true, gdy udalo sie zaalokowac pamiec, false w przeciwnym wypadku
+ * (wtedy czesc kafelkow moze byc juz skopiowana, ale zawartosc tablicy sie
+ * nie zmienia).
  */
-void free_2d_array_uint32(uint32_t **arr) {
-	free(arr[0]);
-	free(arr);
+bool unshare_cell_array(cell_array_t *arr) {
+	uint64_t count = get_tile_count(arr->length);
+	for (uint64_t i = 0; i < count; i++) {
+		if (arr->tiles[i] != &zero_tile && !make_tile_writable(arr, i)) {
+			return false;
+		}
+	}
+
+	return true;
 }
 
 
 /**
- * @brief Zwalnia pamiec zaalokowana na tablice [arr].
- * Tablica jest typu uint64_t.
- * 
- * @param[in] arr   : tablica dwuwymiarowa, stworzona w
- *                    @ref allocate_2d_array_uint64
+ * @brief Zwalnia pamiec zaalokowana na tablice @p arr.
+ * Wspoldzielone kafelki sa zwalniane dopiero przez ostatnia uzywajaca ich
+ * tablice.
+ *
+ * @param[in,out] arr   : tablica stworzona w @ref allocate_cell_array
  */
-void free_2d_array_uint64(uint64_t **arr) {
-	free(arr[0]);
-	free(arr);
+void free_cell_array(cell_array_t *arr) {
+	uint64_t count = get_tile_count(arr->length);
+	for (uint64_t i = 0; i < count; i++) {
+		release_tile(arr->tiles[i]);
+	}
+
+	free(arr->tiles);
+	arr->tiles = NULL;
+	arr->length = 0;
 }
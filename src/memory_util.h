@@ -1,6 +1,6 @@
 /** @file
  * Interfejs modulu zawierajacego funkcje pomocnicze sluzace do zarzadzania
- * pamiecia przy tablicach dwuwymiarowych
+ * pamiecia przy tablicach przechowujacych dane pol planszy
  *
  * @author Piotr Prabucki <pp418377@students.mimuw.edu.pl>
  */
@@ -10,52 +10,151 @@
 #define MEMORY_UTIL_H
 
 
+#include <stdatomic.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
 
 
 /**
- * @brief Tworzy dwuwymiarowa tablice.
- * Alokuje pamiec na dwuwymiarowa tablice typu uint32_t.
- * 
- * @param[in] n : drugi wymiar tablicy
- * @param[in] m : pierwszy wymiar tablicy
- * 
- * @return Wskaznik na tablice lub NULL, gdy nie udalo sie zaalokowac pamieci.
+ * Logarytm dwojkowy liczby komorek w kafelku tablicy.
  */
-uint32_t** allocate_2d_array_uint32(int n, int m);
+#define TILE_SHIFT 12
+/**
+ * Liczba komorek w kafelku tablicy.
+ */
+#define TILE_CELLS ((uint64_t)1 << TILE_SHIFT)
+/**
+ * Maska indeksu komorki wewnatrz kafelka.
+ */
+#define TILE_MASK (TILE_CELLS - 1)
+
+
+/**
+ * @brief Kafelek tablicy @ref cell_array_t.
+ * Kafelek moze byc wspoldzielony przez kilka tablic (patrz
+ * @ref share_cell_array). Pamiec jest alokowana tylko na @ref TILE_CELLS
+ * komorek o rozmiarze komorki tablicy, a nie na cala tablice [data].
+ *
+ * @param references    : liczba tablic uzywajacych kafelka
+ * @param data          : komorki kafelka
+ */
+typedef struct cell_tile {
+	atomic_uint_fast64_t references;
+	uint64_t data[TILE_CELLS];
+} cell_tile_t;
+
+
+/**
+ * @brief Tablica o zmiennej szerokosci komorki, podzielona na kafelki.
+ * Przechowuje wartosci indeksowane liniowo w kafelkach po @ref TILE_CELLS
+ * komorek. Szerokosc komorki (1, 2, 4 lub 8 bajtow) jest wybierana przy
+ * tworzeniu tablicy tak, by byla najmniejsza mieszczaca wszystkie wartosci,
+ * jakie beda w niej trzymane. Kafelki, do ktorych nic nie zapisano, wskazuja
+ * na wspolny wyzerowany kafelek i nie zajmuja pamieci, a kafelki
+ * wspoldzielone z inna tablica sa kopiowane przy pierwszym zapisie.
+ *
+ * @param cell_size : rozmiar komorki w bajtach
+ * @param length    : liczba komorek tablicy
+ * @param tiles     : tablica wskaznikow na kafelki
+ */
+typedef struct cell_array {
+	uint8_t cell_size;
+	uint64_t length;
+	cell_tile_t **tiles;
+} cell_array_t;
 
 
 /**
- * @brief Tworzy dwuwymiarowa tablice.
- * Alokuje pamiec na dwuwymiarowa tablice typu uint64_t.
- * 
- * @param[in] n : drugi wymiar tablicy
- * @param[in] m : pierwszy wymiar tablicy
- * 
- * @return Wskaznik na tablice lub NULL, gdy nie udalo sie zaalokowac pamieci.
+ * @brief Zwraca najmniejszy rozmiar komorki (w bajtach), w ktorym miesci sie
+ * kazda wartosc z przedzialu [0, @p max_value].
+ *
+ * @param[in] max_value : najwieksza wartosc, jaka bedzie trzymana w tablicy
+ *
+ * @return Rozmiar komorki: 1, 2, 4 lub 8.
  */
-uint64_t** allocate_2d_array_uint64(int n, int m);
+uint8_t get_cell_width(uint64_t max_value);
 
 
 /**
- * @brief Zwalnia pamiec zaalokowana na tablice [arr].
- * Tablica jest typu uint32_t.
- * 
- * @param[in] arr   : tablica dwuwymiarowa, stworzona w
- *                    @ref allocate_2d_array_uint32
+ * @brief Tworzy wyzerowana tablice @p arr.
+ * Alokuje pamiec tylko na wskazniki kafelkow; kafelki dostaja pamiec przy
+ * pierwszym zapisie.
+ *
+ * @param[out] arr      : tablica, ktora inicjalizujemy
+ * @param[in] length    : liczba komorek tablicy
+ * @param[in] cell_size : rozmiar komorki w bajtach (1, 2, 4 lub 8)
+ *
+ * @return true, gdy udalo sie zaalokowac pamiec, false w przeciwnym wypadku.
  */
-void free_2d_array_uint32(uint32_t **arr);
+bool allocate_cell_array(cell_array_t *arr, uint64_t length, uint8_t cell_size);
 
 
 /**
- * @brief Zwalnia pamiec zaalokowana na tablice [arr].
- * Tablica jest typu uint64_t.
- * 
- * @param[in] arr   : tablica dwuwymiarowa, stworzona w
- *                    @ref allocate_2d_array_uint64
+ * @brief Zmienia liczbe komorek tablicy @p arr na @p length.
+ * Nowe komorki sa wyzerowane.
+ *
+ * @param[in,out] arr   : tablica stworzona w @ref allocate_cell_array
+ * @param[in] length    : nowa liczba komorek tablicy
+ *
+ * @return true, gdy udalo sie zaalokowac pamiec, false w przeciwnym wypadku
+ * (wtedy tablica pozostaje niezmieniona).
+ */
+bool resize_cell_array(cell_array_t *arr, uint64_t length);
+
+
+/**
+ * @brief Tworzy tablice @p copy o tej samej zawartosci co @p arr.
+ * Kafelki sa wspoldzielone przez obie tablice, wiec czas dzialania i
+ * zajeta pamiec sa proporcjonalne do liczby kafelkow, a nie komorek.
+ * Zapis do wspoldzielonego kafelka kopiuje go (patrz
+ * @ref make_tile_writable).
+ *
+ * @param[out] copy : tablica, ktora inicjalizujemy
+ * @param[in] arr   : tablica stworzona w @ref allocate_cell_array
+ *
+ * @return true, gdy udalo sie zaalokowac pamiec, false w przeciwnym wypadku.
+ */
+bool share_cell_array(cell_array_t *copy, const cell_array_t *arr);
+
+
+/**
+ * @brief Zapewnia, ze kafelek o numerze @p tile tablicy @p arr nalezy tylko
+ * do niej.
+ * Kopiuje kafelek wspoldzielony z inna tablica, a w miejsce wspolnego
+ * wyzerowanego kafelka alokuje nowy.
+ *
+ * @param[in,out] arr   : tablica, do ktorej bedziemy zapisywac
+ * @param[in] tile      : numer kafelka
+ *
+ * @return Wskaznik na kafelek, do ktorego mozna zapisywac, lub NULL, gdy nie
+ * udalo sie zaalokowac pamieci; tablica pozostaje wtedy bez zmian.
+ */
+cell_tile_t* make_tile_writable(cell_array_t *arr, uint64_t tile);
+
+
+/**
+ * @brief Zapewnia, ze wszystkie kafelki tablicy @p arr, do ktorych cos
+ * zapisano, naleza tylko do niej (patrz @ref make_tile_writable).
+ * Kafelki wskazujace na wspolny wyzerowany kafelek pozostaja bez zmian.
+ *
+ * @param[in,out] arr   : tablica, do ktorej bedziemy zapisywac
+ *
+ * @return true, gdy udalo sie zaalokowac pamiec, false w przeciwnym wypadku
+ * (wtedy czesc kafelkow moze byc juz skopiowana, ale zawartosc tablicy sie
+ * nie zmienia).
+ */
+bool unshare_cell_array(cell_array_t *arr);
+
+
+/**
+ * @brief Zwalnia pamiec zaalokowana na tablice @p arr.
+ * Wspoldzielone kafelki sa zwalniane dopiero przez ostatnia uzywajaca ich
+ * tablice.
+ *
+ * @param[in,out] arr   : tablica stworzona w @ref allocate_cell_array
  */
-void free_2d_array_uint64(uint64_t **arr);
+void free_cell_array(cell_array_t *arr);
 
 
 #endif /* MEMORY_UTIL_H */
@@ -5,12 +5,18 @@
  */
 
 
+#include <errno.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 #include "parser.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 
 /**
  * @brief Sprawdza, czy @p c jest dozwolonym bialym znakiem.
@@ -26,157 +32,284 @@ int check_white_character(char c) {
 
 
 /**
- * @brief Sprawdza, czy @p instruction zawiera niedozwolone biale znaki.
+ * @brief Sprawdza, czy @p c oddziela slowa polecenia.
  * 
- * @param[in] instruction   : wskaznik na poczatek napisu
- * @param[in] size          : dlugosc napisu
+ * @param[in] c : znak, ktory sprawdzamy
  * 
- * @return Gdy w napisie sa niedozwolone biale znaki zwraca 1, w przeciwnym
+ * @return Jesli @p c jest dozwolonym bialym znakiem zwraca 1, w przeciwnym
  * wypadku 0.
  */
-int check_for_illegal_signs(char *instruction, int size) {
-	unsigned char c;
-	for (int i = 0; i < size; i++) {
-		c = instruction[i];
-		if (c < 32 && c != 9 && c != 11 && c != 12 && c != 13) {
-			return 1;
-		}
-	}
-	return 0;
+int is_delimiter(char c) {
+	return c == ' ' || c == '\t' || c == '\v' || c == '\f' || c == '\r';
 }
 
 
 /**
- * @brief Czyta linie ze standardowego wejscia.
- * Wczytuje linie (zatrzymuje sie na '\n' lub EOF).
- * Dynamicznie alokuje pamiec, tak by starczylo jej do wczytania wejscia.
- * Ustawia wskaznik @p line tam, gdzie zostala zaalokowana pamiec.
+ * @brief Sprawdza, czy znak @p c konczy linie lub jest znakiem sterujacym.
  * 
- * @param[in,out] line      : wskaznik na wczytywana linie
- * @param[in] buffer_size   : wstepny rozmiar bufora
+ * @param[in] c : znak, ktory sprawdzamy
  * 
- * @return Zwraca dlugosc linii, gdy wejscie mialo poprawny format.
- * Zwracane wartosci w przeciwnym wypadku:
- * 0 (pusta linia konczaca sie '\n')
- * -1 (pierwszy wczytany znak to EOF)
- * -2 (niepusta linia konczaca sie EOF)
+ * @return Jesli @p c jest znakiem o kodzie mniejszym niz 32 lub bajtem 0xFF
+ * zwraca 1, w przeciwnym wypadku 0.
  */
-int read_line(char **line, int buffer_size) {
-	int size = 0;
-
-	while (1) {
-		char input = 0;
+int is_special_character(char c) {
+	return (unsigned char)c < 32 || (unsigned char)c == 0xFF;
+}
 
-		for (;size < buffer_size - 1; size++) {
-			input = getchar();
 
-			if (input == EOF && !size) {
-				return -1;
-			}
-			if (input == EOF && size) {
-				return -2;
+/**
+ * @brief Wyszukuje koniec linii w napisie od @p begin do @p end.
+ * Linie konczy znak '\n' lub bajt 0xFF. Po drodze sprawdza, czy linia
+ * zawiera niedozwolone znaki sterujace (o kodzie mniejszym niz 32, poza
+ * dozwolonymi bialymi znakami). Przy SSE2 znaki sa sprawdzane po 16 naraz, a
+ * pojedynczo rozpatrywane sa tylko znaki sterujace.
+ * 
+ * @param[in] begin     : poczatek przeszukiwanego napisu
+ * @param[in] end       : koniec przeszukiwanego napisu
+ * @param[in,out] illegal   : ustawiany na @p true, gdy w przeszukanej czesci
+ *                            linii byl niedozwolony znak
+ * 
+ * @return Wskaznik na znak konczacy linie lub NULL, gdy napis sie skonczyl.
+ */
+char *find_line_end(char *begin, char *end, bool *illegal) {
+	char *c = begin;
+
+#ifdef __SSE2__
+	const __m128i control = _mm_set1_epi8(31);
+	const __m128i eof = _mm_set1_epi8((char)0xFF);
+	for (; end - c >= 16; c += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i*)c);
+		// bajt jest mniejszy niz 32 wtedy i tylko wtedy, gdy max(bajt, 31) = 31
+		__m128i special = _mm_or_si128(
+			_mm_cmpeq_epi8(_mm_max_epu8(v, control), control),
+			_mm_cmpeq_epi8(v, eof)
+		);
+		unsigned mask = _mm_movemask_epi8(special);
+		for (; mask; mask &= mask - 1) {
+			char *found = c + __builtin_ctz(mask);
+			if (*found == '\n' || *found == (char)0xFF) {
+				return found;
 			}
-			if (input == '\n') {
-				(*line)[size] = 0;
-				return size;
+			if (!check_white_character(*found)) {
+				*illegal = true;
 			}
+		}
+	}
+#endif
 
-			(*line)[size] = input;
+	for (; c < end; c++) {
+		if (!is_special_character(*c)) {
+			continue;
+		}
+		if (*c == '\n' || *c == (char)0xFF) {
+			return c;
+		}
+		if (!check_white_character(*c)) {
+			*illegal = true;
 		}
+	}
+
+	return NULL;
+}
 
-		buffer_size *= 2;
 
-		char *new_alloc = realloc(*line, buffer_size);
+/**
+ * @brief Wczytuje do bufora [reader] kolejny kawalek wejscia.
+ * Przesuwa nieprzetworzone dane na poczatek bufora, a gdy bufor jest caly
+ * zajety przez jedna linie, podwaja jego rozmiar. Ustawia
+ * @ref command_reader_t.eof, gdy wejscie sie skonczylo lub nie udalo sie z
+ * niego czytac. Konczy program z kodem 1, gdy nie udalo sie zaalokowac
+ * pamieci.
+ * 
+ * @param[in,out] reader    : bufor, do ktorego czytamy
+ */
+void fill_reader(command_reader_t *reader) {
+	if (reader->start > 0) {
+		memmove(reader->buffer, reader->buffer + reader->start,
+			reader->end - reader->start);
+		reader->end -= reader->start;
+		reader->scanned -= reader->start;
+		reader->start = 0;
+	}
+
+	if (reader->end == reader->capacity) {
+		char *new_alloc = realloc(reader->buffer, 2 * reader->capacity);
 		if (!new_alloc) {
 			exit(1);
 		}
-		*line = new_alloc;
+		reader->buffer = new_alloc;
+		reader->capacity *= 2;
+	}
+
+	while (1) {
+		ssize_t count = read(reader->fd, reader->buffer + reader->end,
+			reader->capacity - reader->end);
+		if (count < 0 && errno == EINTR) {
+			continue;
+		}
+		if (count <= 0) {
+			reader->eof = true;
+			return;
+		}
+
+		reader->end += count;
+		return;
 	}
 }
 
 
 /**
- * @brief Konstruktor typu @ref command_t.
- * Alokuje pamiec na strukture.
+ * @brief Wyszukuje w buforze [reader] nastepna linie wejscia.
+ * Linia konczy sie znakiem '\n', ktory jest zastepowany znakiem 0, lub
+ * koncem wejscia. Tak jak przy czytaniu funkcja getchar() do zmiennej typu
+ * char, bajt 0xFF jest traktowany jak koniec wejscia i konczy linie. Przy
+ * okazji ustawia @ref command_reader_t.illegal, gdy linia zawiera
+ * niedozwolone znaki sterujace.
  * 
- * @param[in] command_type  : typ polecenia, ktory tworzymy
+ * @param[in,out] reader    : bufor, z ktorego czytamy
+ * @param[out] line         : wskaznik na poczatek linii w buforze
  * 
- * @return Wskaznik na nowa, pusta strukture @ref command_t.
+ * @return Zwraca dlugosc linii, gdy wejscie mialo poprawny format.
+ * Zwracane wartosci w przeciwnym wypadku:
+ * 0 (pusta linia konczaca sie '\n')
+ * -1 (pierwszy wczytany znak to EOF)
+ * -2 (niepusta linia konczaca sie EOF)
  */
-command_t *create_new_command(command_type_t command_type) {
-	command_t *new_command = malloc(sizeof(command_t));
-	if (!new_command) {
-		exit(1);
+int next_line(command_reader_t *reader, char **line) {
+	while (1) {
+		char *stop = find_line_end(reader->buffer + reader->scanned,
+			reader->buffer + reader->end, &reader->illegal);
+
+		if (stop) {
+			*line = reader->buffer + reader->start;
+			int size = stop - *line;
+			bool newline = *stop == '\n';
+			*stop = 0;
+			reader->start = reader->scanned = stop - reader->buffer + 1;
+			if (newline) {
+				return size;
+			}
+			return size ? -2 : -1;
+		}
+
+		reader->scanned = reader->end;
+		if (reader->eof) {
+			*line = reader->buffer + reader->start;
+			int size = reader->end - reader->start;
+			reader->start = reader->end;
+			if (!size) {
+				// za wczytanymi danymi moze nie byc miejsca na znak 0
+				static char empty_line[1];
+				*line = empty_line;
+			}
+			return size ? -2 : -1;
+		}
+
+		fill_reader(reader);
 	}
+}
 
-	new_command->command_type = command_type;
-	new_command->arg_count = 0;
+
+/**
+ * @brief Ustawia polecenie [command] na puste polecenie typu [command_type].
+ * 
+ * @param[out] command      : polecenie, ktore ustawiamy
+ * @param[in] command_type  : typ polecenia
+ */
+void set_command(command_t *command, command_type_t command_type) {
+	command->command_type = command_type;
+	command->arg_count = 0;
 
 	for (int i = 0; i < 4; i++) {
-		new_command->args[i] = 0;
+		command->args[i] = 0;
 	}
+}
+
 
-	return new_command;
+/**
+ * @brief Inicjalizuje bufor @p reader czytajacy z deskryptora @p fd.
+ * Konczy program z kodem 1, gdy nie udalo sie zaalokowac pamieci.
+ * 
+ * @param[out] reader   : inicjalizowany bufor
+ * @param[in] fd        : deskryptor pliku, z ktorego czytamy
+ */
+void command_reader_init(command_reader_t *reader, int fd) {
+	reader->buffer = malloc(BUFFER_SIZE);
+	if (!reader->buffer) {
+		exit(1);
+	}
+
+	reader->fd = fd;
+	reader->capacity = BUFFER_SIZE;
+	reader->start = 0;
+	reader->scanned = 0;
+	reader->end = 0;
+	reader->eof = false;
+	reader->illegal = false;
 }
 
 
 /**
- * @brief Zwalnia pamiec zaalokowana na polecenie @p command.
+ * @brief Zwalnia pamiec zaalokowana na bufor @p reader.
  * 
- * @param[in,out] command   : wskaznik na strukture zawierajaca dane o poleceniu
+ * @param[in,out] reader    : zwalniany bufor
  */
-void erase_command(command_t *command) {
-	free(command);
+void command_reader_free(command_reader_t *reader) {
+	free(reader->buffer);
+	reader->buffer = NULL;
 }
 
 
 /**
- * @brief Przetwarza napis na typ @ref command_type_t.
+ * @brief Przetwarza pierwszy znak polecenia na typ @ref command_type_t.
  * Bierze pod uwage tylko napisy odnoszace sie do polecen kontrolujacych gre.
  * 
- * @param[in] command_name  : wskaznik na poczatek napisu
+ * @param[in] command_name  : pierwszy znak polecenia
  * 
  * @return Przetworzone polecenie @p command_name na typ @ref command_type_t
- * lub ERROR gdy napis nie byl poprawny.
+ * lub ERROR gdy znak nie oznacza zadnego polecenia.
  */
-command_type_t get_command_type(char *command_name) {
-	if (!strcmp(command_name, "B")) {
-		return NEW_GAME_BATCH;
-	}
-	if (!strcmp(command_name, "I")) {
-		return NEW_GAME_INTERACTIVE;
-	}
-	if (!strcmp(command_name, "m")) {
-		return MOVE;
+command_type_t get_command_type(char command_name) {
+	switch (command_name) {
+		case 'B':
+			return NEW_GAME_BATCH;
+		case 'I':
+			return NEW_GAME_INTERACTIVE;
+		case 'm':
+			return MOVE;
+		case 'g':
+			return GOLDEN_MOVE;
+		case 'b':
+			return BUSY_FIELDS;
+		case 'f':
+			return FREE_FIELDS;
+		case 'q':
+			return GOLDEN_POSSIBLE;
+		case 'p':
+			return BOARD;
+		default:
+			return ERROR;
 	}
-	if (!strcmp(command_name, "g")) {
-		return GOLDEN_MOVE;
-	}
-	if (!strcmp(command_name, "b")) {
-		return BUSY_FIELDS;
-	}
-	if (!strcmp(command_name, "f")) {
-		return FREE_FIELDS;
-	}
-	if (!strcmp(command_name, "q")) {
-		return GOLDEN_POSSIBLE;
-	}
-	if (!strcmp(command_name, "p")) {
-		return BOARD;
-	}
-	return ERROR;
 }
 
 
 /**
  * @brief Sprawdza, czy format wejscia jest poprawny.
  * 
+ * @param[in] instruction   : wskaznik na poczatek linii
+ * @param[in] size          : dlugosc linii lub kod z @ref next_line
+ * @param[in] illegal       : czy linia zawiera niedozwolone znaki sterujace
+ * 
  * @return Enum @ref command_type_t zawierajacy informacje o
  * poprawnosci formatu wejscia.
  * CONTINUE (instrukcja ma poprawny format)
  * ERROR/SKIP/EXIT (instrukcja ma niepoprawny format)
  **/
-command_type_t check_for_invalid_input_format(char *instruction, int size) {
+command_type_t check_for_invalid_input_format(
+	char *instruction,
+	int size,
+	bool illegal
+) {
 	if (!size) {
 		return SKIP;
 	}
@@ -192,7 +325,7 @@ command_type_t check_for_invalid_input_format(char *instruction, int size) {
 	if (size == -2) {
 		return ERROR;
 	}
-	if (check_for_illegal_signs(instruction, size)) {
+	if (illegal) {
 		return ERROR;
 	}
 	return CONTINUE;
@@ -200,72 +333,88 @@ command_type_t check_for_invalid_input_format(char *instruction, int size) {
 
 
 /**
- * @brief Sprawdza, czy @p input jest poprawnym zapisem liczby oraz, jesli tak
- * jest, sprawdza, czy ta liczba miesci sie w zmiennej typu uint32_t.
+ * @brief Wczytuje liczbe zapisana od pozycji @p *input i sprawdza, czy
+ * zapis jest poprawny oraz czy liczba miesci sie w zmiennej typu uint32_t.
+ * Poprawny zapis to co najwyzej 10 cyfr. Tak jak przy strtoul(..., 0), zapis
+ * zaczynajacy sie od 0 jest czytany osemkowo do pierwszej cyfry 8 lub 9.
  * 
- * @param[in] input : wskaznik na poczatek napisu
+ * @param[in,out] input : wskaznik na poczatek zapisu liczby, przesuwany za
+ *                        jej koniec
+ * @param[in] end       : koniec linii
+ * @param[out] number   : wczytana liczba
  * 
- * @return Gdy @p input jest poprawnym zapisem liczby zwraca 1, w przeciwnym
- * wypadku 0.
+ * @return Gdy zapis liczby jest poprawny zwraca 1, w przeciwnym wypadku 0.
  */
-int is_valid_number(char *input) {
+int parse_number(const char **input, const char *end, uint32_t *number) {
+	const char *c = *input;
+	uint64_t base = *c == '0' ? 8 : 10;
+	uint64_t value = 0;
 	int size = 0;
-	for (char *c = input; *c != 0; c++) {
-		size++;
-		if (*c < '0' || *c > '9') {
+
+	for (; c < end && !is_delimiter(*c); c++, size++) {
+		uint64_t digit = (unsigned char)*c - '0';
+		if (digit > 9 || size == 10) {
 			return 0;
 		}
+		if (digit >= base) {
+			// dalsze cyfry nie zmieniaja wartosci, ale musza byc cyframi
+			base = 0;
+		}
+		if (base) {
+			value = value * base + digit;
+		}
 	}
-	if (size > 10) {
-		return 0;
-	}
-
-	uint64_t parsed_number = strtoull(input, NULL, 0);
-	if (parsed_number > UINT32_MAX) {
+	if (value > UINT32_MAX) {
 		return 0;
 	}
 
+	*input = c;
+	*number = value;
 	return 1;
 }
 
 
 /**
  * @brief Przetwarza instrukcje o poprawnym formacie na typ @ref command_t.
+ * Rozpoznaje polecenie po pierwszym znaku i wczytuje argumenty w jednym
+ * przejsciu po linii.
  * 
  * @param[in] instruction   : wskaznik na poczatek instrukcji
- * 
- * @return Polecenie do wykonania.
+ * @param[in] size          : dlugosc instrukcji
+ * @param[out] command      : polecenie do wykonania
  */
-command_t *parse_command(char *instruction) {
-	char *delimiters = " \t\v\f\r";
-	char *pointer = strtok(instruction, delimiters);
-	if (pointer == NULL) {
-		return create_new_command(ERROR);
+void parse_command(const char *instruction, int size, command_t *command) {
+	const char *c = instruction + 1;
+	const char *end = instruction + size;
+	command_type_t commandType = get_command_type(instruction[0]);
+	if (c < end && !is_delimiter(*c)) {
+		commandType = ERROR;
 	}
 
-	command_type_t commandType = get_command_type(pointer);
+	set_command(command, commandType);
 	if (commandType == ERROR) {
-		return create_new_command(ERROR);
+		return;
 	}
 
-	command_t *command = create_new_command(commandType);
 	int count = 0;
 
-	while ((pointer = strtok(NULL, delimiters)) != NULL) {
-		if (count > 3) {
-			erase_command(command);
-			return create_new_command(ERROR);
+	while (1) {
+		while (c < end && is_delimiter(*c)) {
+			c++;
+		}
+		if (c == end) {
+			break;
 		}
-		if (!is_valid_number(pointer)) {
-			erase_command(command);
-			return create_new_command(ERROR);
+
+		uint32_t number;
+		if (count > 3 || !parse_number(&c, end, &number)) {
+			set_command(command, ERROR);
+			return;
 		}
-		command->args[count] = strtoul(pointer, NULL, 0);
+		command->args[count] = number;
 		count++;
 	}
 	command->arg_count = count;
-
-	return command;
 }
 
 
@@ -307,36 +456,34 @@ int check_correct_arguments_number(command_t *command) {
 
 
 /**
- * @brief Zwraca nastepne polecenie do wykonania.
- * Alokuje pamiec na przechowanie danych.
- * Przetwarza wejscie na typ @ref command_t.
+ * @brief Wczytuje nastepne polecenie do wykonania.
+ * Przetwarza kolejna linie wejscia na typ @ref command_t i zapisuje wynik w
+ * @p command. Nie alokuje pamieci, chyba ze linia nie miesci sie w buforze.
+ * 
+ * @param[in,out] reader    : bufor, z ktorego czytamy
+ * @param[out] command      : struktura, w ktorej zapisujemy polecenie
  * 
- * @return Wskaznik na strukture przechowujaca dane o poleceniu.
+ * @return Typ wczytanego polecenia.
  */
-command_t *get_command() {
-	int buffer_size = BUFFER_SIZE;
-	char *instruction = calloc(buffer_size, sizeof(char));
-	if (!instruction) {
-		exit(1);
-	}
-	int size = read_line(&instruction, buffer_size);
+command_type_t read_command(command_reader_t *reader, command_t *command) {
+	char *instruction;
+	reader->illegal = false;
+	int size = next_line(reader, &instruction);
 
 	command_type_t input_validity = check_for_invalid_input_format(
 		instruction,
-		size
+		size,
+		reader->illegal
 	);
 	if (input_validity != CONTINUE) {
-		free(instruction);
-		return create_new_command(input_validity);
+		set_command(command, input_validity);
+		return input_validity;
 	}
 
-	command_t *command = parse_command(instruction);
+	parse_command(instruction, size, command);
 	if (!check_correct_arguments_number(command)) {
-		free(instruction);
-		erase_command(command);
-		return create_new_command(ERROR);
+		set_command(command, ERROR);
 	}
-	
-	free(instruction);
-	return command;
+
+	return command->command_type;
 }
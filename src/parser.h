@@ -9,13 +9,14 @@
 #define PARSER_H
 
 
+#include <stdbool.h>
 #include <stdint.h>
 
 
 /**
- * Wstepny rozmiar bufora.
+ * Wstepny rozmiar bufora wejscia.
  */
-#define BUFFER_SIZE 64
+#define BUFFER_SIZE (1 << 16)
 
 
 /**
@@ -55,21 +56,95 @@ typedef struct command {
 
 
 /**
- * @brief Zwraca nastepne polecenie do wykonania.
- * Alokuje pamiec na przechowanie danych.
- * Przetwarza wejscie na typ @ref command_t.
+ * @brief Bufor wejscia, z ktorego czytane sa polecenia.
+ * Dane sa wczytywane funkcja read(2) duzymi kawalkami, a linie sa
+ * przetwarzane w miejscu, w buforze. Bufor jest powiekszany tylko wtedy, gdy
+ * nie miesci sie w nim jedna linia.
  * 
- * @return Wskaznik na strukture przechowujaca dane o poleceniu.
+ * @param fd        : deskryptor pliku, z ktorego czytamy
+ * @param buffer    : bufor
+ * @param capacity  : rozmiar bufora
+ * @param start     : pozycja poczatku nieprzetworzonych danych
+ * @param scanned   : pozycja, do ktorej nieprzetworzone dane zostaly juz
+ *                    przeszukane w poszukiwaniu konca linii
+ * @param end       : pozycja konca wczytanych danych
+ * @param eof       : czy doszlismy do konca wejscia
+ * @param illegal   : czy wczytywana linia zawiera niedozwolone znaki
+ *                    sterujace
  */
-command_t *get_command();
+typedef struct command_reader {
+	int fd;
+	char *buffer;
+	uint64_t capacity;
+	uint64_t start;
+	uint64_t scanned;
+	uint64_t end;
+	bool eof;
+	bool illegal;
+} command_reader_t;
 
 
 /**
- * @brief Zwalnia pamiec zaalokowana w funkcji @ref getCommand.
+ * @brief Wyszukuje koniec linii w napisie od @p begin do @p end.
+ * Linie konczy znak '\n' lub bajt 0xFF. Po drodze sprawdza, czy linia
+ * zawiera niedozwolone znaki sterujace (o kodzie mniejszym niz 32, poza
+ * dozwolonymi bialymi znakami).
  * 
- * @param[in] command   : polecenie, ktorego zajmowana pamiec zwalniamy
+ * @param[in] begin     : poczatek przeszukiwanego napisu
+ * @param[in] end       : koniec przeszukiwanego napisu
+ * @param[in,out] illegal   : ustawiany na @p true, gdy w przeszukanej czesci
+ *                            linii byl niedozwolony znak
+ * 
+ * @return Wskaznik na znak konczacy linie lub NULL, gdy napis sie skonczyl.
+ */
+char *find_line_end(char *begin, char *end, bool *illegal);
+
+
+/**
+ * @brief Wczytuje liczbe zapisana od pozycji @p *input i sprawdza, czy
+ * zapis jest poprawny oraz czy liczba miesci sie w zmiennej typu uint32_t.
+ * Poprawny zapis to co najwyzej 10 cyfr. Tak jak przy strtoul(..., 0), zapis
+ * zaczynajacy sie od 0 jest czytany osemkowo do pierwszej cyfry 8 lub 9.
+ * 
+ * @param[in,out] input : wskaznik na poczatek zapisu liczby, przesuwany za
+ *                        jej koniec
+ * @param[in] end       : koniec linii
+ * @param[out] number   : wczytana liczba
+ * 
+ * @return Gdy zapis liczby jest poprawny zwraca 1, w przeciwnym wypadku 0.
+ */
+int parse_number(const char **input, const char *end, uint32_t *number);
+
+
+/**
+ * @brief Inicjalizuje bufor @p reader czytajacy z deskryptora @p fd.
+ * Konczy program z kodem 1, gdy nie udalo sie zaalokowac pamieci.
+ * 
+ * @param[out] reader   : inicjalizowany bufor
+ * @param[in] fd        : deskryptor pliku, z ktorego czytamy
+ */
+void command_reader_init(command_reader_t *reader, int fd);
+
+
+/**
+ * @brief Zwalnia pamiec zaalokowana na bufor @p reader.
+ * 
+ * @param[in,out] reader    : zwalniany bufor
+ */
+void command_reader_free(command_reader_t *reader);
+
+
+/**
+ * @brief Wczytuje nastepne polecenie do wykonania.
+ * Przetwarza kolejna linie wejscia na typ @ref command_t i zapisuje wynik w
+ * @p command. Nie alokuje pamieci, chyba ze linia nie miesci sie w buforze.
+ * 
+ * @param[in,out] reader    : bufor, z ktorego czytamy
+ * @param[out] command      : struktura, w ktorej zapisujemy polecenie
+ * 
+ * @return Typ wczytanego polecenia.
  */
-void erase_command(command_t *command);
+command_type_t read_command(command_reader_t *reader, command_t *command);
 
 
 #endif /* PARSER_H */
@@ -0,0 +1,142 @@
+/** @file
+ * Pomiar szybkosci wczytywania polecen trybu wsadowego przez
+ * @ref read_command
+ *
+ * @author Piotr Prabucki <pp418377@students.mimuw.edu.pl>
+ */
+
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "parser.h"
+
+
+/**
+ * Liczba linii wejscia w pomiarze.
+ */
+#define BENCH_LINES 10000000
+/**
+ * Liczba powtorzen pomiaru; wypisywany jest najlepszy wynik.
+ */
+#define BENCH_ROUNDS 3
+
+
+/**
+ * @brief Zwraca czas w sekundach od ustalonej chwili.
+ *
+ * @return Czas w sekundach.
+ */
+double get_time(void) {
+	struct timespec now;
+	timespec_get(&now, TIME_UTC);
+
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+
+/**
+ * @brief Zapisuje do pliku @p file @ref BENCH_LINES pseudolosowych linii
+ * wejscia: glownie ruchy i zapytania, a takze komentarze i bledne linie.
+ *
+ * @param[out] file : plik, do ktorego zapisujemy wejscie
+ */
+void generate_input(FILE *file) {
+	uint64_t state = 88172645463325252ull;
+
+	fprintf(file, "B 1000 1000 100 1000\n");
+	for (size_t i = 1; i < BENCH_LINES; i++) {
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		uint32_t player = 1 + state % 100;
+		uint32_t x = (state >> 8) % 1000;
+		uint32_t y = (state >> 24) % 1000;
+		switch ((state >> 40) % 16) {
+			case 0:
+				fprintf(file, "g %u %u %u\n", player, x, y);
+				break;
+			case 1:
+				fprintf(file, "b %u\n", player);
+				break;
+			case 2:
+				fprintf(file, "f %u\n", player);
+				break;
+			case 3:
+				fprintf(file, "q %u\n", player);
+				break;
+			case 4:
+				fprintf(file, "# komentarz %u\n", player);
+				break;
+			case 5:
+				fprintf(file, "m %u %u\n", player, x);
+				break;
+			default:
+				fprintf(file, "m %u %u %u\n", player, x, y);
+				break;
+		}
+	}
+}
+
+
+/**
+ * @brief Mierzy czas wczytania wszystkich polecen z deskryptora @p fd.
+ *
+ * @param[in] fd        : deskryptor pliku z wejsciem, czytanego od poczatku
+ * @param[out] errors   : liczba blednych polecen
+ *
+ * @return Czas w sekundach.
+ */
+double bench_parser(int fd, size_t *errors) {
+	lseek(fd, 0, SEEK_SET);
+	command_reader_t reader;
+	command_reader_init(&reader, fd);
+	command_t command;
+
+	*errors = 0;
+	double start = get_time();
+	command_type_t type;
+	while ((type = read_command(&reader, &command)) != EXIT) {
+		*errors += type == ERROR;
+	}
+	double time = get_time() - start;
+
+	command_reader_free(&reader);
+
+	return time;
+}
+
+
+/**
+ * @brief Wypisuje liczbe wczytanych linii na sekunde.
+ *
+ * @return Zero lub 1, gdy nie udalo sie utworzyc pliku z wejsciem.
+ */
+int main() {
+	FILE *file = tmpfile();
+	if (!file) {
+		return 1;
+	}
+	generate_input(file);
+	fflush(file);
+
+	double best = 0;
+	size_t errors = 0;
+	for (int i = 0; i < BENCH_ROUNDS; i++) {
+		double time = bench_parser(fileno(file), &errors);
+		if (i == 0 || time < best) {
+			best = time;
+		}
+	}
+
+	printf("%d lines, %zu errors\n", BENCH_LINES, errors);
+	printf("read_command : %.2f Mlines/s\n", BENCH_LINES / best / 1e6);
+
+	fclose(file);
+
+	return 0;
+}
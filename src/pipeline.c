@@ -0,0 +1,254 @@
+/** @file
+ * Implementacja modulu wykonujacego polecenia trybu wsadowego potokowo na
+ * trzech watkach
+ *
+ * @author Piotr Prabucki <pp418377@students.mimuw.edu.pl>
+ */
+
+
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "command_handler.h"
+#include "gamma.h"
+#include "interactive_mode_handler.h"
+#include "parser.h"
+#include "pipeline.h"
+#include "response_writer.h"
+#include "ring_util.h"
+
+
+/**
+ * Pojemnosc kolejki polecen.
+ */
+#define COMMAND_RING_SIZE (1 << 12)
+/**
+ * Pojemnosc kolejki odpowiedzi.
+ */
+#define RESPONSE_RING_SIZE (1 << 12)
+
+
+/**
+ * @brief Decyzja watku wykonujacego o dalszym czytaniu wejscia po poleceniu
+ * rozpoczecia trybu interaktywnego.
+ * VERDICT_PENDING (polecenie nie zostalo jeszcze wykonane)
+ * VERDICT_CONTINUE (gra nie zostala utworzona, czytamy dalej)
+ * VERDICT_STOP (rozpoczal sie tryb interaktywny, wejscie czyta on sam)
+ */
+typedef enum verdict {
+	VERDICT_PENDING,
+	VERDICT_CONTINUE,
+	VERDICT_STOP
+} verdict_t;
+
+
+/**
+ * @brief Stan potoku wspoldzielony przez watki.
+ *
+ * @param input_fd  : deskryptor pliku z poleceniami
+ * @param writer    : bufory, do ktorych trafiaja odpowiedzi
+ * @param commands  : kolejka polecen od watku czytajacego do wykonujacego
+ * @param responses : kolejka odpowiedzi od watku wykonujacego do
+ *                    wypisujacego
+ * @param flushes   : liczba odpowiedzi, po ktorych watek wypisujacy
+ *                    oproznil bufory na prosbe watku wykonujacego
+ * @param verdict   : decyzja o dalszym czytaniu wejscia po poleceniu
+ *                    rozpoczecia trybu interaktywnego
+ */
+typedef struct pipeline {
+	int input_fd;
+	response_writer_t *writer;
+	spsc_ring_t commands;
+	spsc_ring_t responses;
+	alignas(64) atomic_uint_fast64_t flushes;
+	alignas(64) atomic_int verdict;
+} pipeline_t;
+
+
+/**
+ * @brief Wczytuje polecenia i przekazuje je watkowi wykonujacemu.
+ * Po poleceniu rozpoczecia trybu interaktywnego czeka na decyzje, czy czytac
+ * dalej, bo tryb interaktywny sam czyta wejscie.
+ *
+ * @param[in,out] data  : wskaznik na @ref pipeline_t
+ *
+ * @return Wartosc @p NULL.
+ */
+void *read_commands(void *data) {
+	pipeline_t *pipeline = data;
+	command_reader_t reader;
+	command_reader_init(&reader, pipeline->input_fd);
+	command_t command;
+
+	while (read_command(&reader, &command) != EXIT) {
+		bool interactive = command.command_type == NEW_GAME_INTERACTIVE;
+		if (interactive) {
+			atomic_store(&pipeline->verdict, VERDICT_PENDING);
+		}
+		spsc_ring_push(&pipeline->commands, &command);
+
+		if (interactive) {
+			uint64_t spins = 0;
+			int verdict;
+			while ((verdict = atomic_load(&pipeline->verdict))
+				== VERDICT_PENDING) {
+				wait_a_moment(&spins);
+			}
+			if (verdict == VERDICT_STOP) {
+				break;
+			}
+		}
+	}
+
+	command_reader_free(&reader);
+	spsc_ring_close(&pipeline->commands);
+
+	return NULL;
+}
+
+
+/**
+ * @brief Wypisuje odpowiedzi przekazane przez watek wykonujacy.
+ * Na odpowiedzi @ref BOARD_RESPONSE i @ref INTERACTIVE_RESPONSE oproznia
+ * bufory i zglasza to watkowi wykonujacemu, ktory wtedy sam pisze na
+ * standardowe wyjscie.
+ *
+ * @param[in,out] data  : wskaznik na @ref pipeline_t
+ *
+ * @return Wartosc @p NULL.
+ */
+void *write_responses(void *data) {
+	pipeline_t *pipeline = data;
+	response_t response;
+
+	while (spsc_ring_pop(&pipeline->responses, &response)) {
+		if (
+			response.type == BOARD_RESPONSE ||
+			response.type == INTERACTIVE_RESPONSE
+		) {
+			flush_responses(pipeline->writer);
+			atomic_fetch_add_explicit(&pipeline->flushes, 1,
+				memory_order_release);
+		}
+		else {
+			write_command_response(pipeline->writer, &response);
+		}
+	}
+
+	return NULL;
+}
+
+
+/**
+ * @brief Przekazuje odpowiedz @p response watkowi wypisujacemu i czeka, az
+ * wypisze on wszystkie wczesniejsze odpowiedzi i oprozni bufory.
+ *
+ * @param[in,out] pipeline  : stan potoku
+ * @param[in] response      : odpowiedz @ref BOARD_RESPONSE lub
+ *                            @ref INTERACTIVE_RESPONSE
+ * @param[in,out] requested : liczba dotychczasowych prosb o oproznienie
+ *                            buforow
+ */
+void wait_for_flush(
+	pipeline_t *pipeline,
+	const response_t *response,
+	uint64_t *requested
+) {
+	spsc_ring_push(&pipeline->responses, response);
+	(*requested)++;
+
+	uint64_t spins = 0;
+	while (atomic_load_explicit(&pipeline->flushes, memory_order_acquire)
+		!= *requested) {
+		wait_a_moment(&spins);
+	}
+}
+
+
+/**
+ * @brief Wykonuje polecenia z kolejki polecen i przekazuje odpowiedzi na nie
+ * watkowi wypisujacemu.
+ * Numeruje linie tak samo jak tryb jednowatkowy.
+ *
+ * @param[in,out] pipeline  : stan potoku
+ */
+void execute_commands(pipeline_t *pipeline) {
+	int line = 0, game_state = 0;
+	gamma_t *gamma;
+	command_t command;
+	uint64_t requested = 0;
+
+	while (spsc_ring_pop(&pipeline->commands, &command)) {
+		response_t response = get_command_response(&command, &gamma,
+			&game_state, ++line);
+
+		if (response.type == BOARD_RESPONSE) {
+			wait_for_flush(pipeline, &response, &requested);
+			gamma_board_write(gamma, pipeline->writer->buffers[OUTPUT].fd);
+		}
+		else if (response.type == INTERACTIVE_RESPONSE) {
+			wait_for_flush(pipeline, &response, &requested);
+			atomic_store(&pipeline->verdict, VERDICT_STOP);
+			run_interactive_mode(&gamma, command.args[0],
+				command.args[1] + 1, command.args[2]);
+			break;
+		}
+		else {
+			if (command.command_type == NEW_GAME_INTERACTIVE) {
+				atomic_store(&pipeline->verdict, VERDICT_CONTINUE);
+			}
+			if (response.type != NO_RESPONSE) {
+				spsc_ring_push(&pipeline->responses, &response);
+			}
+		}
+	}
+
+	if (game_state) {
+		gamma_delete(gamma);
+	}
+}
+
+
+/**
+ * @brief Wykonuje polecenia czytane z deskryptora @p input_fd na trzech
+ * watkach: pierwszy wczytuje polecenia, drugi wykonuje je na silniku gry, a
+ * trzeci wypisuje odpowiedzi do @p writer.
+ * Watkiem wykonujacym jest watek wywolujacy.
+ *
+ * @param[in] input_fd      : deskryptor pliku z poleceniami
+ * @param[in,out] writer    : bufory, do ktorych trafiaja odpowiedzi
+ *
+ * @return Wartosc @p true, jesli polecenia zostaly wykonane, a @p false,
+ * gdy nie udalo sie uruchomic watkow; wtedy zadne polecenie nie zostalo
+ * wczytane.
+ */
+bool run_pipeline(int input_fd, response_writer_t *writer) {
+	pipeline_t pipeline;
+	pipeline.input_fd = input_fd;
+	pipeline.writer = writer;
+	spsc_ring_init(&pipeline.commands, sizeof(command_t), COMMAND_RING_SIZE);
+	spsc_ring_init(&pipeline.responses, sizeof(response_t),
+		RESPONSE_RING_SIZE);
+	atomic_init(&pipeline.flushes, 0);
+	atomic_init(&pipeline.verdict, VERDICT_PENDING);
+
+	pthread_t reader, printer;
+	bool success = !pthread_create(&printer, NULL, write_responses,
+		&pipeline);
+	if (success) {
+		success = !pthread_create(&reader, NULL, read_commands, &pipeline);
+		if (success) {
+			execute_commands(&pipeline);
+			pthread_join(reader, NULL);
+		}
+		spsc_ring_close(&pipeline.responses);
+		pthread_join(printer, NULL);
+	}
+
+	spsc_ring_free(&pipeline.commands);
+	spsc_ring_free(&pipeline.responses);
+
+	return success;
+}
@@ -0,0 +1,35 @@
+/** @file
+ * Interfejs modulu wykonujacego polecenia trybu wsadowego potokowo na trzech
+ * watkach
+ *
+ * @author Piotr Prabucki <pp418377@students.mimuw.edu.pl>
+ */
+
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+
+#include <stdbool.h>
+#include "response_writer.h"
+
+
+/**
+ * @brief Wykonuje polecenia czytane z deskryptora @p input_fd na trzech
+ * watkach: pierwszy wczytuje polecenia, drugi wykonuje je na silniku gry, a
+ * trzeci wypisuje odpowiedzi do @p writer.
+ * Watki przekazuja sobie polecenia i odpowiedzi kolejkami
+ * @ref spsc_ring_t. Wyjscie i numeracja linii sa takie same jak przy
+ * wykonywaniu polecen po kolei na jednym watku.
+ *
+ * @param[in] input_fd      : deskryptor pliku z poleceniami
+ * @param[in,out] writer    : bufory, do ktorych trafiaja odpowiedzi
+ *
+ * @return Wartosc @p true, jesli polecenia zostaly wykonane, a @p false,
+ * gdy nie udalo sie uruchomic watkow; wtedy zadne polecenie nie zostalo
+ * wczytane.
+ */
+bool run_pipeline(int input_fd, response_writer_t *writer);
+
+
+#endif /* PIPELINE_H */
@@ -0,0 +1,825 @@
+/** @file
+ * Implementacja modulu rozgrywajacego losowe partie gry gamma do konca
+ *
+ * @author Piotr Prabucki <pp418377@students.mimuw.edu.pl>
+ */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gamma.h"
+#include "playout.h"
+
+
+/**
+ * Liczba losowan pola, po ktorych wybor zlotego ruchu przechodzi do
+ * sprawdzenia wszystkich pol.
+ */
+#define SAMPLE_ATTEMPTS 8
+/**
+ * Wlasciciel pol ramki planszy.
+ */
+#define BORDER UINT32_MAX
+/**
+ * Pozycja pola, ktorego nie ma na brzegu obszarow gracza.
+ */
+#define ABSENT UINT32_MAX
+
+
+/**
+ * @brief Zwraca kolejna liczbe pseudolosowa (xorshift64*).
+ *
+ * @param[in,out] p : silnik losowych rozgrywek
+ *
+ * @return Liczba pseudolosowa.
+ */
+uint64_t playout_random(playout_t *p) {
+	uint64_t x = p->random_state;
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	p->random_state = x;
+
+	return x * 0x2545F4914F6CDD1Dull;
+}
+
+
+/**
+ * @brief Zwraca liczbe pseudolosowa z przedzialu [0, @p bound).
+ * Mnozy zamiast dzielic z reszta, co daje pomijalnie nierowny rozklad.
+ *
+ * @param[in,out] p : silnik losowych rozgrywek
+ * @param[in] bound : liczba mozliwych wynikow, dodatnia
+ *
+ * @return Liczba pseudolosowa.
+ */
+uint32_t playout_random_below(playout_t *p, uint32_t bound) {
+	return ((playout_random(p) >> 32) * bound) >> 32;
+}
+
+
+/**
+ * @brief Zwraca korzen obszaru pola @p cell w lesie @p parent.
+ * Przepina co drugi wezel na sciezce do korzenia (path halving).
+ *
+ * @param[in,out] parent    : las obszarow
+ * @param[in] cell          : numer pola
+ *
+ * @return Numer pola bedacego korzeniem obszaru.
+ */
+uint32_t playout_find(uint32_t *parent, uint32_t cell) {
+	while (parent[cell] != cell) {
+		parent[cell] = parent[parent[cell]];
+		cell = parent[cell];
+	}
+
+	return cell;
+}
+
+
+/**
+ * @brief Zapisuje w @p roots rozne korzenie obszarow gracza @p player
+ * sasiadujacych z polem @p cell.
+ *
+ * @param[in,out] p     : silnik losowych rozgrywek
+ * @param[in] cell      : numer pola
+ * @param[in] player    : numer gracza
+ * @param[out] roots    : tablica na co najwyzej 4 korzenie
+ *
+ * @return Liczba roznych obszarow gracza sasiadujacych z polem.
+ */
+int get_neighbour_roots(
+	playout_t *p,
+	uint32_t cell,
+	uint32_t player,
+	uint32_t *roots
+) {
+	uint32_t neighbours[4] = {
+		cell - p->stride, cell + 1, cell + p->stride, cell - 1
+	};
+
+	int count = 0;
+	for (int i = 0; i < 4; i++) {
+		if (p->owner[neighbours[i]] != player) {
+			continue;
+		}
+
+		uint32_t root = playout_find(p->parent, neighbours[i]);
+		int j = 0;
+		while (j < count && roots[j] != root) {
+			j++;
+		}
+		if (j == count) {
+			roots[count++] = root;
+		}
+	}
+
+	return count;
+}
+
+
+/**
+ * @brief Sprawdza, czy pole @p cell sasiaduje z polem gracza @p player.
+ *
+ * @param[in] p         : silnik losowych rozgrywek
+ * @param[in] cell      : numer pola
+ * @param[in] player    : numer gracza
+ *
+ * @return true, gdy pole sasiaduje z polem gracza, false w przeciwnym
+ * wypadku.
+ */
+bool is_next_to_player(const playout_t *p, uint32_t cell, uint32_t player) {
+	// a single branch, as the outcome is hard to predict
+	return (p->owner[cell - p->stride] == player) |
+		(p->owner[cell + 1] == player) |
+		(p->owner[cell + p->stride] == player) |
+		(p->owner[cell - 1] == player);
+}
+
+
+/**
+ * @brief Zwraca poczatek brzegu obszarow gracza @p player w tablicach
+ * [frontier] i [frontier_position].
+ *
+ * @param[in] p         : silnik losowych rozgrywek
+ * @param[in] player    : numer gracza
+ *
+ * @return Indeks pierwszego elementu brzegu.
+ */
+uint64_t get_frontier_base(const playout_t *p, uint32_t player) {
+	return (uint64_t)(player - 1) * p->cell_count;
+}
+
+
+/**
+ * @brief Dodaje pole @p cell do brzegu obszarow gracza @p player, gdy pole
+ * jest wolne i jeszcze do niego nie nalezy.
+ * Nie rozgalezia sie, bo wynik sprawdzenia jest trudny do przewidzenia.
+ *
+ * @param[in,out] p     : silnik losowych rozgrywek
+ * @param[in] player    : numer gracza
+ * @param[in] cell      : numer pola
+ */
+void add_to_frontier(playout_t *p, uint32_t player, uint32_t cell) {
+	uint64_t base = get_frontier_base(p, player);
+	uint32_t size = p->frontier_size[player];
+	uint32_t position = p->frontier_position[base + cell];
+	bool added = (p->owner[cell] == 0) & (position == ABSENT);
+
+	// the frontier is shorter than its space, so the write past its end is
+	// harmless when the cell is not added
+	p->frontier[base + size] = cell;
+	p->frontier_position[base + cell] = added ? size : position;
+	p->frontier_size[player] = size + added;
+}
+
+
+/**
+ * @brief Usuwa pole @p cell z brzegu obszarow gracza @p player.
+ * Nic nie robi, gdy pole do niego nie nalezy.
+ *
+ * @param[in,out] p     : silnik losowych rozgrywek
+ * @param[in] player    : numer gracza
+ * @param[in] cell      : numer pola
+ */
+void remove_from_frontier(playout_t *p, uint32_t player, uint32_t cell) {
+	uint64_t base = get_frontier_base(p, player);
+	uint32_t position = p->frontier_position[base + cell];
+	if (position != ABSENT) {
+		uint32_t last = p->frontier[base + --p->frontier_size[player]];
+		p->frontier[base + position] = last;
+		p->frontier_position[base + last] = position;
+		p->frontier_position[base + cell] = ABSENT;
+	}
+}
+
+
+/**
+ * @brief Stawia pionek gracza @p player na polu @p cell, laczac sasiednie
+ * obszary gracza.
+ * Pole nie moze nalezec do gracza ani byc na liscie wolnych pol.
+ *
+ * @param[in,out] p     : silnik losowych rozgrywek
+ * @param[in] cell      : numer pola
+ * @param[in] player    : numer gracza
+ */
+void place_piece(playout_t *p, uint32_t cell, uint32_t player) {
+	uint32_t neighbours[4] = {
+		cell - p->stride, cell + 1, cell + p->stride, cell - 1
+	};
+
+	// roots already linked to the cell are found as the cell itself, so
+	// every area is counted once
+	p->parent[cell] = cell;
+	uint64_t merged = 0;
+	for (int i = 0; i < 4; i++) {
+		if (p->owner[neighbours[i]] == player) {
+			uint32_t root = playout_find(p->parent, neighbours[i]);
+			if (root != cell) {
+				p->parent[root] = cell;
+				merged++;
+			}
+		}
+	}
+	p->owner[cell] = player;
+	p->areas[player] = p->areas[player] + 1 - merged;
+	p->taken[player]++;
+}
+
+
+/**
+ * @brief Wykonuje zwykly ruch gracza @p player na wolne pole @p cell.
+ *
+ * @param[in,out] p     : silnik losowych rozgrywek
+ * @param[in] cell      : numer wolnego pola
+ * @param[in] player    : numer gracza
+ */
+void make_normal_move(playout_t *p, uint32_t cell, uint32_t player) {
+	uint32_t position = p->free_position[cell];
+	uint32_t last = p->free_cells[--p->free_count];
+	p->free_cells[position] = last;
+	p->free_position[last] = position;
+
+	place_piece(p, cell, player);
+
+	uint32_t neighbours[4] = {
+		cell - p->stride, cell + 1, cell + p->stride, cell - 1
+	};
+	for (int i = 0; i < 4; i++) {
+		add_to_frontier(p, player, neighbours[i]);
+	}
+}
+
+
+/**
+ * @brief Liczy czesci, na ktore rozpadlyby sie obszary gracza @p player
+ * sasiadujace z polem @p cell, gdyby zabrac mu to pole.
+ *
+ * @param[in,out] p     : silnik losowych rozgrywek
+ * @param[in] cell      : numer pola gracza
+ * @param[in] player    : numer gracza
+ * @param[in] start     : pola gracza sasiadujace z polem [cell]
+ * @param[in] count     : liczba pol w [start]
+ *
+ * @return Liczba czesci.
+ */
+uint32_t count_parts(
+	playout_t *p,
+	uint32_t cell,
+	uint32_t player,
+	const uint32_t *start,
+	int count
+) {
+	if (++p->visit_mark == 0) {
+		memset(p->visited, 0, p->cell_count * sizeof(uint32_t));
+		p->visit_mark = 1;
+	}
+	p->visited[cell] = p->visit_mark;
+
+	uint32_t parts = 0;
+	for (int s = 0; s < count; s++) {
+		if (p->visited[start[s]] == p->visit_mark) {
+			continue;
+		}
+
+		parts++;
+		uint32_t head = 0;
+		uint32_t size = 0;
+		p->queue[size++] = start[s];
+		p->visited[start[s]] = p->visit_mark;
+		while (head < size) {
+			uint32_t current = p->queue[head++];
+			uint32_t neighbours[4] = {
+				current - p->stride, current + 1, current + p->stride, current - 1
+			};
+			for (int i = 0; i < 4; i++) {
+				uint32_t neighbour = neighbours[i];
+				if (
+					p->owner[neighbour] == player &&
+					p->visited[neighbour] != p->visit_mark
+				) {
+					p->visited[neighbour] = p->visit_mark;
+					p->queue[size++] = neighbour;
+				}
+			}
+		}
+	}
+
+	return parts;
+}
+
+
+/**
+ * @brief Sprawdza, czy gracz @p player moze zabrac pole @p cell zlotym
+ * ruchem.
+ * Nie sprawdza, czy gracz wykorzystal juz zloty ruch.
+ *
+ * @param[in,out] p     : silnik losowych rozgrywek
+ * @param[in] cell      : numer pola
+ * @param[in] player    : numer gracza
+ *
+ * @return true, gdy ruch jest mozliwy, false w przeciwnym wypadku.
+ */
+bool check_golden_move(playout_t *p, uint32_t cell, uint32_t player) {
+	uint32_t owner = p->owner[cell];
+	if (owner == 0 || owner == player || owner == BORDER) {
+		return false;
+	}
+
+	uint32_t roots[4];
+	int count = get_neighbour_roots(p, cell, player, roots);
+	if (p->areas[player] + 1 - count > p->max_player_areas) {
+		return false;
+	}
+
+	uint32_t neighbours[4] = {
+		cell - p->stride, cell + 1, cell + p->stride, cell - 1
+	};
+	uint32_t start[4];
+	int start_count = 0;
+	for (int i = 0; i < 4; i++) {
+		if (p->owner[neighbours[i]] == owner) {
+			start[start_count++] = neighbours[i];
+		}
+	}
+
+	// each neighbour adds at most one part, so the search is often needless
+	if (p->areas[owner] - 1 + start_count <= p->max_player_areas) {
+		return true;
+	}
+
+	return p->areas[owner] - 1 +
+		count_parts(p, cell, owner, start, start_count) <=
+		p->max_player_areas;
+}
+
+
+/**
+ * @brief Buduje od nowa las obszarow gracza @p player i liczy jego obszary.
+ *
+ * @param[in,out] p     : silnik losowych rozgrywek
+ * @param[in] player    : numer gracza
+ */
+void rebuild_areas(playout_t *p, uint32_t player) {
+	for (uint32_t cell = 0; cell < p->cell_count; cell++) {
+		if (p->owner[cell] == player) {
+			p->parent[cell] = cell;
+		}
+	}
+
+	uint64_t areas = 0;
+	for (uint32_t cell = 0; cell < p->cell_count; cell++) {
+		if (p->owner[cell] != player) {
+			continue;
+		}
+
+		areas++;
+		// only the neighbours above and on the left were visited before
+		uint32_t neighbours[2] = {cell - p->stride, cell - 1};
+		for (int i = 0; i < 2; i++) {
+			uint32_t neighbour = neighbours[i];
+			if (p->owner[neighbour] != player) {
+				continue;
+			}
+
+			uint32_t root = playout_find(p->parent, neighbour);
+			uint32_t cell_root = playout_find(p->parent, cell);
+			if (root != cell_root) {
+				p->parent[cell_root] = root;
+				areas--;
+			}
+		}
+	}
+	p->areas[player] = areas;
+}
+
+
+/**
+ * @brief Wykonuje zloty ruch gracza @p player na pole @p cell.
+ *
+ * @param[in,out] p     : silnik losowych rozgrywek
+ * @param[in] cell      : numer pola innego gracza
+ * @param[in] player    : numer gracza
+ */
+void make_golden_move(playout_t *p, uint32_t cell, uint32_t player) {
+	uint32_t owner = p->owner[cell];
+	p->owner[cell] = 0;
+	p->taken[owner]--;
+	rebuild_areas(p, owner);
+
+	place_piece(p, cell, player);
+	p->used_golden[player] = true;
+
+	uint32_t neighbours[4] = {
+		cell - p->stride, cell + 1, cell + p->stride, cell - 1
+	};
+	for (int i = 0; i < 4; i++) {
+		add_to_frontier(p, player, neighbours[i]);
+	}
+}
+
+
+/**
+ * @brief Losuje wolne pole, ktore gracz @p player moze zajac.
+ * Gracz z maksymalna liczba obszarow losuje pole z brzegu swoich obszarow,
+ * odrzucajac i usuwajac z niego pola, ktore przestaly do niego nalezec, wiec
+ * kazde mozliwe pole jest wybierane z tym samym prawdopodobienstwem.
+ *
+ * @param[in,out] p     : silnik losowych rozgrywek
+ * @param[in] player    : numer gracza
+ *
+ * @return Numer pola lub [cell_count], gdy gracz nie moze wykonac ruchu.
+ */
+uint32_t choose_normal_move(playout_t *p, uint32_t player) {
+	if (p->free_count == 0) {
+		return p->cell_count;
+	}
+
+	if (p->areas[player] < p->max_player_areas) {
+		return p->free_cells[playout_random_below(p, p->free_count)];
+	}
+
+	// cells taken since they were added are removed only when drawn
+	uint64_t base = get_frontier_base(p, player);
+	while (p->frontier_size[player] > 0) {
+		uint32_t cell = p->frontier[
+			base + playout_random_below(p, p->frontier_size[player])
+		];
+		if (p->owner[cell] == 0 && is_next_to_player(p, cell, player)) {
+			return cell;
+		}
+		remove_from_frontier(p, player, cell);
+	}
+
+	return p->cell_count;
+}
+
+
+/**
+ * @brief Losuje pole, ktore gracz @p player moze zabrac zlotym ruchem.
+ * Losuje pola planszy, a po @ref SAMPLE_ATTEMPTS nieudanych probach, gdy
+ * @p exhaustive jest ustawione, losuje z zebranych wszystkich mozliwych pol,
+ * wiec kazde mozliwe pole jest wybierane z tym samym prawdopodobienstwem.
+ *
+ * @param[in,out] p         : silnik losowych rozgrywek
+ * @param[in] player        : numer gracza
+ * @param[in] exhaustive    : czy po nieudanych probach sprawdzic wszystkie
+ *                            pola
+ *
+ * @return Numer pola lub [cell_count], gdy nie znaleziono ruchu.
+ */
+uint32_t choose_golden_move(playout_t *p, uint32_t player, bool exhaustive) {
+	if (
+		p->used_golden[player] ||
+		p->free_count == (uint64_t)p->width * p->height
+	) {
+		return p->cell_count;
+	}
+
+	for (int i = 0; i < SAMPLE_ATTEMPTS; i++) {
+		uint32_t cell = playout_random_below(p, p->cell_count);
+		if (check_golden_move(p, cell, player)) {
+			return cell;
+		}
+	}
+	if (!exhaustive) {
+		return p->cell_count;
+	}
+
+	uint32_t count = 0;
+	for (uint32_t cell = 0; cell < p->cell_count; cell++) {
+		if (check_golden_move(p, cell, player)) {
+			p->candidates[count++] = cell;
+		}
+	}
+
+	return count ? p->candidates[playout_random_below(p, count)] :
+		p->cell_count;
+}
+
+
+/**
+ * @brief Wykonuje ruch gracza @p player zgodnie z zasadami wyboru ruchu
+ * opisanymi w @ref playout_new.
+ *
+ * @param[in,out] p     : silnik losowych rozgrywek
+ * @param[in] player    : numer gracza
+ *
+ * @return true, gdy gracz wykonal ruch, false gdy nie mogl go wykonac.
+ */
+bool make_turn(playout_t *p, uint32_t player) {
+	bool golden = p->golden_threshold && !p->used_golden[player];
+	if (golden && (playout_random(p) >> 32) < p->golden_threshold) {
+		uint32_t cell = choose_golden_move(p, player, false);
+		if (cell != p->cell_count) {
+			make_golden_move(p, cell, player);
+			return true;
+		}
+	}
+
+	uint32_t cell = choose_normal_move(p, player);
+	if (cell != p->cell_count) {
+		make_normal_move(p, cell, player);
+		return true;
+	}
+
+	if (golden) {
+		cell = choose_golden_move(p, player, true);
+		if (cell != p->cell_count) {
+			make_golden_move(p, cell, player);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/**
+ * @brief Zwraca poczatkowy stan generatora liczb pseudolosowych dla ziarna
+ * @p seed (splitmix64).
+ *
+ * @param[in] seed  : ziarno
+ *
+ * @return Niezerowy stan generatora.
+ */
+uint64_t mix_seed(uint64_t seed) {
+	uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	z ^= z >> 31;
+
+	return z ? z : 1;
+}
+
+
+/**
+ * @brief Tworzy silnik losowych rozgrywek z pozycja poczatkowa z gry @p g.
+ * Alokuje wszystkie tablice robocze, wiec @ref playout_run nie alokuje juz
+ * pamieci i oznacza pola ramki planszy.
+ *
+ * @param[in] g                     : gra z pozycja poczatkowa
+ * @param[in] first_player          : gracz, ktory wykonuje pierwszy ruch
+ * @param[in] golden_probability    : prawdopodobienstwo proby zlotego ruchu,
+ *                                    liczba z przedzialu [0, 1]
+ * @param[in] seed                  : ziarno generatora liczb pseudolosowych
+ *
+ * @return Wskaznik na utworzony silnik lub NULL, gdy nie udalo sie
+ * zaalokowac pamieci, ktorys z parametrow jest niepoprawny, plansza z
+ * ramka ma co najmniej 2^32 - 1 pol lub iloczyn liczby graczy i liczby pol
+ * planszy z ramka przekracza @ref PLAYOUT_MAX_FRONTIER_CELLS.
+ */
+playout_t* playout_new(
+	gamma_t *g,
+	uint32_t first_player,
+	double golden_probability,
+	uint64_t seed
+) {
+	if (
+		!g ||
+		!(golden_probability >= 0 && golden_probability <= 1) ||
+		gamma_players(g) == BORDER
+	) {
+		return NULL;
+	}
+
+	uint64_t n =
+		((uint64_t)gamma_width(g) + 2) * ((uint64_t)gamma_height(g) + 2);
+	if (
+		n >= UINT32_MAX ||
+		gamma_players(g) > PLAYOUT_MAX_FRONTIER_CELLS / n ||
+		gamma_players(g) > SIZE_MAX / (n * sizeof(uint32_t))
+	) {
+		return NULL;
+	}
+
+	playout_t *p = calloc(1, sizeof(playout_t));
+	if (!p) {
+		return NULL;
+	}
+
+	p->width = gamma_width(g);
+	p->height = gamma_height(g);
+	p->player_count = gamma_players(g);
+	p->max_player_areas = gamma_areas(g);
+	p->stride = p->width + 2;
+	p->cell_count = p->stride * (p->height + 2);
+	p->golden_threshold = golden_probability * 4294967296.0;
+	p->random_state = mix_seed(seed);
+
+	uint64_t players = (uint64_t)p->player_count + 1;
+	p->start_owner = calloc(n, sizeof(uint32_t));
+	p->start_parent = calloc(n, sizeof(uint32_t));
+	p->start_free_cells = malloc(n * sizeof(uint32_t));
+	p->start_areas = malloc(players * sizeof(uint64_t));
+	p->start_taken = malloc(players * sizeof(uint64_t));
+	p->start_used_golden = malloc(players * sizeof(bool));
+	p->owner = calloc(n, sizeof(uint32_t));
+	p->parent = calloc(n, sizeof(uint32_t));
+	p->free_cells = malloc(n * sizeof(uint32_t));
+	p->free_position = malloc(n * sizeof(uint32_t));
+	p->areas = malloc(players * sizeof(uint64_t));
+	p->taken = malloc(players * sizeof(uint64_t));
+	p->used_golden = malloc(players * sizeof(bool));
+	p->frontier = malloc((size_t)p->player_count * n * sizeof(uint32_t));
+	p->frontier_position =
+		malloc((size_t)p->player_count * n * sizeof(uint32_t));
+	p->frontier_size = calloc(players, sizeof(uint32_t));
+	p->candidates = malloc(n * sizeof(uint32_t));
+	p->queue = malloc(n * sizeof(uint32_t));
+	p->visited = calloc(n, sizeof(uint32_t));
+	if (
+		!p->start_owner || !p->start_parent ||
+		!p->start_free_cells || !p->start_areas || !p->start_taken ||
+		!p->start_used_golden || !p->owner || !p->parent || !p->free_cells ||
+		!p->free_position || !p->areas || !p->taken || !p->used_golden ||
+		!p->frontier || !p->frontier_position || !p->frontier_size ||
+		!p->candidates || !p->queue || !p->visited
+	) {
+		playout_delete(p);
+		return NULL;
+	}
+
+	for (uint64_t i = 0; i < p->player_count * n; i++) {
+		p->frontier_position[i] = ABSENT;
+	}
+	for (uint32_t cell = 0; cell < p->cell_count; cell++) {
+		uint32_t x = cell % p->stride;
+		uint32_t y = cell / p->stride;
+		if (x == 0 || x > p->width || y == 0 || y > p->height) {
+			p->owner[cell] = BORDER;
+		}
+	}
+
+	if (!playout_set_position(p, g, first_player)) {
+		playout_delete(p);
+		return NULL;
+	}
+
+	return p;
+}
+
+
+/**
+ * @brief Zmienia pozycje poczatkowa silnika @p p na pozycje z gry @p g.
+ * Liczy obszary graczy od nowa w tablicach roboczych i zapisuje je jako
+ * pozycje poczatkowa.
+ *
+ * @param[in,out] p         : silnik losowych rozgrywek
+ * @param[in] g             : gra z pozycja poczatkowa
+ * @param[in] first_player  : gracz, ktory wykonuje pierwszy ruch
+ *
+ * @return true, gdy pozycja zostala zmieniona, false gdy ktorys z
+ * parametrow jest niepoprawny.
+ */
+bool playout_set_position(playout_t *p, gamma_t *g, uint32_t first_player) {
+	if (
+		!p || !g ||
+		gamma_width(g) != p->width ||
+		gamma_height(g) != p->height ||
+		gamma_players(g) != p->player_count ||
+		gamma_areas(g) != p->max_player_areas ||
+		first_player == 0 || first_player > p->player_count
+	) {
+		return false;
+	}
+
+	p->first_player = first_player;
+	for (uint32_t player = 0; player <= p->player_count; player++) {
+		p->start_taken[player] = 0;
+		p->start_used_golden[player] =
+			player > 0 && gamma_golden_used(g, player);
+	}
+
+	p->start_free_count = 0;
+	for (uint32_t y = 0; y < p->height; y++) {
+		for (uint32_t x = 0; x < p->width; x++) {
+			uint32_t cell = (y + 1) * p->stride + x + 1;
+			p->owner[cell] = gamma_field_owner(g, x, y);
+			if (p->owner[cell]) {
+				p->start_taken[p->owner[cell]]++;
+			}
+			else {
+				p->start_free_cells[p->start_free_count++] = cell;
+			}
+		}
+	}
+
+	memset(p->areas, 0, ((uint64_t)p->player_count + 1) * sizeof(uint64_t));
+	for (uint32_t player = 1; player <= p->player_count; player++) {
+		if (p->start_taken[player]) {
+			rebuild_areas(p, player);
+		}
+	}
+
+	memcpy(p->start_owner, p->owner, p->cell_count * sizeof(uint32_t));
+	memcpy(p->start_parent, p->parent, p->cell_count * sizeof(uint32_t));
+	memcpy(
+		p->start_areas,
+		p->areas,
+		((uint64_t)p->player_count + 1) * sizeof(uint64_t)
+	);
+
+	return true;
+}
+
+
+/**
+ * @brief Rozgrywa jedna losowa partie od pozycji poczatkowej do konca.
+ * Kopiuje pozycje poczatkowa do tablic roboczych i wykonuje ruchy graczy po
+ * kolei, dopoki wszyscy gracze pod rzad nie zostana pominieci.
+ *
+ * @param[in,out] p     : silnik losowych rozgrywek
+ * @param[out] taken    : tablica na liczby pol zajetych na koncu partii
+ *                        przez kolejnych graczy (pod indeksem 0 gracz 1)
+ *
+ * @return Liczba ruchow wykonanych w partii.
+ */
+uint64_t playout_run(playout_t *p, uint64_t *taken) {
+	uint64_t players = (uint64_t)p->player_count + 1;
+	memcpy(p->owner, p->start_owner, p->cell_count * sizeof(uint32_t));
+	memcpy(p->parent, p->start_parent, p->cell_count * sizeof(uint32_t));
+	memcpy(p->areas, p->start_areas, players * sizeof(uint64_t));
+	memcpy(p->taken, p->start_taken, players * sizeof(uint64_t));
+	memcpy(p->used_golden, p->start_used_golden, players * sizeof(bool));
+	p->free_count = p->start_free_count;
+	for (uint32_t i = 0; i < p->free_count; i++) {
+		p->free_cells[i] = p->start_free_cells[i];
+		p->free_position[p->free_cells[i]] = i;
+	}
+
+	// only the cells left in the frontiers need clearing
+	for (uint32_t player = 1; player <= p->player_count; player++) {
+		uint64_t base = get_frontier_base(p, player);
+		for (uint32_t i = 0; i < p->frontier_size[player]; i++) {
+			p->frontier_position[base + p->frontier[base + i]] = ABSENT;
+		}
+		p->frontier_size[player] = 0;
+	}
+	for (uint32_t i = 0; i < p->free_count; i++) {
+		uint32_t cell = p->free_cells[i];
+		uint32_t neighbours[4] = {
+			cell - p->stride, cell + 1, cell + p->stride, cell - 1
+		};
+		for (int j = 0; j < 4; j++) {
+			uint32_t owner = p->owner[neighbours[j]];
+			if (owner != 0 && owner != BORDER) {
+				add_to_frontier(p, owner, cell);
+			}
+		}
+	}
+
+	uint64_t moves = 0;
+	uint32_t player = p->first_player;
+	uint32_t passes = 0;
+	while (passes < p->player_count) {
+		if (make_turn(p, player)) {
+			moves++;
+			passes = 0;
+		}
+		else {
+			passes++;
+		}
+		player = player == p->player_count ? 1 : player + 1;
+	}
+
+	memcpy(taken, p->taken + 1, p->player_count * sizeof(uint64_t));
+
+	return moves;
+}
+
+
+/**
+ * @brief Usuwa silnik losowych rozgrywek @p p.
+ * Nic nie robi, gdy @p p ma wartosc NULL.
+ *
+ * @param[in,out] p : usuwany silnik
+ */
+void playout_delete(playout_t *p) {
+	if (!p) {
+		return;
+	}
+
+	free(p->start_owner);
+	free(p->start_parent);
+	free(p->start_free_cells);
+	free(p->start_areas);
+	free(p->start_taken);
+	free(p->start_used_golden);
+	free(p->owner);
+	free(p->parent);
+	free(p->free_cells);
+	free(p->free_position);
+	free(p->areas);
+	free(p->taken);
+	free(p->used_golden);
+	free(p->frontier);
+	free(p->frontier_position);
+	free(p->frontier_size);
+	free(p->candidates);
+	free(p->queue);
+	free(p->visited);
+	free(p);
+}
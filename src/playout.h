@@ -0,0 +1,178 @@
+/** @file
+ * Interfejs modulu rozgrywajacego losowe partie gry gamma do konca
+ *
+ * @author Piotr Prabucki <pp418377@students.mimuw.edu.pl>
+ */
+
+
+#ifndef PLAYOUT_H
+#define PLAYOUT_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gamma.h"
+
+
+/**
+ * Maksymalny iloczyn liczby graczy i liczby pol planszy z ramka, czyli
+ * liczba miejsc na brzegi obszarow wszystkich graczy. Ogranicza pamiec
+ * zajmowana przez brzegi do 256 MiB.
+ */
+#define PLAYOUT_MAX_FRONTIER_CELLS ((uint64_t)1 << 25)
+
+
+/**
+ * @brief Silnik losowych rozgrywek.
+ * Przechowuje pozycje poczatkowa skopiowana z gry @ref gamma_t oraz
+ * zaalokowane raz tablice robocze, w ktorych kolejne rozgrywki sa prowadzone
+ * bez alokowania pamieci. Plansza jest otoczona ramka pol z wlascicielem
+ * spoza graczy, wiec sasiedzi pola nie wymagaja sprawdzania granic. Pola sa
+ * numerowane wierszami razem z ramka. Obszary graczy sa lasem Find & Union
+ * nad polami, przebudowywanym dla gracza, ktoremu zabrano pole zlotym
+ * ruchem. Dla kazdego gracza utrzymywany jest brzeg jego obszarow, czyli
+ * nadzbior sasiadujacych z nimi wolnych pol, z ktorego gracz z maksymalna
+ * liczba obszarow losuje ruch.
+ *
+ * @param width             : szerokosc planszy
+ * @param height            : wysokosc planszy
+ * @param player_count      : liczba graczy
+ * @param max_player_areas  : maksymalna liczba obszarow gracza
+ * @param stride            : szerokosc planszy z ramka
+ * @param cell_count        : liczba pol planszy z ramka
+ * @param first_player      : gracz, ktory wykonuje pierwszy ruch rozgrywki
+ * @param golden_threshold  : prog losowanej liczby 32-bitowej, ponizej
+ *                            ktorego gracz probuje zlotego ruchu (0 oznacza,
+ *                            ze zlote ruchy nie sa wykonywane)
+ * @param random_state      : stan generatora liczb pseudolosowych
+ * @param start_owner       : wlasciciele pol w pozycji poczatkowej
+ * @param start_parent      : las obszarow w pozycji poczatkowej
+ * @param start_free_cells  : wolne pola w pozycji poczatkowej
+ * @param start_free_count  : liczba wolnych pol w pozycji poczatkowej
+ * @param start_areas       : liczby obszarow graczy w pozycji poczatkowej
+ * @param start_taken       : liczby pol graczy w pozycji poczatkowej
+ * @param start_used_golden : wykorzystanie zlotych ruchow w pozycji
+ *                            poczatkowej
+ * @param owner             : wlasciciele pol w trakcie rozgrywki
+ * @param parent            : las obszarow w trakcie rozgrywki
+ * @param free_cells        : wolne pola w trakcie rozgrywki
+ * @param free_position     : pozycje pol w [free_cells]
+ * @param free_count        : liczba wolnych pol w trakcie rozgrywki
+ * @param areas             : liczby obszarow graczy w trakcie rozgrywki
+ * @param taken             : liczby pol graczy w trakcie rozgrywki
+ * @param used_golden       : wykorzystanie zlotych ruchow w trakcie
+ *                            rozgrywki
+ * @param frontier          : pola, ktore sasiadowaly z obszarami graczy,
+ *                            gdy byly wolne, po [cell_count] miejsc na
+ *                            gracza
+ * @param frontier_position : pozycje pol w [frontier] dla kazdego gracza
+ * @param frontier_size     : liczby pol w [frontier] dla kazdego gracza
+ * @param candidates        : pola zbierane przy wyborze ruchu
+ * @param queue             : kolejka przeszukiwania obszaru
+ * @param visited           : znaczniki odwiedzenia pol przez przeszukiwanie
+ * @param visit_mark        : znacznik biezacego przeszukiwania
+ */
+typedef struct playout {
+	uint32_t width;
+	uint32_t height;
+	uint32_t player_count;
+	uint32_t max_player_areas;
+	uint32_t stride;
+	uint32_t cell_count;
+	uint32_t first_player;
+	uint64_t golden_threshold;
+	uint64_t random_state;
+	uint32_t *start_owner;
+	uint32_t *start_parent;
+	uint32_t *start_free_cells;
+	uint32_t start_free_count;
+	uint64_t *start_areas;
+	uint64_t *start_taken;
+	bool *start_used_golden;
+	uint32_t *owner;
+	uint32_t *parent;
+	uint32_t *free_cells;
+	uint32_t *free_position;
+	uint32_t free_count;
+	uint64_t *areas;
+	uint64_t *taken;
+	bool *used_golden;
+	uint32_t *frontier;
+	uint32_t *frontier_position;
+	uint32_t *frontier_size;
+	uint32_t *candidates;
+	uint32_t *queue;
+	uint32_t *visited;
+	uint32_t visit_mark;
+} playout_t;
+
+
+/**
+ * @brief Tworzy silnik losowych rozgrywek z pozycja poczatkowa z gry @p g.
+ * W kazdym ruchu gracz wybiera z jednakowym prawdopodobienstwem jeden z
+ * ruchow, ktore moze wykonac. Z prawdopodobienstwem @p golden_probability
+ * najpierw probuje wykonac losowy zloty ruch, a gdy nie ma zwyklego ruchu,
+ * wykonuje zloty ruch, jesli jest to mozliwe. Przy @p golden_probability
+ * rownym 0 zlote ruchy nie sa wykonywane. Silnik zajmuje pamiec
+ * proporcjonalna do iloczynu liczby graczy i liczby pol planszy, wiec
+ * iloczyn ten nie moze przekraczac @ref PLAYOUT_MAX_FRONTIER_CELLS.
+ *
+ * @param[in] g                     : gra z pozycja poczatkowa
+ * @param[in] first_player          : gracz, ktory wykonuje pierwszy ruch
+ * @param[in] golden_probability    : prawdopodobienstwo proby zlotego ruchu,
+ *                                    liczba z przedzialu [0, 1]
+ * @param[in] seed                  : ziarno generatora liczb pseudolosowych
+ *
+ * @return Wskaznik na utworzony silnik lub NULL, gdy nie udalo sie
+ * zaalokowac pamieci, ktorys z parametrow jest niepoprawny, plansza z
+ * ramka ma co najmniej 2^32 - 1 pol lub iloczyn liczby graczy i liczby pol
+ * planszy z ramka przekracza @ref PLAYOUT_MAX_FRONTIER_CELLS.
+ */
+playout_t* playout_new(
+	gamma_t *g,
+	uint32_t first_player,
+	double golden_probability,
+	uint64_t seed
+);
+
+
+/**
+ * @brief Zmienia pozycje poczatkowa silnika @p p na pozycje z gry @p g.
+ * Gra musi miec takie same wymiary planszy, liczbe graczy i maksymalna
+ * liczbe obszarow jak gra, z ktorej utworzono silnik.
+ *
+ * @param[in,out] p         : silnik losowych rozgrywek
+ * @param[in] g             : gra z pozycja poczatkowa
+ * @param[in] first_player  : gracz, ktory wykonuje pierwszy ruch
+ *
+ * @return true, gdy pozycja zostala zmieniona, false gdy ktorys z
+ * parametrow jest niepoprawny.
+ */
+bool playout_set_position(playout_t *p, gamma_t *g, uint32_t first_player);
+
+
+/**
+ * @brief Rozgrywa jedna losowa partie od pozycji poczatkowej do konca.
+ * Gracze wykonuja ruchy po kolei, a gracz, ktory nie moze wykonac ruchu,
+ * jest pomijany. Partia konczy sie, gdy zaden gracz nie moze wykonac ruchu.
+ * Nie alokuje pamieci.
+ *
+ * @param[in,out] p     : silnik losowych rozgrywek
+ * @param[out] taken    : tablica na liczby pol zajetych na koncu partii
+ *                        przez kolejnych graczy (pod indeksem 0 gracz 1)
+ *
+ * @return Liczba ruchow wykonanych w partii.
+ */
+uint64_t playout_run(playout_t *p, uint64_t *taken);
+
+
+/**
+ * @brief Usuwa silnik losowych rozgrywek @p p.
+ * Nic nie robi, gdy @p p ma wartosc NULL.
+ *
+ * @param[in,out] p : usuwany silnik
+ */
+void playout_delete(playout_t *p);
+
+
+#endif /* PLAYOUT_H */
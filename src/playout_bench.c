@@ -0,0 +1,196 @@
+/** @file
+ * Pomiar szybkosci losowych rozgrywek przez @ref playout_run w porownaniu z
+ * rozgrywkami przez publiczny interfejs gry gamma
+ *
+ * @author Piotr Prabucki <pp418377@students.mimuw.edu.pl>
+ */
+
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "gamma.h"
+#include "playout.h"
+
+
+/**
+ * Liczba graczy.
+ */
+#define BENCH_PLAYERS 4
+/**
+ * Maksymalna liczba obszarow gracza.
+ */
+#define BENCH_AREAS 4
+/**
+ * Czas trwania kazdego pomiaru w sekundach.
+ */
+#define BENCH_SECONDS 1.0
+
+
+/**
+ * @brief Zbior pol, na ktore gracz moze postawic pionek.
+ *
+ * @param cells : pola zapisane jako x * 2^32 + y
+ * @param count : liczba pol
+ */
+typedef struct move_list {
+	uint64_t *cells;
+	uint64_t count;
+} move_list_t;
+
+
+/**
+ * @brief Zwraca czas w sekundach od ustalonej chwili.
+ *
+ * @return Czas w sekundach.
+ */
+double get_time(void) {
+	struct timespec now;
+	timespec_get(&now, TIME_UTC);
+
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+
+/**
+ * @brief Dopisuje pole (@p x, @p y) do zbioru @p data.
+ *
+ * @param[in,out] data  : zbior pol typu @ref move_list_t
+ * @param[in] x         : numer kolumny
+ * @param[in] y         : numer wiersza
+ *
+ * @return true, aby wyliczanie pol trwalo dalej.
+ */
+bool add_move(void *data, uint32_t x, uint32_t y) {
+	move_list_t *list = data;
+	list->cells[list->count++] = (uint64_t)x << 32 | y;
+
+	return true;
+}
+
+
+/**
+ * @brief Rozgrywa losowa partie bez zlotych ruchow w kopii gry @p g przez
+ * publiczny interfejs.
+ *
+ * @param[in] g         : gra z pozycja poczatkowa
+ * @param[in,out] list  : zbior pol na cale plansze
+ * @param[in,out] state : stan generatora liczb pseudolosowych, rozny od zera
+ */
+void run_public_playout(gamma_t *g, move_list_t *list, uint64_t *state) {
+	gamma_t *copy = gamma_clone(g);
+	if (!copy) {
+		exit(1);
+	}
+
+	uint32_t player = 1;
+	uint32_t passes = 0;
+	while (passes < BENCH_PLAYERS) {
+		list->count = 0;
+		gamma_legal_moves(copy, player, add_move, list);
+		if (list->count) {
+			*state ^= *state << 13;
+			*state ^= *state >> 7;
+			*state ^= *state << 17;
+			uint64_t cell = list->cells[*state % list->count];
+			gamma_move(copy, player, cell >> 32, (uint32_t)cell);
+			passes = 0;
+		}
+		else {
+			passes++;
+		}
+		player = player % BENCH_PLAYERS + 1;
+	}
+
+	gamma_delete(copy);
+}
+
+
+/**
+ * @brief Wypisuje liczbe losowych rozgrywek na sekunde na pustej planszy
+ * @p side x @p side.
+ *
+ * @param[in] side                  : bok planszy
+ * @param[in] golden_probability    : prawdopodobienstwo proby zlotego ruchu
+ * @param[in] public_api            : czy mierzyc tez rozgrywki przez
+ *                                    publiczny interfejs
+ */
+void bench_board(uint32_t side, double golden_probability, bool public_api) {
+	gamma_t *g = gamma_new(side, side, BENCH_PLAYERS, BENCH_AREAS);
+	playout_t *p = playout_new(g, 1, golden_probability, 42);
+	if (!g || !p) {
+		exit(1);
+	}
+
+	uint64_t taken[BENCH_PLAYERS];
+	uint64_t playouts = 0;
+	uint64_t moves = 0;
+	double start = get_time();
+	double elapsed;
+	do {
+		for (int i = 0; i < 1000; i++) {
+			moves += playout_run(p, taken);
+		}
+		playouts += 1000;
+		elapsed = get_time() - start;
+	} while (elapsed < BENCH_SECONDS);
+
+	printf(
+		"%2u x %-2u golden %.2f playout_run: %10.0f playouts/s "
+		"(%.1f moves each)\n",
+		side,
+		side,
+		golden_probability,
+		playouts / elapsed,
+		(double)moves / playouts
+	);
+
+	if (public_api) {
+		move_list_t list;
+		list.cells = malloc((uint64_t)side * side * sizeof(uint64_t));
+		if (!list.cells) {
+			exit(1);
+		}
+
+		uint64_t state = 88172645463325252ull;
+		playouts = 0;
+		start = get_time();
+		do {
+			for (int i = 0; i < 100; i++) {
+				run_public_playout(g, &list, &state);
+			}
+			playouts += 100;
+			elapsed = get_time() - start;
+		} while (elapsed < BENCH_SECONDS);
+
+		printf(
+			"%2u x %-2u golden %.2f gamma_move : %10.0f playouts/s\n",
+			side,
+			side,
+			0.0,
+			playouts / elapsed
+		);
+		free(list.cells);
+	}
+
+	playout_delete(p);
+	gamma_delete(g);
+}
+
+
+/**
+ * @brief Wypisuje szybkosc losowych rozgrywek na planszach 10 x 10 i
+ * 19 x 19.
+ *
+ * @return Zero.
+ */
+int main() {
+	printf("%d players, at most %d areas each\n", BENCH_PLAYERS, BENCH_AREAS);
+	bench_board(10, 0, true);
+	bench_board(10, 0.1, false);
+	bench_board(19, 0, true);
+	bench_board(19, 0.1, false);
+
+	return 0;
+}
@@ -0,0 +1,389 @@
+/** @file
+ * Implementacja zamiany komorek tablicy planszy na tekstowy opis planszy
+ *
+ * @author Piotr Prabucki <pp418377@students.mimuw.edu.pl>
+ */
+
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include "render_util.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+
+/**
+ * Zapisy dziesietne liczb od 0 do 99, po dwa znaki na liczbe.
+ */
+static const char digit_pairs[201] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+
+/**
+ * @brief Zwraca wartosc komorki o indeksie [index] z ciagu komorek [cells] o
+ * rozmiarze [cell_size].
+ *
+ * @param[in] cells     : komorki
+ * @param[in] cell_size : rozmiar komorki w bajtach (1, 2, 4 lub 8)
+ * @param[in] index     : indeks komorki
+ *
+ * @return Wartosc komorki.
+ */
+uint64_t load_render_cell(
+	const void *cells,
+	uint8_t cell_size,
+	uint64_t index
+) {
+	switch (cell_size) {
+		case 1:
+			return ((const uint8_t*)cells)[index];
+		case 2:
+			return ((const uint16_t*)cells)[index];
+		case 4:
+			return ((const uint32_t*)cells)[index];
+		default:
+			return ((const uint64_t*)cells)[index];
+	}
+}
+
+
+/**
+ * @brief Zapisuje do napisu @p string opis pola zajetego przez gracza
+ * @p owner.
+ * Pole wolne jest opisywane kropka, pole gracza o numerze mniejszym niz 10 -
+ * cyfra, a pozostale pola - numerem gracza w nawiasach kwadratowych. Cyfry
+ * numeru sa brane parami z tablicy @ref digit_pairs.
+ *
+ * @param[out] string   : napis, do ktorego zapisujemy opis pola, musi miec
+ *                        miejsce na co najmniej @ref MAX_FIELD_LENGTH znakow
+ * @param[in] owner     : numer gracza zajmujacego pole lub 0
+ *
+ * @return Liczba zapisanych znakow.
+ */
+uint64_t render_field(char *string, uint32_t owner) {
+	if (owner == 0) {
+		string[0] = '.';
+		return 1;
+	}
+	else if (owner < 10) {
+		string[0] = owner + '0';
+		return 1;
+	}
+
+	// cyfry zajmuja pozycje od 1 do [digits], zapisujemy je od konca parami
+	uint32_t digits = count_digits(owner);
+	uint32_t position = digits;
+	while (owner >= 100) {
+		uint32_t pair = owner % 100;
+		owner /= 100;
+		memcpy(string + position - 1, digit_pairs + 2 * pair, 2);
+		position -= 2;
+	}
+	if (owner >= 10) {
+		memcpy(string + position - 1, digit_pairs + 2 * owner, 2);
+	}
+	else {
+		string[position] = owner + '0';
+	}
+	string[0] = '[';
+	string[digits + 1] = ']';
+
+	return digits + 2;
+}
+
+
+/**
+ * @brief Zapisuje do napisu @p string zapis dziesietny liczby @p number.
+ * Cyfry sa skladane od konca parami z tablicy @ref digit_pairs w buforze
+ * pomocniczym, a potem kopiowane na poczatek napisu.
+ *
+ * @param[out] string   : napis, do ktorego zapisujemy liczbe, musi miec
+ *                        miejsce na co najmniej @ref MAX_NUMBER_LENGTH znakow
+ * @param[in] number    : zapisywana liczba
+ *
+ * @return Liczba zapisanych znakow.
+ */
+uint64_t render_number(char *string, uint64_t number) {
+	char digits[MAX_NUMBER_LENGTH];
+	uint64_t position = MAX_NUMBER_LENGTH;
+	while (number >= 100) {
+		position -= 2;
+		memcpy(digits + position, digit_pairs + 2 * (number % 100), 2);
+		number /= 100;
+	}
+	if (number >= 10) {
+		position -= 2;
+		memcpy(digits + position, digit_pairs + 2 * number, 2);
+	}
+	else {
+		digits[--position] = number + '0';
+	}
+
+	uint64_t length = MAX_NUMBER_LENGTH - position;
+	memcpy(string, digits + position, length);
+
+	return length;
+}
+
+
+/**
+ * @brief Zapisuje do napisu [string] opisy 8 pol o jednobajtowych komorkach
+ * [cells], jesli wszystkie sa mniejsze niz 10.
+ * Bajty sa przetwarzane naraz w jednym slowie 64-bitowym, wiec dziala to bez
+ * instrukcji wektorowych.
+ *
+ * @param[out] string   : napis, do ktorego zapisujemy opisy pol
+ * @param[in] cells     : komorki
+ *
+ * @return Wartosc @p true, jesli opisy zostaly zapisane, a @p false, gdy
+ * ktoras komorka jest wieksza niz 9.
+ */
+bool render_small_bytes_word(char *string, const uint8_t *cells) {
+	const uint64_t ones = 0x0101010101010101ull;
+	const uint64_t high = 0x8080808080808080ull;
+	uint64_t word;
+	memcpy(&word, cells, sizeof(word));
+
+	// bajt b < 10 wtedy i tylko wtedy, gdy b + 118 < 128 i b < 128
+	if (((word + 118 * ones) | word) & high) {
+		return false;
+	}
+
+	// najwyzszy bit bajtu b + 127 jest zapalony wtedy i tylko wtedy, gdy b > 0
+	uint64_t empty = ~(word + 127 * ones) & high;
+	word = word + '0' * ones - (empty >> 6);
+	memcpy(string, &word, sizeof(word));
+
+	return true;
+}
+
+
+#ifdef __SSE2__
+/**
+ * @brief Wczytuje 16 kolejnych komorek z [cells] jako bajty, jesli wszystkie
+ * sa mniejsze niz 10.
+ *
+ * @param[in] cells     : komorki
+ * @param[in] cell_size : rozmiar komorki w bajtach (1, 2 lub 4)
+ * @param[out] bytes    : wartosci komorek, po jednym bajcie na komorke
+ *
+ * @return Wartosc @p true, jesli wszystkie komorki sa mniejsze niz 10, a
+ * @p false w przeciwnym przypadku.
+ */
+bool load_small_cells(const void *cells, uint8_t cell_size, __m128i *bytes) {
+	const __m128i *vectors = cells;
+	__m128i v;
+	if (cell_size == 1) {
+		v = _mm_loadu_si128(vectors);
+	}
+	else if (cell_size == 2) {
+		__m128i a = _mm_loadu_si128(vectors);
+		__m128i b = _mm_loadu_si128(vectors + 1);
+		// wartosci mniejsze niz 16 mieszcza sie w bajcie bez nasycenia
+		__m128i all = _mm_or_si128(a, b);
+		__m128i high = _mm_andnot_si128(_mm_set1_epi16(0xF), all);
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(high, _mm_setzero_si128()))
+			!= 0xFFFF) {
+			return false;
+		}
+		v = _mm_packus_epi16(a, b);
+	}
+	else {
+		__m128i a = _mm_loadu_si128(vectors);
+		__m128i b = _mm_loadu_si128(vectors + 1);
+		__m128i c = _mm_loadu_si128(vectors + 2);
+		__m128i d = _mm_loadu_si128(vectors + 3);
+		__m128i all = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+		__m128i high = _mm_andnot_si128(_mm_set1_epi32(0xF), all);
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(high, _mm_setzero_si128()))
+			!= 0xFFFF) {
+			return false;
+		}
+		v = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+	}
+
+	// komorka jest mniejsza niz 10 wtedy i tylko wtedy, gdy odjecie 9 z
+	// nasyceniem daje 0
+	__m128i excess = _mm_subs_epu8(v, _mm_set1_epi8(9));
+	if (_mm_movemask_epi8(_mm_cmpeq_epi8(excess, _mm_setzero_si128()))
+		!= 0xFFFF) {
+		return false;
+	}
+
+	*bytes = v;
+	return true;
+}
+
+
+/**
+ * @brief Zamienia 16 bajtow o wartosciach mniejszych niz 10 na znaki opisu
+ * pol: 0 na kropke, a pozostale wartosci na cyfry.
+ *
+ * @param[in] bytes : wartosci komorek
+ *
+ * @return Znaki opisu pol.
+ */
+__m128i get_small_field_chars(__m128i bytes) {
+	// '.' = '0' - 2, a 0xFE to -2 w arytmetyce bajtow
+	__m128i empty = _mm_cmpeq_epi8(bytes, _mm_setzero_si128());
+	return _mm_add_epi8(
+		_mm_add_epi8(bytes, _mm_set1_epi8('0')),
+		_mm_and_si128(empty, _mm_set1_epi8((char)0xFE))
+	);
+}
+#endif /* __SSE2__ */
+
+
+#ifdef __AVX2__
+/**
+ * @brief Zapisuje do napisu [string] opisy 32 pol o jednobajtowych komorkach
+ * [cells], jesli wszystkie sa mniejsze niz 10.
+ *
+ * @param[out] string   : napis, do ktorego zapisujemy opisy pol
+ * @param[in] cells     : komorki
+ *
+ * @return Wartosc @p true, jesli opisy zostaly zapisane, a @p false, gdy
+ * ktoras komorka jest wieksza niz 9.
+ */
+bool render_small_bytes_wide(char *string, const uint8_t *cells) {
+	__m256i v = _mm256_loadu_si256((const __m256i*)cells);
+	__m256i zero = _mm256_setzero_si256();
+	__m256i excess = _mm256_subs_epu8(v, _mm256_set1_epi8(9));
+	if ((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(excess, zero))
+		!= UINT32_MAX) {
+		return false;
+	}
+
+	__m256i empty = _mm256_cmpeq_epi8(v, zero);
+	__m256i chars = _mm256_add_epi8(
+		_mm256_add_epi8(v, _mm256_set1_epi8('0')),
+		_mm256_and_si256(empty, _mm256_set1_epi8((char)0xFE))
+	);
+	_mm256_storeu_si256((__m256i*)string, chars);
+
+	return true;
+}
+#endif /* __AVX2__ */
+
+
+/**
+ * @brief Zapisuje do napisu @p string opisy @p count kolejnych pol, ktorych
+ * wlasciciele leza w pamieci jeden za drugim w komorkach o rozmiarze
+ * @p cell_size.
+ * Pola sa brane szesnastkami (przy AVX2 i jednobajtowych komorkach -
+ * trzydziestkami dwojkami); gdy wszystkie pola grupy naleza do graczy
+ * mniejszych niz 10, sa zamieniane na tekst jednym zapisem wektorowym, a w
+ * przeciwnym przypadku kazde pole jest opisywane przez @ref render_field.
+ * Reszta jednobajtowych komorek jest brana osemkami przez
+ * @ref render_small_bytes_word.
+ *
+ * @param[out] string   : napis, do ktorego zapisujemy opisy pol, musi miec
+ *                        miejsce na @p count * @ref MAX_FIELD_LENGTH znakow
+ * @param[in] cells     : komorki z numerami graczy
+ * @param[in] cell_size : rozmiar komorki w bajtach (1, 2, 4 lub 8)
+ * @param[in] count     : liczba pol
+ *
+ * @return Liczba zapisanych znakow.
+ */
+uint64_t render_cells(
+	char *string,
+	const void *cells,
+	uint8_t cell_size,
+	uint64_t count
+) {
+	const uint8_t *bytes = cells;
+	uint64_t length = 0;
+	uint64_t i = 0;
+
+#ifdef __AVX2__
+	if (cell_size == 1) {
+		while (i + 32 <= count && render_small_bytes_wide(string + length,
+			bytes + i)) {
+			length += 32;
+			i += 32;
+		}
+	}
+#endif
+
+#ifdef __SSE2__
+	if (cell_size <= 4) {
+		while (i + 16 <= count) {
+			__m128i small;
+			if (load_small_cells(bytes + i * cell_size, cell_size, &small)) {
+				_mm_storeu_si128((__m128i*)(string + length),
+					get_small_field_chars(small));
+				length += 16;
+				i += 16;
+				continue;
+			}
+
+			for (uint64_t end = i + 16; i < end; i++) {
+				length += render_field(string + length,
+					load_render_cell(cells, cell_size, i));
+			}
+		}
+	}
+#endif
+
+	if (cell_size == 1) {
+		while (i + 8 <= count && render_small_bytes_word(string + length,
+			bytes + i)) {
+			length += 8;
+			i += 8;
+		}
+	}
+
+	for (; i < count; i++) {
+		length += render_field(string + length,
+			load_render_cell(cells, cell_size, i));
+	}
+
+	return length;
+}
+
+
+/**
+ * @brief Zapisuje cala zawartosc bufora @p buffer do deskryptora @p fd.
+ * Ponawia zapis po przerwaniu przez sygnal i po zapisaniu tylko czesci
+ * bufora.
+ *
+ * @param[in] fd        : deskryptor pliku, do ktorego zapisujemy
+ * @param[in] buffer    : zapisywany bufor
+ * @param[in] size      : liczba znakow w buforze
+ *
+ * @return Wartosc @p true, jesli udalo sie zapisac caly bufor, a @p false w
+ * przeciwnym przypadku.
+ */
+bool write_buffer(int fd, const char *buffer, uint64_t size) {
+	while (size > 0) {
+		ssize_t written = write(fd, buffer, size);
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+
+		buffer += written;
+		size -= written;
+	}
+
+	return true;
+}
@@ -0,0 +1,125 @@
+/** @file
+ * Interfejs modulu zamieniajacego komorki tablicy planszy na tekstowy opis
+ * planszy
+ *
+ * @author Piotr Prabucki <pp418377@students.mimuw.edu.pl>
+ */
+
+
+#ifndef RENDER_UTIL_H
+#define RENDER_UTIL_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/**
+ * Najwieksza liczba znakow opisu jednego pola: nawiasy i 10 cyfr numeru
+ * gracza.
+ */
+#define MAX_FIELD_LENGTH 12
+/**
+ * Najwieksza liczba cyfr dziesietnych liczby 64-bitowej.
+ */
+#define MAX_NUMBER_LENGTH 20
+
+
+/**
+ * @brief Zwraca liczbe cyfr dziesietnych liczby [number].
+ *
+ * @param[in] number    : liczba, ktorej cyfry liczymy
+ *
+ * @return Liczba cyfr, co najmniej 1.
+ */
+static inline uint32_t count_digits(uint32_t number) {
+	uint32_t digits = 1;
+	for (uint64_t bound = 10; number >= bound; bound *= 10) {
+		digits++;
+	}
+
+	return digits;
+}
+
+
+/**
+ * @brief Zwraca liczbe znakow, o ktora opis pola gracza [owner] jest dluzszy
+ * niz jeden znak.
+ *
+ * @param[in] owner     : numer gracza zajmujacego pole lub 0
+ *
+ * @return 0 dla pola wolnego i graczy mniejszych niz 10, a w przeciwnym
+ * przypadku liczba cyfr numeru gracza powiekszona o 1 (nawiasy).
+ */
+static inline uint64_t get_bracket_space(uint32_t owner) {
+	return owner < 10 ? 0 : count_digits(owner) + 1;
+}
+
+
+/**
+ * @brief Zapisuje do napisu @p string opis pola zajetego przez gracza
+ * @p owner.
+ * Pole wolne jest opisywane kropka, pole gracza o numerze mniejszym niz 10 -
+ * cyfra, a pozostale pola - numerem gracza w nawiasach kwadratowych.
+ *
+ * @param[out] string   : napis, do ktorego zapisujemy opis pola, musi miec
+ *                        miejsce na co najmniej @ref MAX_FIELD_LENGTH znakow
+ * @param[in] owner     : numer gracza zajmujacego pole lub 0
+ *
+ * @return Liczba zapisanych znakow.
+ */
+uint64_t render_field(char *string, uint32_t owner);
+
+
+/**
+ * @brief Zapisuje do napisu @p string zapis dziesietny liczby @p number.
+ *
+ * @param[out] string   : napis, do ktorego zapisujemy liczbe, musi miec
+ *                        miejsce na co najmniej @ref MAX_NUMBER_LENGTH znakow
+ * @param[in] number    : zapisywana liczba
+ *
+ * @return Liczba zapisanych znakow.
+ */
+uint64_t render_number(char *string, uint64_t number);
+
+
+/**
+ * @brief Zapisuje do napisu @p string opisy @p count kolejnych pol, ktorych
+ * wlasciciele leza w pamieci jeden za drugim w komorkach o rozmiarze
+ * @p cell_size.
+ * Ciagi pol graczy mniejszych niz 10 sa zamieniane na tekst instrukcjami
+ * wektorowymi, gdy kompilator je udostepnia.
+ *
+ * @param[out] string   : napis, do ktorego zapisujemy opisy pol, musi miec
+ *                        miejsce na @p count * @ref MAX_FIELD_LENGTH znakow
+ * @param[in] cells     : komorki z numerami graczy
+ * @param[in] cell_size : rozmiar komorki w bajtach (1, 2, 4 lub 8)
+ * @param[in] count     : liczba pol
+ *
+ * @return Liczba zapisanych znakow.
+ */
+uint64_t render_cells(
+	char *string,
+	const void *cells,
+	uint8_t cell_size,
+	uint64_t count
+);
+
+
+
+/**
+ * @brief Zapisuje cala zawartosc bufora @p buffer do deskryptora @p fd.
+ * Ponawia zapis po przerwaniu przez sygnal i po zapisaniu tylko czesci
+ * bufora.
+ *
+ * @param[in] fd        : deskryptor pliku, do ktorego zapisujemy
+ * @param[in] buffer    : zapisywany bufor
+ * @param[in] size      : liczba znakow w buforze
+ *
+ * @return Wartosc @p true, jesli udalo sie zapisac caly bufor, a @p false w
+ * przeciwnym przypadku.
+ */
+bool write_buffer(int fd, const char *buffer, uint64_t size);
+
+
+#endif /* RENDER_UTIL_H */
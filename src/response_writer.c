@@ -0,0 +1,153 @@
+/** @file
+ * Implementacja modulu buforujacego odpowiedzi na polecenia trybu wsadowego
+ *
+ * @author Piotr Prabucki <pp418377@students.mimuw.edu.pl>
+ */
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "render_util.h"
+#include "response_writer.h"
+
+
+/**
+ * @brief Sprawdza, czy deskryptory @p fd1 i @p fd2 prowadza do tego samego
+ * pliku.
+ *
+ * @param[in] fd1   : pierwszy deskryptor
+ * @param[in] fd2   : drugi deskryptor
+ *
+ * @return Wartosc @p true, jesli oba deskryptory prowadza do tego samego
+ * pliku, a @p false w przeciwnym przypadku lub gdy nie udalo sie tego
+ * sprawdzic.
+ */
+bool is_same_file(int fd1, int fd2) {
+	struct stat stat1, stat2;
+	if (fstat(fd1, &stat1) != 0 || fstat(fd2, &stat2) != 0) {
+		return false;
+	}
+
+	return stat1.st_dev == stat2.st_dev && stat1.st_ino == stat2.st_ino;
+}
+
+
+/**
+ * @brief Inicjalizuje bufor @p buffer zapisujacy do deskryptora @p fd.
+ * Konczy program z kodem 1, gdy nie udalo sie zaalokowac pamieci.
+ *
+ * @param[out] buffer   : inicjalizowany bufor
+ * @param[in] fd        : deskryptor pliku, do ktorego zapisujemy
+ */
+void response_buffer_init(response_buffer_t *buffer, int fd) {
+	buffer->fd = fd;
+	buffer->length = 0;
+	buffer->buffer = malloc(RESPONSE_BUFFER_SIZE);
+	if (!buffer->buffer) {
+		exit(1);
+	}
+}
+
+
+/**
+ * @brief Zapisuje zawartosc bufora @p buffer do jego deskryptora.
+ * Gdy zapis sie nie powiedzie, zawartosc bufora jest porzucana.
+ *
+ * @param[in,out] buffer    : oprozniany bufor
+ */
+void flush_response_buffer(response_buffer_t *buffer) {
+	if (buffer->length > 0) {
+		write_buffer(buffer->fd, buffer->buffer, buffer->length);
+		buffer->length = 0;
+	}
+}
+
+
+/**
+ * @brief Inicjalizuje bufory @p writer zapisujace do deskryptorow
+ * @p output_fd i @p error_fd.
+ * Konczy program z kodem 1, gdy nie udalo sie zaalokowac pamieci.
+ *
+ * @param[out] writer   : inicjalizowane bufory
+ * @param[in] output_fd : deskryptor standardowego wyjscia
+ * @param[in] error_fd  : deskryptor standardowego wyjscia diagnostycznego
+ * @param[in] autoflush : czy bufory maja byc oprozniane po kazdym poleceniu
+ */
+void response_writer_init(
+	response_writer_t *writer,
+	int output_fd,
+	int error_fd,
+	bool autoflush
+) {
+	writer->shared = is_same_file(output_fd, error_fd);
+	writer->autoflush = autoflush;
+	response_buffer_init(&writer->buffers[OUTPUT], output_fd);
+	if (writer->shared) {
+		writer->buffers[ERROR_OUTPUT] =
+			(response_buffer_t){.fd = error_fd, .buffer = NULL, .length = 0};
+	}
+	else {
+		response_buffer_init(&writer->buffers[ERROR_OUTPUT], error_fd);
+	}
+}
+
+
+/**
+ * @brief Oproznia bufory @p writer i zwalnia zaalokowana na nie pamiec.
+ *
+ * @param[in,out] writer    : zwalniane bufory
+ */
+void response_writer_free(response_writer_t *writer) {
+	flush_responses(writer);
+	free(writer->buffers[OUTPUT].buffer);
+	free(writer->buffers[ERROR_OUTPUT].buffer);
+}
+
+
+/**
+ * @brief Dopisuje do strumienia @p stream odpowiedz skladajaca sie z
+ * przedrostka @p prefix, liczby @p number i znaku konca linii.
+ * Nie alokuje pamieci; bufor jest oprozniany, gdy brakuje w nim miejsca.
+ *
+ * @param[in,out] writer    : bufory odpowiedzi
+ * @param[in] stream        : strumien, do ktorego trafia odpowiedz
+ * @param[in] prefix        : przedrostek odpowiedzi, np. "ERROR "
+ * @param[in] number        : liczba wypisywana po przedrostku
+ */
+void write_response(
+	response_writer_t *writer,
+	response_stream_t stream,
+	const char *prefix,
+	uint64_t number
+) {
+	response_buffer_t *buffer =
+		&writer->buffers[writer->shared ? OUTPUT : stream];
+	if (buffer->length + MAX_RESPONSE_LENGTH > RESPONSE_BUFFER_SIZE) {
+		flush_response_buffer(buffer);
+	}
+
+	char *end = buffer->buffer + buffer->length;
+	uint64_t prefix_length = strlen(prefix);
+	memcpy(end, prefix, prefix_length);
+	end += prefix_length;
+	end += render_number(end, number);
+	*end++ = '\n';
+
+	buffer->length = end - buffer->buffer;
+}
+
+
+/**
+ * @brief Zapisuje zawartosc buforow @p writer do ich deskryptorow.
+ *
+ * @param[in,out] writer    : bufory odpowiedzi
+ */
+void flush_responses(response_writer_t *writer) {
+	flush_response_buffer(&writer->buffers[OUTPUT]);
+	if (!writer->shared) {
+		flush_response_buffer(&writer->buffers[ERROR_OUTPUT]);
+	}
+}
@@ -0,0 +1,120 @@
+/** @file
+ * Interfejs modulu buforujacego odpowiedzi na polecenia trybu wsadowego
+ *
+ * @author Piotr Prabucki <pp418377@students.mimuw.edu.pl>
+ */
+
+
+#ifndef RESPONSE_WRITER_H
+#define RESPONSE_WRITER_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/**
+ * Rozmiar bufora jednego strumienia wyjscia.
+ */
+#define RESPONSE_BUFFER_SIZE (1 << 16)
+/**
+ * Najwieksza dlugosc jednej odpowiedzi: przedrostek, liczba i znak konca
+ * linii.
+ */
+#define MAX_RESPONSE_LENGTH 32
+
+
+/**
+ * @brief Strumien, do ktorego trafia odpowiedz.
+ * OUTPUT (standardowe wyjscie)
+ * ERROR_OUTPUT (standardowe wyjscie diagnostyczne)
+ */
+typedef enum response_stream {
+	OUTPUT,
+	ERROR_OUTPUT
+} response_stream_t;
+
+
+/**
+ * @brief Bufor odpowiedzi jednego strumienia.
+ *
+ * @param fd        : deskryptor pliku, do ktorego zapisujemy
+ * @param buffer    : bufor
+ * @param length    : liczba znakow w buforze
+ */
+typedef struct response_buffer {
+	int fd;
+	char *buffer;
+	uint64_t length;
+} response_buffer_t;
+
+
+/**
+ * @brief Bufory odpowiedzi na polecenia.
+ * Gdy oba strumienie prowadza do tego samego pliku, odpowiedzi trafiaja do
+ * wspolnego bufora, wiec zachowuja kolejnosc, w jakiej zostaly wydane.
+ *
+ * @param buffers   : bufory strumieni @ref OUTPUT i @ref ERROR_OUTPUT
+ * @param shared    : czy oba strumienie korzystaja z bufora @ref OUTPUT
+ * @param autoflush : czy bufory maja byc oprozniane po kazdym poleceniu
+ */
+typedef struct response_writer {
+	response_buffer_t buffers[2];
+	bool shared;
+	bool autoflush;
+} response_writer_t;
+
+
+/**
+ * @brief Inicjalizuje bufory @p writer zapisujace do deskryptorow
+ * @p output_fd i @p error_fd.
+ * Konczy program z kodem 1, gdy nie udalo sie zaalokowac pamieci.
+ *
+ * @param[out] writer   : inicjalizowane bufory
+ * @param[in] output_fd : deskryptor standardowego wyjscia
+ * @param[in] error_fd  : deskryptor standardowego wyjscia diagnostycznego
+ * @param[in] autoflush : czy bufory maja byc oprozniane po kazdym poleceniu
+ */
+void response_writer_init(
+	response_writer_t *writer,
+	int output_fd,
+	int error_fd,
+	bool autoflush
+);
+
+
+/**
+ * @brief Oproznia bufory @p writer i zwalnia zaalokowana na nie pamiec.
+ *
+ * @param[in,out] writer    : zwalniane bufory
+ */
+void response_writer_free(response_writer_t *writer);
+
+
+/**
+ * @brief Dopisuje do strumienia @p stream odpowiedz skladajaca sie z
+ * przedrostka @p prefix, liczby @p number i znaku konca linii.
+ * Nie alokuje pamieci; bufor jest oprozniany, gdy brakuje w nim miejsca.
+ *
+ * @param[in,out] writer    : bufory odpowiedzi
+ * @param[in] stream        : strumien, do ktorego trafia odpowiedz
+ * @param[in] prefix        : przedrostek odpowiedzi, np. "ERROR "
+ * @param[in] number        : liczba wypisywana po przedrostku
+ */
+void write_response(
+	response_writer_t *writer,
+	response_stream_t stream,
+	const char *prefix,
+	uint64_t number
+);
+
+
+/**
+ * @brief Zapisuje zawartosc buforow @p writer do ich deskryptorow.
+ *
+ * @param[in,out] writer    : bufory odpowiedzi
+ */
+void flush_responses(response_writer_t *writer);
+
+
+#endif /* RESPONSE_WRITER_H */
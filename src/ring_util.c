@@ -0,0 +1,163 @@
+/** @file
+ * Implementacja modulu kolejek cyklicznych laczacych dwa watki
+ *
+ * @author Piotr Prabucki <pp418377@students.mimuw.edu.pl>
+ */
+
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ring_util.h"
+
+
+/**
+ * Liczba obrotow petli oczekiwania, po ktorych watek zaczyna ustepowac
+ * procesora.
+ */
+#define SPINS_BEFORE_YIELD 64
+/**
+ * Liczba obrotow petli oczekiwania, po ktorych watek zaczyna zasypiac, by nie
+ * zajmowac procesora, gdy drugi watek dlugo nie odpowiada.
+ */
+#define SPINS_BEFORE_SLEEP (1 << 14)
+/**
+ * Dlugosc drzemki watku w petli oczekiwania w nanosekundach.
+ */
+#define SLEEP_NANOSECONDS 50000
+
+
+/**
+ * @brief Inicjalizuje pusta kolejke @p ring na @p capacity rekordow o
+ * rozmiarze @p record_size.
+ * Konczy program z kodem 1, gdy nie udalo sie zaalokowac pamieci.
+ *
+ * @param[out] ring         : inicjalizowana kolejka
+ * @param[in] record_size   : rozmiar rekordu w bajtach
+ * @param[in] capacity      : pojemnosc kolejki, potega dwojki
+ */
+void spsc_ring_init(
+	spsc_ring_t *ring,
+	uint64_t record_size,
+	uint64_t capacity
+) {
+	atomic_init(&ring->head, 0);
+	atomic_init(&ring->tail, 0);
+	atomic_init(&ring->closed, false);
+	ring->cached_tail = 0;
+	ring->cached_head = 0;
+	ring->record_size = record_size;
+	ring->mask = capacity - 1;
+	ring->records = malloc(capacity * record_size);
+	if (!ring->records) {
+		exit(1);
+	}
+}
+
+
+/**
+ * @brief Zwalnia pamiec zaalokowana na kolejke @p ring.
+ *
+ * @param[in,out] ring  : zwalniana kolejka
+ */
+void spsc_ring_free(spsc_ring_t *ring) {
+	free(ring->records);
+}
+
+
+/**
+ * @brief Dodaje na koniec kolejki @p ring kopie rekordu @p record.
+ * Czeka, dopoki kolejka jest pelna. Wywolywana tylko przez watek piszacy.
+ *
+ * @param[in,out] ring  : kolejka
+ * @param[in] record    : dodawany rekord
+ */
+void spsc_ring_push(spsc_ring_t *ring, const void *record) {
+	uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	uint64_t spins = 0;
+	while (tail - ring->cached_head > ring->mask) {
+		ring->cached_head =
+			atomic_load_explicit(&ring->head, memory_order_acquire);
+		if (tail - ring->cached_head > ring->mask) {
+			wait_a_moment(&spins);
+		}
+	}
+
+	memcpy(ring->records + (tail & ring->mask) * ring->record_size, record,
+		ring->record_size);
+	atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+}
+
+
+/**
+ * @brief Zdejmuje rekord z poczatku kolejki @p ring i zapisuje go w
+ * @p record.
+ * Czeka, dopoki kolejka jest pusta, a piszacy jej nie zamknal. Wywolywana
+ * tylko przez watek czytajacy.
+ *
+ * @param[in,out] ring  : kolejka
+ * @param[out] record   : miejsce na zdjety rekord
+ *
+ * @return Wartosc @p true, jesli zdjelismy rekord, a @p false, gdy kolejka
+ * jest pusta i zamknieta.
+ */
+bool spsc_ring_pop(spsc_ring_t *ring, void *record) {
+	uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	uint64_t spins = 0;
+	while (head == ring->cached_tail) {
+		// zamkniecie jest zapisywane po ostatnim rekordzie, wiec sprawdzamy
+		// je przed ponownym odczytaniem konca kolejki
+		bool closed =
+			atomic_load_explicit(&ring->closed, memory_order_acquire);
+		ring->cached_tail =
+			atomic_load_explicit(&ring->tail, memory_order_acquire);
+		if (head == ring->cached_tail) {
+			if (closed) {
+				return false;
+			}
+			wait_a_moment(&spins);
+		}
+	}
+
+	memcpy(record, ring->records + (head & ring->mask) * ring->record_size,
+		ring->record_size);
+	atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+	return true;
+}
+
+
+/**
+ * @brief Zamyka kolejke @p ring: czytajacy po zdjeciu pozostalych rekordow
+ * przestaje czekac na nastepne. Wywolywana tylko przez watek piszacy.
+ *
+ * @param[in,out] ring  : zamykana kolejka
+ */
+void spsc_ring_close(spsc_ring_t *ring) {
+	atomic_store_explicit(&ring->closed, true, memory_order_release);
+}
+
+
+/**
+ * @brief Ustepuje procesora innym watkom w petli oczekiwania.
+ * Pierwsze obroty petli tylko kreca sie w miejscu, bo drugi watek zwykle
+ * odpowiada szybciej niz trwa przelaczenie watkow.
+ *
+ * @param[in,out] spins : liczba dotychczasowych obrotow petli oczekiwania
+ */
+void wait_a_moment(uint64_t *spins) {
+	(*spins)++;
+	if (*spins >= SPINS_BEFORE_SLEEP) {
+		struct timespec pause = {.tv_sec = 0, .tv_nsec = SLEEP_NANOSECONDS};
+		nanosleep(&pause, NULL);
+	}
+	else if (*spins >= SPINS_BEFORE_YIELD) {
+		sched_yield();
+	}
+}
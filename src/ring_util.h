@@ -0,0 +1,115 @@
+/** @file
+ * Interfejs modulu kolejek cyklicznych laczacych dwa watki
+ *
+ * @author Piotr Prabucki <pp418377@students.mimuw.edu.pl>
+ */
+
+
+#ifndef RING_UTIL_H
+#define RING_UTIL_H
+
+
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/**
+ * @brief Kolejka cykliczna rekordow stalego rozmiaru dla jednego watku
+ * piszacego i jednego czytajacego, bez blokad.
+ * Pozycje rosna bez konca, a indeks w tablicy to pozycja modulo pojemnosc.
+ * Pola kazdego z watkow leza w osobnych liniach pamieci podrecznej; kazdy
+ * watek pamieta ostatnio odczytana pozycje drugiego i odczytuje ja od nowa
+ * dopiero wtedy, gdy ta zapamietana nie wystarcza.
+ *
+ * @param head          : pozycja nastepnego rekordu do odczytania
+ * @param cached_tail   : zapamietana przez czytajacego wartosc @p tail
+ * @param tail          : pozycja nastepnego rekordu do zapisania
+ * @param cached_head   : zapamietana przez piszacego wartosc @p head
+ * @param closed        : czy piszacy skonczyl dodawac rekordy
+ * @param records       : tablica rekordow
+ * @param record_size   : rozmiar rekordu w bajtach
+ * @param mask          : pojemnosc kolejki pomniejszona o 1
+ */
+typedef struct spsc_ring {
+	alignas(64) atomic_uint_fast64_t head;
+	uint64_t cached_tail;
+	alignas(64) atomic_uint_fast64_t tail;
+	uint64_t cached_head;
+	alignas(64) atomic_bool closed;
+	char *records;
+	uint64_t record_size;
+	uint64_t mask;
+} spsc_ring_t;
+
+
+/**
+ * @brief Inicjalizuje pusta kolejke @p ring na @p capacity rekordow o
+ * rozmiarze @p record_size.
+ * Konczy program z kodem 1, gdy nie udalo sie zaalokowac pamieci.
+ *
+ * @param[out] ring         : inicjalizowana kolejka
+ * @param[in] record_size   : rozmiar rekordu w bajtach
+ * @param[in] capacity      : pojemnosc kolejki, potega dwojki
+ */
+void spsc_ring_init(
+	spsc_ring_t *ring,
+	uint64_t record_size,
+	uint64_t capacity
+);
+
+
+/**
+ * @brief Zwalnia pamiec zaalokowana na kolejke @p ring.
+ *
+ * @param[in,out] ring  : zwalniana kolejka
+ */
+void spsc_ring_free(spsc_ring_t *ring);
+
+
+/**
+ * @brief Dodaje na koniec kolejki @p ring kopie rekordu @p record.
+ * Czeka, dopoki kolejka jest pelna. Wywolywana tylko przez watek piszacy.
+ *
+ * @param[in,out] ring  : kolejka
+ * @param[in] record    : dodawany rekord
+ */
+void spsc_ring_push(spsc_ring_t *ring, const void *record);
+
+
+/**
+ * @brief Zdejmuje rekord z poczatku kolejki @p ring i zapisuje go w
+ * @p record.
+ * Czeka, dopoki kolejka jest pusta, a piszacy jej nie zamknal. Wywolywana
+ * tylko przez watek czytajacy.
+ *
+ * @param[in,out] ring  : kolejka
+ * @param[out] record   : miejsce na zdjety rekord
+ *
+ * @return Wartosc @p true, jesli zdjelismy rekord, a @p false, gdy kolejka
+ * jest pusta i zamknieta.
+ */
+bool spsc_ring_pop(spsc_ring_t *ring, void *record);
+
+
+/**
+ * @brief Zamyka kolejke @p ring: czytajacy po zdjeciu pozostalych rekordow
+ * przestaje czekac na nastepne. Wywolywana tylko przez watek piszacy.
+ *
+ * @param[in,out] ring  : zamykana kolejka
+ */
+void spsc_ring_close(spsc_ring_t *ring);
+
+
+/**
+ * @brief Ustepuje procesora innym watkom w petli oczekiwania.
+ * Pierwsze obroty petli tylko kreca sie w miejscu, bo drugi watek zwykle
+ * odpowiada szybciej niz trwa przelaczenie watkow.
+ *
+ * @param[in,out] spins : liczba dotychczasowych obrotow petli oczekiwania
+ */
+void wait_a_moment(uint64_t *spins);
+
+
+#endif /* RING_UTIL_H */
@@ -0,0 +1,599 @@
+/** @file
+ * Implementacja modulu przeszukiwania drzewa gry gamma metoda Monte Carlo
+ *
+ * @author Piotr Prabucki <pp418377@students.mimuw.edu.pl>
+ */
+
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "gamma.h"
+#include "gamma_internal.h"
+#include "playout.h"
+#include "search.h"
+
+
+/**
+ * Liczba krawedzi przypadajacych srednio na wezel drzewa.
+ */
+#define EDGES_PER_NODE 8
+/**
+ * Waga eksploracji we wzorze UCT.
+ */
+#define EXPLORATION 0.7
+/**
+ * Prawdopodobienstwo proby zlotego ruchu w rozgrywkach oceniajacych pozycje.
+ */
+#define PLAYOUT_GOLDEN_PROBABILITY 0.05
+/**
+ * Co tyle przebiegow sprawdzany jest czas przeszukiwania.
+ */
+#define DEADLINE_CHECK 16
+
+
+/**
+ * @brief Miesza bity liczby @p value (splitmix64).
+ *
+ * @param[in] value : liczba
+ *
+ * @return Wymieszana liczba.
+ */
+uint64_t search_mix(uint64_t value) {
+	uint64_t z = value + 0x9E3779B97F4A7C15ull;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+
+	return z ^ (z >> 31);
+}
+
+
+/**
+ * @brief Zwraca klucz Zobrista ruchu gracza @p player.
+ *
+ * @param[in] player    : numer gracza lub 0
+ *
+ * @return Klucz.
+ */
+uint64_t get_turn_key(uint32_t player) {
+	return search_mix(search_mix(player) ^ 0x7475726Eull);
+}
+
+
+/**
+ * @brief Sprawdza, czy gracz @p player moze wykonac jakis ruch.
+ *
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] player    : numer gracza
+ *
+ * @return true, gdy gracz moze wykonac ruch, false w przeciwnym wypadku.
+ */
+bool can_player_move(gamma_t *g, uint32_t player) {
+	return gamma_free_fields(g, player) > 0 ||
+		gamma_golden_possible(g, player);
+}
+
+
+/**
+ * @brief Zwraca gracza, ktory wykonuje ruch po graczu @p player, pomijajac
+ * graczy, ktorzy nie moga wykonac ruchu.
+ *
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] player    : numer gracza
+ *
+ * @return Numer gracza lub 0, gdy zaden gracz nie moze wykonac ruchu.
+ */
+uint32_t get_searched_player(gamma_t *g, uint32_t player) {
+	for (uint32_t i = 0; i < g->player_count; i++) {
+		player = player == g->player_count ? 1 : player + 1;
+		if (can_player_move(g, player)) {
+			return player;
+		}
+	}
+
+	return 0;
+}
+
+
+/**
+ * @brief Tworzy puste drzewo przeszukiwania dla gry @p g.
+ * Alokuje od razu wszystkie tablice, a tablice transpozycji o rozmiarze co
+ * najmniej dwa razy wiekszym niz liczba wezlow.
+ *
+ * @param[in] g : wskaznik na strukture przechowujaca stan gry
+ *
+ * @return Wskaznik na utworzone drzewo lub NULL, gdy nie udalo sie
+ * zaalokowac pamieci, liczba wezlow jest zerowa lub gra jest za duza dla
+ * silnika losowych rozgrywek (patrz @ref PLAYOUT_MAX_FRONTIER_CELLS).
+ */
+search_t* search_new(gamma_t *g) {
+	if (!g || g->search_nodes == 0) {
+		return NULL;
+	}
+
+	search_t *s = calloc(1, sizeof(search_t));
+	if (!s) {
+		return NULL;
+	}
+
+	s->node_capacity = g->search_nodes;
+	s->edge_capacity = (uint64_t)s->node_capacity * EDGES_PER_NODE;
+	uint64_t table_size = 1;
+	while (table_size < 2 * (uint64_t)s->node_capacity) {
+		table_size <<= 1;
+	}
+	s->table_mask = table_size - 1;
+	s->random_state = search_mix(0);
+
+	s->nodes = malloc(s->node_capacity * sizeof(search_node_t));
+	s->edges = malloc(s->edge_capacity * sizeof(search_edge_t));
+	s->table = calloc(table_size, sizeof(uint32_t));
+	uint64_t path_size = (uint64_t)s->node_capacity + 1;
+	s->path_nodes = malloc(path_size * sizeof(uint32_t));
+	s->path_edges = malloc(path_size * sizeof(uint64_t));
+	s->playout = playout_new(
+		g,
+		1,
+		PLAYOUT_GOLDEN_PROBABILITY,
+		s->random_state
+	);
+	s->taken = malloc(g->player_count * sizeof(uint64_t));
+	s->reward = malloc(g->player_count * sizeof(double));
+	if (
+		!s->nodes || !s->edges || !s->table || !s->path_nodes ||
+		!s->path_edges || !s->playout || !s->taken || !s->reward
+	) {
+		search_delete(s);
+		return NULL;
+	}
+
+	return s;
+}
+
+
+/**
+ * @brief Usuwa drzewo przeszukiwania @p s.
+ * Nic nie robi, gdy @p s ma wartosc NULL.
+ *
+ * @param[in,out] s : usuwane drzewo
+ */
+void search_delete(search_t *s) {
+	if (!s) {
+		return;
+	}
+
+	free(s->nodes);
+	free(s->edges);
+	free(s->table);
+	free(s->path_nodes);
+	free(s->path_edges);
+	playout_delete(s->playout);
+	free(s->taken);
+	free(s->reward);
+	free(s);
+}
+
+
+/**
+ * @brief Usuwa wszystkie wezly i krawedzie drzewa @p s.
+ *
+ * @param[in,out] s : drzewo przeszukiwania
+ */
+void clear_search(search_t *s) {
+	s->node_count = 0;
+	s->edge_count = 0;
+	memset(s->table, 0, (s->table_mask + 1) * sizeof(uint32_t));
+}
+
+
+/**
+ * @brief Zwraca wezel o kluczu @p key, tworzac go, gdy go nie ma.
+ *
+ * @param[in,out] s     : drzewo przeszukiwania
+ * @param[in] key       : klucz pozycji
+ * @param[in] player    : gracz, ktory wykonuje ruch w pozycji
+ * @param[out] created  : czy wezel zostal utworzony
+ *
+ * @return Numer wezla lub @ref SEARCH_NONE, gdy wezla nie bylo, a drzewo
+ * jest pelne.
+ */
+uint32_t find_node(search_t *s, uint64_t key, uint32_t player, bool *created) {
+	*created = false;
+	uint64_t slot = key & s->table_mask;
+	while (s->table[slot]) {
+		uint32_t node = s->table[slot] - 1;
+		if (s->nodes[node].key == key) {
+			return node;
+		}
+		slot = (slot + 1) & s->table_mask;
+	}
+
+	if (s->node_count == s->node_capacity) {
+		return SEARCH_NONE;
+	}
+
+	uint32_t node = s->node_count++;
+	s->nodes[node] = (search_node_t){.key = key, .player = player};
+	s->table[slot] = node + 1;
+	*created = true;
+
+	return node;
+}
+
+
+/**
+ * @brief Dodaje do drzewa @p s krawedz ruchu na pole (@p x, @p y).
+ *
+ * @param[in,out] s     : drzewo przeszukiwania z wolnym miejscem na krawedz
+ * @param[in] x         : numer kolumny
+ * @param[in] y         : numer wiersza
+ * @param[in] golden    : czy ruch jest zlotym ruchem
+ */
+void add_edge(search_t *s, uint32_t x, uint32_t y, bool golden) {
+	s->edges[s->edge_count++] = (search_edge_t){
+		.x = x,
+		.y = y,
+		.golden = golden,
+		.child = SEARCH_NONE
+	};
+}
+
+
+/**
+ * @brief Dodaje do drzewa przeszukiwania @p data krawedz zwyklego ruchu na
+ * pole (@p x, @p y).
+ *
+ * @param[in,out] data  : drzewo przeszukiwania typu @ref search_t
+ * @param[in] x         : numer kolumny
+ * @param[in] y         : numer wiersza
+ *
+ * @return true, gdy krawedz zostala dodana, false gdy zabraklo miejsca.
+ */
+bool add_normal_edge(void *data, uint32_t x, uint32_t y) {
+	search_t *s = data;
+	if (s->edge_count == s->edge_capacity) {
+		return false;
+	}
+
+	add_edge(s, x, y, false);
+
+	return true;
+}
+
+
+/**
+ * @brief Tworzy krawedzie wszystkich ruchow wezla @p node w pozycji gry
+ * @p g, w losowej kolejnosci.
+ * Zlote ruchy sprawdza, wykonujac je i cofajac przez dziennik zmian, ktory
+ * musi byc wlaczony.
+ *
+ * @param[in,out] s     : drzewo przeszukiwania
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] node      : numer wezla pozycji gry
+ *
+ * @return true, gdy krawedzie zostaly utworzone, false gdy zabraklo na nie
+ * miejsca.
+ */
+bool expand_node(search_t *s, gamma_t *g, uint32_t node) {
+	search_node_t *n = &s->nodes[node];
+	uint64_t first = s->edge_count;
+	if (gamma_free_fields(g, n->player) > s->edge_capacity - first) {
+		return false;
+	}
+	gamma_legal_moves(g, n->player, add_normal_edge, s);
+
+	if (gamma_golden_possible(g, n->player)) {
+		for (uint32_t y = 0; y < g->field_height; y++) {
+			for (uint32_t x = 0; x < g->field_width; x++) {
+				uint32_t owner = gamma_field_owner(g, x, y);
+				if (owner == 0 || owner == n->player) {
+					continue;
+				}
+
+				uint64_t mark = gamma_checkpoint(g);
+				bool legal = gamma_golden_move(g, n->player, x, y);
+				gamma_rollback(g, mark);
+				if (!legal) {
+					continue;
+				}
+				if (s->edge_count == s->edge_capacity) {
+					s->edge_count = first;
+					return false;
+				}
+				add_edge(s, x, y, true);
+			}
+		}
+	}
+
+	for (uint64_t i = s->edge_count - first; i > 1; i--) {
+		s->random_state ^= s->random_state << 13;
+		s->random_state ^= s->random_state >> 7;
+		s->random_state ^= s->random_state << 17;
+		uint64_t j = s->random_state % i;
+		search_edge_t edge = s->edges[first + i - 1];
+		s->edges[first + i - 1] = s->edges[first + j];
+		s->edges[first + j] = edge;
+	}
+
+	n->first_edge = first;
+	n->edge_count = s->edge_count - first;
+	n->tried = 0;
+	n->expanded = true;
+
+	return true;
+}
+
+
+/**
+ * @brief Wybiera krawedz wezla @p node: najpierw kolejno wszystkie krawedzie,
+ * a potem krawedz z najwieksza wartoscia UCT.
+ *
+ * @param[in,out] s     : drzewo przeszukiwania
+ * @param[in] node      : numer wezla z krawedziami
+ *
+ * @return Indeks krawedzi.
+ */
+uint64_t select_edge(search_t *s, uint32_t node) {
+	search_node_t *n = &s->nodes[node];
+	if (n->tried < n->edge_count) {
+		return n->first_edge + n->tried++;
+	}
+
+	double log_visits = log((double)n->visits);
+	uint64_t best = n->first_edge;
+	double best_score = -1;
+	for (uint64_t i = n->first_edge; i < n->first_edge + n->edge_count; i++) {
+		const search_edge_t *e = &s->edges[i];
+		double score = e->reward / e->visits +
+			EXPLORATION * sqrt(log_visits / e->visits);
+		if (score > best_score) {
+			best_score = score;
+			best = i;
+		}
+	}
+
+	return best;
+}
+
+
+/**
+ * @brief Wykonuje ruch krawedzi @p e w grze @p g.
+ *
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] player    : gracz wykonujacy ruch
+ * @param[in] e         : krawedz ruchu
+ *
+ * @return true, gdy ruch zostal wykonany, false gdy byl niepoprawny (co
+ * oznacza kolizje skrotow).
+ */
+bool apply_edge(gamma_t *g, uint32_t player, const search_edge_t *e) {
+	if (e->golden) {
+		return gamma_golden_move(g, player, e->x, e->y);
+	}
+
+	return gamma_move(g, player, e->x, e->y);
+}
+
+
+/**
+ * @brief Ocenia pozycje gry @p g losowa rozgrywka i zapisuje wyniki graczy w
+ * [reward]: 1 dzielone przez liczbe graczy z najwieksza liczba pol dla tych
+ * graczy i 0 dla pozostalych.
+ *
+ * @param[in,out] s     : drzewo przeszukiwania
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] player    : gracz, ktory wykonuje ruch, lub 0, gdy gra sie
+ *                        skonczyla
+ */
+void evaluate_position(search_t *s, gamma_t *g, uint32_t player) {
+	if (player == 0) {
+		for (uint32_t i = 0; i < g->player_count; i++) {
+			s->taken[i] = gamma_busy_fields(g, i + 1);
+		}
+	}
+	else {
+		playout_set_position(s->playout, g, player);
+		playout_run(s->playout, s->taken);
+	}
+
+	uint64_t best = 0;
+	uint32_t count = 0;
+	for (uint32_t i = 0; i < g->player_count; i++) {
+		if (s->taken[i] > best || count == 0) {
+			best = s->taken[i];
+			count = 1;
+		}
+		else if (s->taken[i] == best) {
+			count++;
+		}
+	}
+	for (uint32_t i = 0; i < g->player_count; i++) {
+		s->reward[i] = s->taken[i] == best ? 1.0 / count : 0;
+	}
+}
+
+
+/**
+ * @brief Wykonuje jeden przebieg przeszukiwania od wezla @p root.
+ * Schodzi po krawedziach wybranych przez @ref select_edge, wykonujac ich
+ * ruchy w grze @p g, az dojdzie do nowego wezla, konca gry lub wezla, ktorego
+ * nie mozna rozwinac. Ocenia osiagnieta pozycje, dopisuje wynik krawedziom
+ * na sciezce i cofa ruchy do znacznika @p mark.
+ *
+ * @param[in,out] s     : drzewo przeszukiwania
+ * @param[in,out] g     : wskaznik na strukture przechowujaca stan gry
+ * @param[in] root      : numer wezla pozycji gry
+ * @param[in] mark      : znacznik stanu gry z @ref gamma_checkpoint
+ */
+void run_iteration(
+	search_t *s,
+	gamma_t *g,
+	uint32_t root,
+	uint64_t mark
+) {
+	uint64_t depth = 0;
+	uint32_t node = root;
+	uint32_t player = s->nodes[root].player;
+	// positions never repeat, so only colliding hashes could exceed the bound
+	while (player && depth <= s->node_capacity) {
+		search_node_t *n = &s->nodes[node];
+		if (
+			(!n->expanded && !expand_node(s, g, node)) ||
+			n->edge_count == 0
+		) {
+			break;
+		}
+
+		uint64_t edge = select_edge(s, node);
+		search_edge_t *e = &s->edges[edge];
+		if (!apply_edge(g, player, e)) {
+			break;
+		}
+		s->path_nodes[depth] = node;
+		s->path_edges[depth++] = edge;
+
+		player = get_searched_player(g, player);
+		bool created = false;
+		if (e->child == SEARCH_NONE) {
+			uint64_t key = gamma_hash(g) ^ get_turn_key(player);
+			e->child = find_node(s, key, player, &created);
+		}
+		node = e->child;
+		if (node == SEARCH_NONE || created) {
+			break;
+		}
+	}
+
+	evaluate_position(s, g, player);
+
+	if (node != SEARCH_NONE) {
+		s->nodes[node].visits++;
+	}
+	for (uint64_t i = 0; i < depth; i++) {
+		search_node_t *n = &s->nodes[s->path_nodes[i]];
+		search_edge_t *e = &s->edges[s->path_edges[i]];
+		n->visits++;
+		e->visits++;
+		e->reward += s->reward[n->player - 1];
+	}
+
+	gamma_rollback(g, mark);
+}
+
+
+/**
+ * @brief Zwraca liczbe milisekund od chwili @p start.
+ *
+ * @param[in] start : chwila poczatkowa
+ *
+ * @return Liczba milisekund.
+ */
+uint64_t get_elapsed_milliseconds(const struct timespec *start) {
+	struct timespec now;
+	timespec_get(&now, TIME_UTC);
+
+	return (now.tv_sec - start->tv_sec) * 1000 +
+		(now.tv_nsec - start->tv_nsec) / 1000000;
+}
+
+
+/** @brief Proponuje ruch gracza.
+ * Wlacza dziennik zmian na czas przeszukiwania i cofa przez niego ruchy
+ * kazdego przebiegu. Gdy dziennik byl wylaczony, wylacza go z powrotem.
+ *
+ * @param[in,out] g         : wskaznik na strukture przechowujaca stan gry,
+ * @param[in] player        : numer gracza, liczba dodatnia niewieksza od
+ *                            wartosci @p players z funkcji @ref gamma_new,
+ * @param[in] iterations    : maksymalna liczba przebiegow przeszukiwania lub
+ *                            zero, gdy liczba nie jest ograniczona,
+ * @param[in] milliseconds  : maksymalny czas przeszukiwania w milisekundach
+ *                            lub zero, gdy czas nie jest ograniczony,
+ * @param[out] move         : proponowany ruch,
+ * @param[out] golden       : czy proponowany ruch jest zlotym ruchem.
+ *
+ * @return Wartosc @p true, jesli ruch zostal zaproponowany, a @p false, gdy
+ * gracz nie moze wykonac ruchu, oba ograniczenia sa zerowe, ktorys z
+ * parametrow jest niepoprawny lub nie udalo sie zaalokowac pamieci.
+ */
+bool gamma_suggest_move(
+	gamma_t *g,
+	uint32_t player,
+	uint64_t iterations,
+	uint64_t milliseconds,
+	move_t *move,
+	bool *golden
+) {
+	if (
+		!g || player == 0 || player > g->player_count || !move || !golden ||
+		(iterations == 0 && milliseconds == 0) || !can_player_move(g, player)
+	) {
+		return false;
+	}
+
+	if (!g->search) {
+		g->search = search_new(g);
+		if (!g->search) {
+			return false;
+		}
+	}
+	search_t *s = g->search;
+	if (
+		s->node_count > s->node_capacity / 2 ||
+		s->edge_count > s->edge_capacity / 2
+	) {
+		clear_search(s);
+	}
+
+	// a position searched before keeps its node, so its statistics are reused
+	uint64_t key = gamma_hash(g) ^ get_turn_key(player);
+	bool created;
+	uint32_t root = find_node(s, key, player, &created);
+
+	bool journal_active = g->journal.active;
+	uint64_t mark = gamma_checkpoint(g);
+	bool expanded = s->nodes[root].expanded || expand_node(s, g, root);
+	if (!expanded) {
+		clear_search(s);
+		root = find_node(s, key, player, &created);
+		expanded = expand_node(s, g, root);
+	}
+
+	if (expanded) {
+		struct timespec start;
+		timespec_get(&start, TIME_UTC);
+		for (uint64_t i = 0; iterations == 0 || i < iterations; i++) {
+			if (
+				milliseconds && i % DEADLINE_CHECK == 0 &&
+				get_elapsed_milliseconds(&start) >= milliseconds
+			) {
+				break;
+			}
+			run_iteration(s, g, root, mark);
+		}
+	}
+
+	if (!journal_active) {
+		gamma_commit(g);
+	}
+	if (!expanded) {
+		return false;
+	}
+
+	const search_node_t *n = &s->nodes[root];
+	const search_edge_t *best = &s->edges[n->first_edge];
+	for (uint64_t i = n->first_edge; i < n->first_edge + n->edge_count; i++) {
+		if (s->edges[i].visits > best->visits) {
+			best = &s->edges[i];
+		}
+	}
+
+	move->player = player;
+	move->x = best->x;
+	move->y = best->y;
+	*golden = best->golden;
+
+	return true;
+}
@@ -0,0 +1,130 @@
+/** @file
+ * Interfejs modulu przeszukiwania drzewa gry gamma metoda Monte Carlo
+ *
+ * @author Piotr Prabucki <pp418377@students.mimuw.edu.pl>
+ */
+
+
+#ifndef SEARCH_H
+#define SEARCH_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gamma.h"
+#include "playout.h"
+
+
+/**
+ * @brief Wezel drzewa przeszukiwania, czyli pozycja gry.
+ *
+ * @param key           : skrot pozycji razem z graczem, ktory wykonuje ruch
+ * @param visits        : liczba przebiegow przechodzacych przez wezel
+ * @param first_edge    : indeks pierwszej krawedzi w [edges]
+ * @param edge_count    : liczba krawedzi
+ * @param tried         : liczba krawedzi wybranych juz co najmniej raz
+ *                        (krawedzie sa wybierane po raz pierwszy po kolei)
+ * @param player        : gracz, ktory wykonuje ruch, lub 0, gdy zaden gracz
+ *                        nie moze wykonac ruchu
+ * @param expanded      : czy krawedzie wezla zostaly utworzone
+ */
+typedef struct search_node {
+	uint64_t key;
+	uint64_t visits;
+	uint64_t first_edge;
+	uint64_t edge_count;
+	uint64_t tried;
+	uint32_t player;
+	bool expanded;
+} search_node_t;
+
+
+/**
+ * @brief Krawedz drzewa przeszukiwania, czyli ruch.
+ * Statystyki sa liczone z punktu widzenia gracza wykonujacego ruch.
+ *
+ * @param x         : numer kolumny pola ruchu
+ * @param y         : numer wiersza pola ruchu
+ * @param golden    : czy ruch jest zlotym ruchem
+ * @param child     : numer wezla pozycji po ruchu lub @ref SEARCH_NONE
+ * @param visits    : liczba przebiegow przez krawedz
+ * @param reward    : suma wynikow przebiegow przez krawedz
+ */
+typedef struct search_edge {
+	uint32_t x;
+	uint32_t y;
+	bool golden;
+	uint32_t child;
+	uint32_t visits;
+	double reward;
+} search_edge_t;
+
+
+/**
+ * Numer wezla oznaczajacy jego brak.
+ */
+#define SEARCH_NONE UINT32_MAX
+
+
+/**
+ * @brief Drzewo przeszukiwania (a dokladniej graf bez cykli, bo pozycje sa
+ * wspoldzielone) razem z tablica transpozycji.
+ * Wezly i krawedzie sa brane kolejno z tablic o stalym rozmiarze, a tablica
+ * transpozycji z adresowaniem otwartym przechowuje numery wezlow.
+ *
+ * @param node_capacity : rozmiar tablicy [nodes]
+ * @param node_count    : liczba uzywanych wezlow
+ * @param nodes         : wezly
+ * @param edge_capacity : rozmiar tablicy [edges]
+ * @param edge_count    : liczba uzywanych krawedzi
+ * @param edges         : krawedzie
+ * @param table_mask    : rozmiar tablicy transpozycji pomniejszony o 1
+ * @param table         : tablica transpozycji, numery wezlow powiekszone o 1
+ *                        (0 oznacza puste miejsce)
+ * @param path_nodes    : wezly na sciezce biezacego przebiegu
+ * @param path_edges    : krawedzie na sciezce biezacego przebiegu
+ * @param playout       : silnik losowych rozgrywek oceniajacych pozycje
+ * @param taken         : liczby pol graczy na koncu rozgrywki
+ * @param reward        : wyniki graczy w rozgrywce
+ * @param random_state  : stan generatora liczb pseudolosowych
+ */
+typedef struct search {
+	uint32_t node_capacity;
+	uint32_t node_count;
+	search_node_t *nodes;
+	uint64_t edge_capacity;
+	uint64_t edge_count;
+	search_edge_t *edges;
+	uint64_t table_mask;
+	uint32_t *table;
+	uint32_t *path_nodes;
+	uint64_t *path_edges;
+	playout_t *playout;
+	uint64_t *taken;
+	double *reward;
+	uint64_t random_state;
+} search_t;
+
+
+/**
+ * @brief Tworzy puste drzewo przeszukiwania dla gry @p g.
+ * Drzewo ma @ref gamma_t.search_nodes wezlow.
+ *
+ * @param[in] g : wskaznik na strukture przechowujaca stan gry
+ *
+ * @return Wskaznik na utworzone drzewo lub NULL, gdy nie udalo sie
+ * zaalokowac pamieci lub liczba wezlow jest zerowa.
+ */
+search_t* search_new(gamma_t *g);
+
+
+/**
+ * @brief Usuwa drzewo przeszukiwania @p s.
+ * Nic nie robi, gdy @p s ma wartosc NULL.
+ *
+ * @param[in,out] s : usuwane drzewo
+ */
+void search_delete(search_t *s);
+
+
+#endif /* SEARCH_H */
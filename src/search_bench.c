@@ -0,0 +1,122 @@
+/** @file
+ * Pomiar szybkosci przeszukiwania przez @ref gamma_suggest_move i zajetosci
+ * drzewa przeszukiwania
+ *
+ * @author Piotr Prabucki <pp418377@students.mimuw.edu.pl>
+ */
+
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "gamma.h"
+#include "gamma_internal.h"
+#include "search.h"
+
+
+/**
+ * Liczba graczy.
+ */
+#define BENCH_PLAYERS 2
+/**
+ * Maksymalna liczba obszarow gracza.
+ */
+#define BENCH_AREAS 4
+/**
+ * Liczba przebiegow przeszukiwania na ruch.
+ */
+#define BENCH_ITERATIONS 2000
+/**
+ * Liczba ruchow rozgrywanych na kazdej planszy.
+ */
+#define BENCH_MOVES 20
+
+
+/**
+ * @brief Zwraca czas w sekundach od ustalonej chwili.
+ *
+ * @return Czas w sekundach.
+ */
+double get_time(void) {
+	struct timespec now;
+	timespec_get(&now, TIME_UTC);
+
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+
+/**
+ * @brief Rozgrywa na pustej planszy @p side x @p side co najwyzej
+ * @ref BENCH_MOVES ruchow proponowanych przez @ref gamma_suggest_move i
+ * wypisuje liczbe przebiegow na sekunde oraz zajetosc drzewa.
+ *
+ * @param[in] side  : bok planszy
+ */
+void bench_board(uint32_t side) {
+	gamma_t *g = gamma_new(side, side, BENCH_PLAYERS, BENCH_AREAS);
+	if (!g) {
+		exit(1);
+	}
+
+	uint32_t player = 1;
+	uint32_t moves = 0;
+	uint32_t max_nodes = 0;
+	double start = get_time();
+	for (; moves < BENCH_MOVES; moves++) {
+		move_t move;
+		bool golden;
+		bool found = gamma_suggest_move(
+			g,
+			player,
+			BENCH_ITERATIONS,
+			0,
+			&move,
+			&golden
+		);
+		if (!found) {
+			break;
+		}
+		if (g->search->node_count > max_nodes) {
+			max_nodes = g->search->node_count;
+		}
+		if (golden) {
+			gamma_golden_move(g, player, move.x, move.y);
+		}
+		else {
+			gamma_move(g, player, move.x, move.y);
+		}
+		player = player % BENCH_PLAYERS + 1;
+	}
+	double elapsed = get_time() - start;
+
+	printf(
+		"%2u x %-2u: %10.0f iterations/s, at most %u of %u nodes\n",
+		side,
+		side,
+		(double)moves * BENCH_ITERATIONS / elapsed,
+		max_nodes,
+		g->search_nodes
+	);
+
+	gamma_delete(g);
+}
+
+
+/**
+ * @brief Wypisuje szybkosc przeszukiwania na planszach 10 x 10 i 19 x 19.
+ *
+ * @return Zero.
+ */
+int main() {
+	printf(
+		"%d players, at most %d areas each, %d iterations per move\n",
+		BENCH_PLAYERS,
+		BENCH_AREAS,
+		BENCH_ITERATIONS
+	);
+	bench_board(10);
+	bench_board(19);
+
+	return 0;
+}
@@ -0,0 +1,562 @@
+/** @file
+ * Implementacja modulu rozgrywajacego turnieje gier gamma na wielu watkach
+ *
+ * @author Piotr Prabucki <pp418377@students.mimuw.edu.pl>
+ */
+
+
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "gamma.h"
+#include "tournament.h"
+
+
+/**
+ * Szansa (jeden do tylu), ze strategia "golden" sprobuje zlotego ruchu.
+ */
+#define GOLDEN_ODDS 8
+/**
+ * Liczba losowych pol, na ktorych strategia "golden" probuje zlotego ruchu.
+ */
+#define GOLDEN_ATTEMPTS 16
+
+
+/**
+ * @brief Wybor ruchu sposrod wyliczanych mozliwych ruchow.
+ *
+ * @param skip  : liczba ruchow do pominiecia przed wybranym
+ * @param found : czy ruch zostal wybrany
+ * @param x     : numer kolumny wybranego pola
+ * @param y     : numer wiersza wybranego pola
+ */
+typedef struct move_choice {
+	uint64_t skip;
+	bool found;
+	uint32_t x;
+	uint32_t y;
+} move_choice_t;
+
+
+/**
+ * @brief Dane watku turnieju.
+ * Zakres niezaczetych partii jest zapisany w jednej liczbie, zeby watek i
+ * podbierajace mu partie watki mogly go zmieniac jedna operacja
+ * compare-and-swap. Wyniki zmienia tylko wlasciciel, a kazdy watek ma je w
+ * osobnej linii pamieci podrecznej.
+ *
+ * @param range         : zakres niezaczetych partii, poczatek w starszych
+ *                        32 bitach, koniec w mlodszych
+ * @param tournament    : ustawienia turnieju
+ * @param workers       : dane wszystkich watkow turnieju
+ * @param random_state  : stan generatora wyboru watku, ktoremu podbierane
+ *                        sa partie
+ * @param failed        : czy nie udalo sie utworzyc gry
+ * @param games         : liczba rozegranych partii
+ * @param moves         : laczna liczba ruchow
+ * @param draws         : liczba partii bez jednego zwyciezcy
+ * @param busy_fields   : laczne liczby pol zajetych przez kolejnych graczy
+ * @param wins          : liczby partii wygranych przez kolejnych graczy
+ */
+typedef struct worker {
+	alignas(64) atomic_uint_fast64_t range;
+	const tournament_t *tournament;
+	struct worker *workers;
+	uint64_t random_state;
+	bool failed;
+	uint64_t games;
+	uint64_t moves;
+	uint64_t draws;
+	uint64_t *busy_fields;
+	uint64_t *wins;
+} worker_t;
+
+
+/**
+ * @brief Zwraca kolejna liczbe pseudolosowa (xorshift).
+ *
+ * @param[in,out] state : stan generatora, rozny od zera
+ *
+ * @return Liczba pseudolosowa.
+ */
+uint64_t tournament_random(uint64_t *state) {
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+
+	return *state;
+}
+
+
+/**
+ * @brief Zwraca niezerowy stan generatora liczb pseudolosowych wyznaczony z
+ * liczby @p value (splitmix64).
+ *
+ * @param[in] value : liczba
+ *
+ * @return Niezerowy stan generatora.
+ */
+uint64_t tournament_seed(uint64_t value) {
+	uint64_t z = value + 0x9E3779B97F4A7C15ull;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	z ^= z >> 31;
+
+	return z ? z : 1;
+}
+
+
+/**
+ * @brief Pomija ruchy do wybranego i zapamietuje wybrany ruch.
+ *
+ * @param[in,out] data  : wybor ruchu typu @ref move_choice_t
+ * @param[in] x         : numer kolumny
+ * @param[in] y         : numer wiersza
+ *
+ * @return false, gdy ruch zostal wybrany, true w przeciwnym wypadku.
+ */
+bool skip_moves(void *data, uint32_t x, uint32_t y) {
+	move_choice_t *choice = data;
+	if (choice->skip > 0) {
+		choice->skip--;
+		return true;
+	}
+
+	choice->found = true;
+	choice->x = x;
+	choice->y = y;
+
+	return false;
+}
+
+
+/**
+ * @brief Strategia wykonujaca losowy mozliwy ruch.
+ *
+ * @param[in,out] g             : wskaznik na strukture przechowujaca stan gry
+ * @param[in] player            : numer gracza
+ * @param[in,out] random_state  : stan generatora liczb pseudolosowych
+ *
+ * @return true, gdy ruch zostal wykonany, false gdy gracz nie moze wykonac
+ * ruchu.
+ */
+bool random_policy(gamma_t *g, uint32_t player, uint64_t *random_state) {
+	uint64_t count = gamma_free_fields(g, player);
+	if (count == 0) {
+		return false;
+	}
+
+	move_choice_t choice = {
+		.skip = tournament_random(random_state) % count,
+		.found = false
+	};
+	gamma_legal_moves(g, player, skip_moves, &choice);
+
+	return choice.found && gamma_move(g, player, choice.x, choice.y);
+}
+
+
+/**
+ * @brief Strategia wykonujaca pierwszy mozliwy ruch.
+ *
+ * @param[in,out] g             : wskaznik na strukture przechowujaca stan gry
+ * @param[in] player            : numer gracza
+ * @param[in,out] random_state  : nieuzywany stan generatora
+ *
+ * @return true, gdy ruch zostal wykonany, false gdy gracz nie moze wykonac
+ * ruchu.
+ */
+bool first_policy(gamma_t *g, uint32_t player, uint64_t *random_state) {
+	(void)random_state;
+
+	move_choice_t choice = {.skip = 0, .found = false};
+	gamma_legal_moves(g, player, skip_moves, &choice);
+
+	return choice.found && gamma_move(g, player, choice.x, choice.y);
+}
+
+
+/**
+ * @brief Strategia wykonujaca losowy mozliwy ruch, a co @ref GOLDEN_ODDS
+ * ruch (srednio) probujaca najpierw zlotego ruchu na losowych polach.
+ * Gdy gracz nie moze wykonac zwyklego ruchu, wykonuje pierwszy mozliwy
+ * zloty ruch.
+ *
+ * @param[in,out] g             : wskaznik na strukture przechowujaca stan gry
+ * @param[in] player            : numer gracza
+ * @param[in,out] random_state  : stan generatora liczb pseudolosowych
+ *
+ * @return true, gdy ruch zostal wykonany, false gdy gracz nie moze wykonac
+ * ruchu.
+ */
+bool golden_policy(gamma_t *g, uint32_t player, uint64_t *random_state) {
+	if (
+		tournament_random(random_state) % GOLDEN_ODDS == 0 &&
+		gamma_golden_possible(g, player)
+	) {
+		for (int i = 0; i < GOLDEN_ATTEMPTS; i++) {
+			uint64_t r = tournament_random(random_state);
+			uint32_t x = (r >> 32) % gamma_width(g);
+			uint32_t y = (uint32_t)r % gamma_height(g);
+			if (gamma_golden_move(g, player, x, y)) {
+				return true;
+			}
+		}
+	}
+
+	if (random_policy(g, player, random_state)) {
+		return true;
+	}
+
+	if (gamma_golden_possible(g, player)) {
+		for (uint32_t y = 0; y < gamma_height(g); y++) {
+			for (uint32_t x = 0; x < gamma_width(g); x++) {
+				if (gamma_golden_move(g, player, x, y)) {
+					return true;
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+
+/**
+ * @brief Strategie dostepne przez @ref tournament_find_policy.
+ */
+static const struct {
+	const char *name;
+	tournament_policy_t policy;
+} policies[] = {
+	{"random", random_policy},
+	{"first", first_policy},
+	{"golden", golden_policy}
+};
+
+
+/**
+ * @brief Zwraca strategie o nazwie @p name.
+ *
+ * @param[in] name  : nazwa strategii
+ *
+ * @return Strategia lub NULL, gdy nie ma strategii o tej nazwie.
+ */
+tournament_policy_t tournament_find_policy(const char *name) {
+	for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); i++) {
+		if (strcmp(name, policies[i].name) == 0) {
+			return policies[i].policy;
+		}
+	}
+
+	return NULL;
+}
+
+
+/**
+ * @brief Zapisuje zakres partii [@p begin, @p end) w jednej liczbie.
+ *
+ * @param[in] begin : pierwsza partia
+ * @param[in] end   : partia za ostatnia
+ *
+ * @return Zakres partii.
+ */
+uint64_t pack_range(uint32_t begin, uint32_t end) {
+	return (uint64_t)begin << 32 | end;
+}
+
+
+/**
+ * @brief Bierze pierwsza niezaczeta partie watku @p worker.
+ *
+ * @param[in,out] worker    : dane watku
+ * @param[out] game         : numer wzietej partii
+ *
+ * @return true, gdy partia zostala wzieta, false gdy watek nie ma
+ * niezaczetych partii.
+ */
+bool take_game(worker_t *worker, uint32_t *game) {
+	uint64_t range = atomic_load(&worker->range);
+	while ((uint32_t)(range >> 32) < (uint32_t)range) {
+		uint32_t begin = range >> 32;
+		if (
+			atomic_compare_exchange_weak(
+				&worker->range,
+				&range,
+				pack_range(begin + 1, (uint32_t)range)
+			)
+		) {
+			*game = begin;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/**
+ * @brief Podbiera watkowi @p worker druga polowe niezaczetych partii
+ * pierwszego napotkanego watku, ktory je ma.
+ * Watki sa przegladane od losowego.
+ *
+ * @param[in,out] worker    : dane watku bez niezaczetych partii
+ *
+ * @return true, gdy partie zostaly podebrane, false gdy zaden watek nie ma
+ * niezaczetych partii.
+ */
+bool steal_games(worker_t *worker) {
+	uint32_t count = worker->tournament->threads;
+	uint32_t start = tournament_random(&worker->random_state) % count;
+	for (uint32_t i = 0; i < count; i++) {
+		worker_t *victim = &worker->workers[(start + i) % count];
+		if (victim == worker) {
+			continue;
+		}
+
+		uint64_t range = atomic_load(&victim->range);
+		while ((uint32_t)(range >> 32) < (uint32_t)range) {
+			uint32_t begin = range >> 32;
+			uint32_t end = range;
+			uint32_t middle = begin + (end - begin) / 2;
+			if (
+				atomic_compare_exchange_weak(
+					&victim->range,
+					&range,
+					pack_range(begin, middle)
+				)
+			) {
+				// nikt nie podbiera z pustego zakresu, wiec wystarczy zwykly zapis
+				atomic_store(&worker->range, pack_range(middle, end));
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+
+/**
+ * @brief Rozgrywa partie @p game w grze @p g i dopisuje jej wynik do wynikow
+ * watku @p worker.
+ *
+ * @param[in,out] worker    : dane watku
+ * @param[in,out] g         : pusta gra
+ * @param[in] game          : numer partii
+ */
+void play_game(worker_t *worker, gamma_t *g, uint32_t game) {
+	const tournament_t *t = worker->tournament;
+	uint64_t random_state = tournament_seed(
+		t->seed ^ tournament_seed(game)
+	);
+
+	uint64_t moves = 0;
+	uint32_t player = 1;
+	uint32_t passes = 0;
+	while (passes < t->players) {
+		if (t->policies[player - 1](g, player, &random_state)) {
+			moves++;
+			passes = 0;
+		}
+		else {
+			passes++;
+		}
+		player = player == t->players ? 1 : player + 1;
+	}
+
+	uint64_t best = 0;
+	uint32_t winner = 0;
+	bool draw = false;
+	for (uint32_t i = 1; i <= t->players; i++) {
+		uint64_t busy = gamma_busy_fields(g, i);
+		worker->busy_fields[i - 1] += busy;
+		if (busy > best || winner == 0) {
+			best = busy;
+			winner = i;
+			draw = false;
+		}
+		else if (busy == best) {
+			draw = true;
+		}
+	}
+
+	if (draw) {
+		worker->draws++;
+	}
+	else {
+		worker->wins[winner - 1]++;
+	}
+	worker->games++;
+	worker->moves += moves;
+}
+
+
+/**
+ * @brief Glowna funkcja watku turnieju.
+ * Rozgrywa swoje partie, a gdy sie skoncza, podbiera partie innym watkom.
+ * Kazda partia jest rozgrywana w kopii pustej gry utworzonej przez watek.
+ *
+ * @param[in,out] data  : dane watku typu @ref worker_t
+ *
+ * @return NULL.
+ */
+void* run_worker(void *data) {
+	worker_t *worker = data;
+	const tournament_t *t = worker->tournament;
+	gamma_t *empty = gamma_new(t->width, t->height, t->players, t->areas);
+	if (!empty) {
+		worker->failed = true;
+		return NULL;
+	}
+
+	uint32_t game;
+	while (take_game(worker, &game) || (
+		steal_games(worker) && take_game(worker, &game)
+	)) {
+		gamma_t *g = gamma_clone(empty);
+		if (!g) {
+			worker->failed = true;
+			break;
+		}
+		play_game(worker, g, game);
+		gamma_delete(g);
+	}
+
+	gamma_delete(empty);
+
+	return NULL;
+}
+
+
+/**
+ * @brief Rozgrywa turniej @p t.
+ * Kazdy watek dostaje na poczatku rowna czesc partii. Gdy nie uda sie
+ * uruchomic ktoregos watku, jego partie podbieraja uruchomione watki.
+ *
+ * @param[in] t         : ustawienia turnieju
+ * @param[out] result   : wyniki turnieju
+ *
+ * @return true, gdy turniej zostal rozegrany, false gdy ustawienia sa
+ * niepoprawne, nie udalo sie zaalokowac pamieci, utworzyc gry lub uruchomic
+ * zadnego watku.
+ */
+bool tournament_run(const tournament_t *t, tournament_result_t *result) {
+	if (!t || !result || !t->policies || t->threads == 0) {
+		return false;
+	}
+	for (uint32_t i = 0; i < t->players; i++) {
+		if (!t->policies[i]) {
+			return false;
+		}
+	}
+
+	gamma_t *probe = gamma_new(t->width, t->height, t->players, t->areas);
+	if (!probe) {
+		return false;
+	}
+	gamma_delete(probe);
+
+	worker_t *workers = aligned_alloc(
+		alignof(worker_t),
+		t->threads * sizeof(worker_t)
+	);
+	pthread_t *threads = malloc(t->threads * sizeof(pthread_t));
+	result->busy_fields = calloc(t->players, sizeof(uint64_t));
+	result->wins = calloc(t->players, sizeof(uint64_t));
+	bool success = workers && threads && result->busy_fields && result->wins;
+
+	uint32_t prepared = 0;
+	while (success && prepared < t->threads) {
+		worker_t *worker = &workers[prepared];
+		worker->busy_fields = calloc(t->players, sizeof(uint64_t));
+		worker->wins = calloc(t->players, sizeof(uint64_t));
+		if (!worker->busy_fields || !worker->wins) {
+			free(worker->busy_fields);
+			free(worker->wins);
+			success = false;
+			break;
+		}
+
+		atomic_init(
+			&worker->range,
+			pack_range(
+				(uint64_t)t->games * prepared / t->threads,
+				(uint64_t)t->games * (prepared + 1) / t->threads
+			)
+		);
+		worker->tournament = t;
+		worker->workers = workers;
+		worker->random_state = tournament_seed(prepared);
+		worker->failed = false;
+		worker->games = 0;
+		worker->moves = 0;
+		worker->draws = 0;
+		prepared++;
+	}
+
+	struct timespec start, end;
+	timespec_get(&start, TIME_UTC);
+	uint32_t started = 0;
+	while (success && started < t->threads) {
+		if (pthread_create(
+			&threads[started],
+			NULL,
+			run_worker,
+			&workers[started]
+		)) {
+			success = started > 0;
+			break;
+		}
+		started++;
+	}
+	for (uint32_t i = 0; i < started; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	timespec_get(&end, TIME_UTC);
+
+	result->games = 0;
+	result->moves = 0;
+	result->draws = 0;
+	result->seconds = end.tv_sec - start.tv_sec +
+		(end.tv_nsec - start.tv_nsec) / 1e9;
+	for (uint32_t i = 0; i < prepared; i++) {
+		worker_t *worker = &workers[i];
+		success = success && !worker->failed;
+		result->games += worker->games;
+		result->moves += worker->moves;
+		result->draws += worker->draws;
+		for (uint32_t j = 0; success && j < t->players; j++) {
+			result->busy_fields[j] += worker->busy_fields[j];
+			result->wins[j] += worker->wins[j];
+		}
+		free(worker->busy_fields);
+		free(worker->wins);
+	}
+
+	free(workers);
+	free(threads);
+	if (!success) {
+		tournament_result_free(result);
+	}
+
+	return success;
+}
+
+
+/**
+ * @brief Zwalnia tablice wynikow turnieju @p result.
+ *
+ * @param[in,out] result    : wyniki turnieju
+ */
+void tournament_result_free(tournament_result_t *result) {
+	free(result->busy_fields);
+	free(result->wins);
+	result->busy_fields = NULL;
+	result->wins = NULL;
+}
@@ -0,0 +1,114 @@
+/** @file
+ * Interfejs modulu rozgrywajacego turnieje gier gamma na wielu watkach
+ *
+ * @author Piotr Prabucki <pp418377@students.mimuw.edu.pl>
+ */
+
+
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gamma.h"
+
+
+/**
+ * @brief Strategia wyboru ruchu.
+ * Wykonuje ruch gracza @p player w grze @p g, korzystajac z generatora liczb
+ * pseudolosowych o stanie @p random_state, roznym od zera.
+ * Zwraca true, gdy wykonala ruch, a false, gdy gracz nie moze wykonac ruchu.
+ */
+typedef bool (*tournament_policy_t)(
+	gamma_t *g,
+	uint32_t player,
+	uint64_t *random_state
+);
+
+
+/**
+ * @brief Ustawienia turnieju.
+ * Gracz o numerze i gra w kazdej partii strategia [policies][i - 1], a partie
+ * zaczyna gracz 1.
+ *
+ * @param width         : szerokosc planszy
+ * @param height        : wysokosc planszy
+ * @param players       : liczba graczy
+ * @param areas         : maksymalna liczba obszarow gracza
+ * @param games         : liczba partii
+ * @param threads       : liczba watkow
+ * @param seed          : ziarno, z ktorego wyznaczane sa ziarna partii
+ * @param policies      : strategie kolejnych graczy
+ */
+typedef struct tournament {
+	uint32_t width;
+	uint32_t height;
+	uint32_t players;
+	uint32_t areas;
+	uint32_t games;
+	uint32_t threads;
+	uint64_t seed;
+	const tournament_policy_t *policies;
+} tournament_t;
+
+
+/**
+ * @brief Wyniki turnieju.
+ *
+ * @param games         : liczba rozegranych partii
+ * @param moves         : laczna liczba ruchow we wszystkich partiach
+ * @param draws         : liczba partii bez jednego zwyciezcy
+ * @param busy_fields   : laczne liczby pol zajetych na koncu partii przez
+ *                        kolejnych graczy (pod indeksem 0 gracz 1)
+ * @param wins          : liczby partii wygranych przez kolejnych graczy
+ * @param seconds       : czas trwania turnieju w sekundach
+ */
+typedef struct tournament_result {
+	uint64_t games;
+	uint64_t moves;
+	uint64_t draws;
+	uint64_t *busy_fields;
+	uint64_t *wins;
+	double seconds;
+} tournament_result_t;
+
+
+/**
+ * @brief Zwraca strategie o nazwie @p name.
+ * Dostepne strategie to "random" (losowy mozliwy ruch), "first" (pierwszy
+ * mozliwy ruch) i "golden" (losowy mozliwy ruch, czasem zloty).
+ *
+ * @param[in] name  : nazwa strategii
+ *
+ * @return Strategia lub NULL, gdy nie ma strategii o tej nazwie.
+ */
+tournament_policy_t tournament_find_policy(const char *name);
+
+
+/**
+ * @brief Rozgrywa turniej @p t.
+ * Partie sa rozdzielane miedzy watki, ktore podbieraja sobie nawzajem
+ * niezaczete partie. Wynik partii zalezy tylko od jej numeru i ziarna, a nie
+ * od tego, ktory watek ja rozegral. Alokuje tablice wynikow, ktore nalezy
+ * zwolnic przez @ref tournament_result_free.
+ *
+ * @param[in] t         : ustawienia turnieju
+ * @param[out] result   : wyniki turnieju
+ *
+ * @return true, gdy turniej zostal rozegrany, false gdy ustawienia sa
+ * niepoprawne, nie udalo sie zaalokowac pamieci, utworzyc gry lub uruchomic
+ * watku.
+ */
+bool tournament_run(const tournament_t *t, tournament_result_t *result);
+
+
+/**
+ * @brief Zwalnia tablice wynikow turnieju @p result.
+ *
+ * @param[in,out] result    : wyniki turnieju
+ */
+void tournament_result_free(tournament_result_t *result);
+
+
+#endif /* TOURNAMENT_H */
@@ -0,0 +1,144 @@
+/** @file
+ * Glowny plik programu rozgrywajacego turnieje gier gamma
+ *
+ * @author Piotr Prabucki <pp418377@students.mimuw.edu.pl>
+ */
+
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "tournament.h"
+
+
+/**
+ * Opis wywolania programu.
+ */
+#define USAGE \
+	"usage: %s width height areas games threads seed policy...\n" \
+	"  one policy (random, first or golden) per player,\n" \
+	"  threads 0 uses every online processor\n"
+
+
+/**
+ * @brief Zamienia napis @p text na liczbe z przedzialu [0, @p max].
+ *
+ * @param[in] text      : napis
+ * @param[in] max       : najwieksza dopuszczalna liczba
+ * @param[out] value    : odczytana liczba
+ *
+ * @return true, gdy napis jest liczba z przedzialu, false w przeciwnym
+ * wypadku.
+ */
+static bool parse_number(
+	const char *text,
+	unsigned long long max,
+	uint64_t *value
+) {
+	if (*text < '0' || *text > '9') {
+		return false;
+	}
+
+	char *end;
+	errno = 0;
+	unsigned long long number = strtoull(text, &end, 10);
+	if (errno || *end || number > max) {
+		return false;
+	}
+
+	*value = number;
+
+	return true;
+}
+
+
+/**
+ * @brief Rozgrywa turniej opisany argumentami programu i wypisuje jego wyniki.
+ *
+ * @param[in] argc  : liczba argumentow
+ * @param[in] argv  : argumenty
+ *
+ * @return Zero, gdy turniej zostal rozegrany, 1 w przeciwnym wypadku.
+ */
+int main(int argc, char **argv) {
+	uint64_t numbers[6];
+	bool correct = argc > 7;
+	for (int i = 0; correct && i < 5; i++) {
+		correct = parse_number(argv[i + 1], UINT32_MAX, &numbers[i]);
+	}
+	correct = correct && parse_number(argv[6], UINT64_MAX, &numbers[5]);
+	if (!correct) {
+		fprintf(stderr, USAGE, argv[0]);
+		return 1;
+	}
+
+	uint32_t players = argc - 7;
+	tournament_policy_t *policies = malloc(
+		players * sizeof(tournament_policy_t)
+	);
+	if (!policies) {
+		return 1;
+	}
+	for (uint32_t i = 0; i < players; i++) {
+		policies[i] = tournament_find_policy(argv[i + 7]);
+		if (!policies[i]) {
+			fprintf(stderr, "unknown policy %s\n", argv[i + 7]);
+			free(policies);
+			return 1;
+		}
+	}
+
+	tournament_t t = {
+		.width = numbers[0],
+		.height = numbers[1],
+		.players = players,
+		.areas = numbers[2],
+		.games = numbers[3],
+		.threads = numbers[4],
+		.seed = numbers[5],
+		.policies = policies
+	};
+	if (t.threads == 0) {
+		long online = sysconf(_SC_NPROCESSORS_ONLN);
+		t.threads = online > 0 ? online : 1;
+	}
+
+	tournament_result_t result;
+	if (!tournament_run(&t, &result)) {
+		fprintf(stderr, "tournament failed\n");
+		free(policies);
+		return 1;
+	}
+
+	printf(
+		"%" PRIu64 " games, %" PRIu64 " moves, %" PRIu64 " draws, "
+		"%u threads\n",
+		result.games,
+		result.moves,
+		result.draws,
+		t.threads
+	);
+	printf(
+		"%.3f s, %.1f games/s\n",
+		result.seconds,
+		result.games / result.seconds
+	);
+	for (uint32_t i = 0; i < players; i++) {
+		printf(
+			"player %u (%s): %.2f busy fields, %" PRIu64 " wins\n",
+			i + 1,
+			argv[i + 7],
+			result.games ? (double)result.busy_fields[i] / result.games : 0,
+			result.wins[i]
+		);
+	}
+
+	tournament_result_free(&result);
+	free(policies);
+
+	return 0;
+}